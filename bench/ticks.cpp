@@ -0,0 +1,147 @@
+// Fixed update throughput of the simulation, without a window.
+//
+// Usage: ticks [--ticks N] [actor_count...]
+//
+// For every actor count (by default 1000, 10000, 100000 and 1000000) a game
+// with a headless rendering::Plugin is run for N fixed updates (200 by
+// default). Every actor has a KinematicBody, a behavior that bounces it off
+// the edges of the world and a Rectangle, so the hierarchy of the renderer is
+// kept too. Prints the time per tick and the ticks per second it allows.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "hummingbird/hum.hpp"
+#include "JobSystem.hpp"
+#include "KinematicSystem.hpp"
+#include "TickRunner.hpp"
+#include "rendering/Material.hpp"
+#include "rendering/Plugin.hpp"
+#include "rendering/Rectangle.hpp"
+
+namespace
+{
+const float WORLD_SIZE = 1000.f;
+
+// Custom behavior: keeps the actor inside the world
+class Bounce : public hum::Behavior
+{
+public:
+    void init() override
+    {
+        _body = actor().getBehavior<KinematicBody>();
+    }
+
+    void fixedUpdate() override
+    {
+        const hum::Vector3f& position = actor().transform().position;
+        bool out_x = (position.x < 0.f && _velocity_x < 0.f) || (position.x > WORLD_SIZE && _velocity_x > 0.f);
+        bool out_y = (position.y < 0.f && _velocity_y < 0.f) || (position.y > WORLD_SIZE && _velocity_y > 0.f);
+        if (!out_x && !out_y)
+        {
+            return;
+        }
+        hum::Transformation velocity = _body->getVelocity();
+        if (out_x)
+        {
+            _velocity_x = velocity.position.x = -velocity.position.x;
+        }
+        if (out_y)
+        {
+            _velocity_y = velocity.position.y = -velocity.position.y;
+        }
+        _body->setVelocity(velocity);
+    }
+
+    void setVelocity(float x, float y)
+    {
+        _velocity_x = x;
+        _velocity_y = y;
+    }
+
+    static const char* behaviorName()
+    {
+        return "Bounce";
+    }
+
+private:
+    KinematicBody* _body;
+    // Cached so the common case doesn't read the KinematicSystem
+    float _velocity_x, _velocity_y;
+};
+
+float uniform(float min, float max)
+{
+    return min + (max - min) * (std::rand() / static_cast<float>(RAND_MAX));
+}
+
+void run(unsigned long long actor_count, unsigned long long ticks)
+{
+    std::srand(1);
+    // One Material per color, as the Color constructors would share them
+    rendering::Material red(rendering::Color(255, 0, 0));
+    rendering::Material green(rendering::Color(0, 255, 0));
+    rendering::Material blue(rendering::Color(0, 0, 255));
+    rendering::Material* materials[] = {&red, &green, &blue};
+
+    hum::Game game;
+    // First, so its ticks cover the fixed updates of the other plugins
+    TickRunner* runner = game.addPlugin<TickRunner>(ticks);
+    game.addPlugin<JobSystem>();
+    game.addPlugin<KinematicSystem>();
+    game.addPlugin<rendering::Plugin>(true);
+
+    for (unsigned long long i = 0; i < actor_count; ++i)
+    {
+        hum::Actor* actor = game.actors().create();
+        actor->transform().position = hum::Vector3f(uniform(0.f, WORLD_SIZE), uniform(0.f, WORLD_SIZE), 0);
+        KinematicBody* body = actor->addBehavior<KinematicBody>();
+        hum::Transformation velocity = body->getVelocity();
+        velocity.position.x = uniform(-50.f, 50.f);
+        velocity.position.y = uniform(-50.f, 50.f);
+        velocity.rotation.z = uniform(-90.f, 90.f);
+        body->setVelocity(velocity);
+        actor->addBehavior<Bounce>()->setVelocity(velocity.position.x, velocity.position.y);
+        actor->addBehavior<rendering::Rectangle>(materials[i % 3]);
+    }
+
+    game.run();
+
+    std::printf("%10llu %8llu %10.3f %10.3f %10.3f %12.1f\n", actor_count, runner->ticks(),
+            runner->mean(), runner->percentile(0.5f), runner->percentile(0.99f), runner->ticksPerSecond());
+    std::fflush(stdout);
+}
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long long ticks = 200;
+    std::vector<unsigned long long> actor_counts;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+        {
+            ticks = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            actor_counts.push_back(std::strtoull(argv[i], nullptr, 10));
+        }
+    }
+    if (ticks == 0)
+    {
+        std::fprintf(stderr, "Usage: %s [--ticks N] [actor_count...]\n", argv[0]);
+        return 1;
+    }
+    if (actor_counts.empty())
+    {
+        actor_counts = {1000, 10000, 100000, 1000000};
+    }
+
+    std::printf("%10s %8s %10s %10s %10s %12s\n", "actors", "ticks", "mean ms", "p50 ms", "p99 ms", "ticks/s");
+    for (unsigned long long actor_count : actor_counts)
+    {
+        run(actor_count, ticks);
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+#ifndef ASYNC_LOG_HPP
+#define ASYNC_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "hummingbird/hum.hpp"
+
+class AsyncLog : public hum::Plugin
+{
+public:
+    enum class Level : std::uint8_t
+    {
+        DEBUG,
+        INFO,
+        WARNING,
+        ERROR
+    };
+
+    //! What a thread does when its ring buffer is full.
+    enum class FullPolicy
+    {
+        DROP,   //!< Discard the record and count it in dropped().
+        BLOCK   //!< Wait for the writer thread to make room.
+    };
+
+    //! Largest encoded record. Longer string arguments are truncated.
+    static const std::size_t MAX_RECORD = 1024;
+
+    /*!
+      \brief Class constructor. Starts the writer thread.
+
+      Every thread that logs gets its own ring buffer of <ring_size> bytes,
+      at least MAX_RECORD and rounded up to a power of two.
+     */
+    AsyncLog(std::size_t ring_size = 1 << 16, FullPolicy policy = FullPolicy::DROP, std::FILE* output = stdout);
+
+    //! Class destructor. Writes the pending records and stops the writer thread.
+    ~AsyncLog();
+
+    void gameEnd() override;
+
+    /*!
+      \brief Log a record of level <level>.
+
+      <format> must be a string literal: only its address is stored, it is
+      read later by the writer thread. Each `{}` in it is replaced by the next
+      argument, extra arguments are appended. Arguments can be arithmetic
+      types, strings and hum::Vector3.
+     */
+    template <typename... Args>
+    void log(Level level, const char* format, const Args&... args);
+
+    //! Log a record of level DEBUG. Compiled out with NDEBUG.
+    template <typename... Args>
+    void log_d(const char* format, const Args&... args);
+
+    //! Log a record of level INFO.
+    template <typename... Args>
+    void log_i(const char* format, const Args&... args);
+
+    //! Log a record of level WARNING.
+    template <typename... Args>
+    void log_w(const char* format, const Args&... args);
+
+    //! Log a record of level ERROR.
+    template <typename... Args>
+    void log_e(const char* format, const Args&... args);
+
+    //! Wait until every record logged so far is written.
+    void flush();
+
+    //! Set what threads do when their ring buffer is full.
+    void setFullPolicy(FullPolicy policy);
+
+    //! Get what threads do when their ring buffer is full.
+    FullPolicy getFullPolicy() const;
+
+    //! Get the number of records discarded because a ring buffer was full.
+    unsigned long long dropped() const;
+
+    //! Get the number of records written so far.
+    unsigned long long written() const;
+
+private:
+    // Tag of an encoded argument
+    enum class Type : std::uint8_t
+    {
+        BOOL,
+        CHAR,
+        INT,
+        UINT,
+        FLOAT,
+        STRING,
+        VECTOR3
+    };
+
+    // Header of a record, followed by the encoded arguments
+    struct Record_t {
+        std::uint32_t size;
+        Level level;
+        std::uint8_t arg_count;
+        std::int64_t time;
+        const char* format;
+    };
+
+    // Single producer, single consumer byte ring
+    struct Ring_t {
+        Ring_t(std::size_t capacity);
+        bool push(const char* data, std::size_t size);
+        bool pop(char* data);
+        bool empty() const;
+
+        std::vector<char> buffer;
+        std::size_t mask;
+        // Bytes written and read since the start, on their own cache lines
+        alignas(64) std::atomic<std::size_t> head;
+        alignas(64) std::atomic<std::size_t> tail;
+        // Set when its thread exits, the writer thread frees it once drained
+        std::atomic<bool> orphaned;
+    };
+
+    // Rings of a thread by AsyncLog id, with the last one used up front
+    struct ThreadRings_t {
+        ~ThreadRings_t();
+
+        unsigned long long last_owner = 0;
+        Ring_t* last_ring = nullptr;
+        std::unordered_map<unsigned long long, std::shared_ptr<Ring_t>> rings;
+    };
+
+    AsyncLog(const AsyncLog&) =delete;
+    AsyncLog& operator=(const AsyncLog&) =delete;
+
+    static void encode(char*& out, char* end, bool value);
+    static void encode(char*& out, char* end, char value);
+    static void encode(char*& out, char* end, const char* value);
+    static void encode(char*& out, char* end, const std::string& value);
+    static void encode(char*& out, char* end, const std::string_view& value);
+    template <typename T>
+    static void encode(char*& out, char* end, const hum::Vector3<T>& value);
+    template <typename T>
+    static typename std::enable_if<std::is_arithmetic<T>::value>::type encode(char*& out, char* end, T value);
+    static void encodeString(char*& out, char* end, const char* value, std::size_t size);
+    static void encodeRaw(char*& out, char* end, Type type, const void* value, std::size_t size);
+
+    Ring_t& threadRing();
+    void submit(const char* record, std::size_t size);
+    void writerLoop();
+    bool writePending();
+    void write(const char* record);
+
+    std::size_t _ring_size;
+    std::atomic<FullPolicy> _policy;
+    std::FILE* _output;
+    static thread_local ThreadRings_t t_rings;
+
+    std::mutex _rings_mutex;
+    // Writers only lock it to add their ring, the writer thread while draining
+    std::vector<std::shared_ptr<Ring_t>> _rings;
+    std::atomic<unsigned long long> _dropped, _written;
+    std::atomic<bool> _stop;
+    std::mutex _wake_mutex;
+    std::condition_variable _wake;
+    std::thread _writer;
+    std::int64_t _start;
+    // Identifies the AsyncLog in the thread_local rings of each thread
+    unsigned long long _id;
+    std::string _line;
+};
+
+/*!
+  \class AsyncLog
+  \brief Plugin that moves the formatting and output of log records off the logging threads.
+
+  A log call only encodes its arguments in binary next to the address of its
+  format string and copies them into the ring buffer of the calling thread,
+  without locks or allocations. A writer thread collects the records,
+  formats them and writes them to the output, so logging in fixedUpdate()
+  costs a few copies instead of formatting and I/O.
+
+  Records of one thread keep their order, records of different threads may
+  interleave.
+
+  \code
+  AsyncLog* log = game().getPlugin<AsyncLog>();
+  log->log_d("Actor {} position: {}", actor().id(), actor().transform().position);
+  \endcode
+*/
+
+
+template <typename... Args>
+void AsyncLog::log(Level level, const char* format, const Args&... args)
+{
+    static_assert(sizeof...(Args) < 256, "Too many arguments for AsyncLog");
+    char record[MAX_RECORD];
+    char* out = record + sizeof(Record_t);
+    char* end = record + MAX_RECORD;
+    // Expands encode() for every argument, in order
+    int expand[] = {0, (encode(out, end, args), 0)...};
+    (void) expand;
+
+    Record_t header;
+    header.size = out - record;
+    header.level = level;
+    header.arg_count = sizeof...(Args);
+    header.time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    header.format = format;
+    std::memcpy(record, &header, sizeof(Record_t));
+    submit(record, header.size);
+}
+
+template <typename... Args>
+void AsyncLog::log_d(const char* format, const Args&... args)
+{
+#ifndef NDEBUG
+    log(Level::DEBUG, format, args...);
+#endif
+}
+
+template <typename... Args>
+void AsyncLog::log_i(const char* format, const Args&... args)
+{
+    log(Level::INFO, format, args...);
+}
+
+template <typename... Args>
+void AsyncLog::log_w(const char* format, const Args&... args)
+{
+    log(Level::WARNING, format, args...);
+}
+
+template <typename... Args>
+void AsyncLog::log_e(const char* format, const Args&... args)
+{
+    log(Level::ERROR, format, args...);
+}
+
+template <typename T>
+void AsyncLog::encode(char*& out, char* end, const hum::Vector3<T>& value)
+{
+    double xyz[3] = {double(value.x), double(value.y), double(value.z)};
+    encodeRaw(out, end, Type::VECTOR3, xyz, sizeof(xyz));
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type AsyncLog::encode(char*& out, char* end, T value)
+{
+    if (std::is_floating_point<T>::value)
+    {
+        double raw = value;
+        encodeRaw(out, end, Type::FLOAT, &raw, sizeof(raw));
+    }
+    else if (std::is_signed<T>::value)
+    {
+        std::int64_t raw = value;
+        encodeRaw(out, end, Type::INT, &raw, sizeof(raw));
+    }
+    else
+    {
+        std::uint64_t raw = value;
+        encodeRaw(out, end, Type::UINT, &raw, sizeof(raw));
+    }
+}
+#endif /* ifndef ASYNC_LOG_HPP */
@@ -0,0 +1,266 @@
+#ifndef COLLISION_SYSTEM_HPP
+#define COLLISION_SYSTEM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "hummingbird/hum.hpp"
+
+class Collider;
+class JobSystem;
+
+class CollisionSystem : public hum::Plugin
+{
+public:
+    //! Pair of overlapping Collider%s. <a> is the one with the lower address.
+    struct Contact_t {
+        Collider* a;
+        Collider* b;
+    };
+
+    /*!
+      \brief Class constructor with the side of the cells of the spatial hash.
+
+      Cells about the size of the common colliders work best: much smaller
+      cells make colliders span many of them, much larger ones put many
+      colliders that don't touch in the same cell.
+     */
+    CollisionSystem(float cell_size = 64.f);
+
+    void gameStart() override;
+
+    /*!
+      \brief Find the contacts and call the Collider callbacks.
+
+      Runs after the fixed update of the plugins added before, so add the
+      CollisionSystem after KinematicSystem to test the moved positions.
+     */
+    void postFixedUpdate() override;
+
+    //! Set the side of the cells of the spatial hash. Rebuilds it.
+    void setCellSize(float cell_size);
+
+    //! Get the side of the cells of the spatial hash.
+    float getCellSize() const;
+
+    /*!
+      \brief Set whether to split the work across the JobSystem plugin, if present.
+
+      By default enabled.
+     */
+    void setMultithreaded(bool multithreaded);
+
+    //! Get whether the work is split across the JobSystem plugin.
+    bool isMultithreaded() const;
+
+    //! Get the pairs that started touching in the last fixed update.
+    const std::vector<Contact_t>& begun() const;
+
+    //! Get the pairs that were already touching and still touch.
+    const std::vector<Contact_t>& stayed() const;
+
+    //! Get the pairs that stopped touching in the last fixed update.
+    const std::vector<Contact_t>& ended() const;
+
+    /*!
+      \brief Append to <result> the Collider%s that overlap the box [<min>, <max>].
+
+      Uses the positions of the last fixed update. Only x and y are used.
+     */
+    void query(const hum::Vector3f& min, const hum::Vector3f& max, std::vector<Collider*>& result) const;
+
+    //! Get the number of colliders in the system.
+    std::size_t size() const;
+
+private:
+    friend class Collider;
+
+    // Cells [x0, x1] x [y0, y1] covered by a collider
+    struct CellRange_t {
+        int x0, y0, x1, y1;
+        bool operator==(const CellRange_t& other) const;
+    };
+
+    // Indices of two overlapping colliders
+    struct Pair_t {
+        unsigned int a, b;
+    };
+
+    struct CellHash {
+        std::size_t operator()(std::uint64_t key) const;
+    };
+
+    CollisionSystem(const CollisionSystem&) =delete;
+    CollisionSystem& operator=(const CollisionSystem&) =delete;
+
+    void add(Collider* collider);
+    void remove(Collider* collider);
+
+    CellRange_t cellRange(float min_x, float min_y, float max_x, float max_y) const;
+    static std::uint64_t cellKey(int x, int y);
+    void insertCells(unsigned int index, const CellRange_t& range);
+    void eraseCells(unsigned int index, const CellRange_t& range);
+    void renameCells(unsigned int from, unsigned int to, const CellRange_t& range);
+
+    void forEachRange(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& job);
+    void gather(std::size_t begin, std::size_t end);
+    void findPairs(std::size_t begin, std::size_t end, std::vector<Pair_t>& pairs);
+    void narrowphase(const std::vector<Pair_t>& candidates, std::vector<Pair_t>& pairs) const;
+    void dispatchEvents();
+
+    float _cell_size;
+    bool _multithreaded;
+    JobSystem* _job_system;
+
+    std::vector<Collider*> _colliders;
+    std::vector<hum::Actor*> _actors;
+    // Every collider is a box of half size (_hx, _hy) grown by _radius around (_x, _y):
+    // a plain box has no radius, a circle no half size.
+    std::vector<float> _x, _y, _hx, _hy, _radius;
+    std::vector<CellRange_t> _ranges, _new_ranges;
+    std::unordered_map<std::uint64_t, std::vector<unsigned int>, CellHash> _cells;
+
+    // Cells of _cells in an array, to split them in ranges
+    std::vector<const std::pair<const std::uint64_t, std::vector<unsigned int>>*> _cell_list;
+    // Pairs found by each range of findPairs()
+    std::vector<std::vector<Pair_t>> _range_pairs;
+    // Touching pairs of this and the previous fixed update, sorted
+    std::vector<Contact_t> _contacts, _previous_contacts;
+    std::vector<Contact_t> _begun, _stayed, _ended;
+    // Colliders removed since the last fixed update
+    std::vector<Collider*> _removed;
+};
+
+/*!
+  \class CollisionSystem
+  \brief Plugin that finds the overlapping BoxCollider%s and CircleCollider%s every fixed update.
+
+  Colliders are kept in a spatial hash of square cells on the x/y plane. The
+  hash is updated incrementally: only the colliders that moved to other cells
+  are touched. Each cell tests the colliders it holds against each other, so
+  the cost grows with the number of colliders and contacts instead of with
+  its square. Candidate pairs are tested four at a time with SIMD (SSE when
+  available) and the work is split across the JobSystem plugin when present.
+
+  The contacts are compared with the ones of the previous fixed update to
+  report begin, stay and end events, both as lists (begun(), stayed(),
+  ended()) and through the callbacks of the Collider%s. Pairs with a
+  destroyed or deactivated collider are forgotten without an end event, and
+  the lists are only valid until the next fixed update or until one of their
+  colliders is destroyed.
+
+  \code
+  game.addPlugin<KinematicSystem>();
+  game.addPlugin<CollisionSystem>(32.f);
+  //...
+  CircleCollider* collider = actor->addBehavior<CircleCollider>(5.f);
+  collider->setBeginCallback([](Collider& other)
+  {
+      hum::log("Hit actor ", other.actor().id());
+  });
+  \endcode
+*/
+
+
+class Collider : public hum::Behavior
+{
+public:
+    //! Function called with the other Collider of a contact.
+    typedef std::function<void(Collider& other)> Callback;
+
+    void init() override;
+    void onActivate() override;
+    void onDeactivate() override;
+    void onDestroy() override;
+
+    /*!
+      \brief Set the offset of the collider from the position of the actor.
+
+      Not scaled nor rotated with the actor. Only x and y are used.
+     */
+    void setOffset(const hum::Vector3f& offset);
+
+    //! Get the offset of the collider from the position of the actor.
+    const hum::Vector3f& getOffset() const;
+
+    //! Set the function called when a Collider starts touching this one.
+    void setBeginCallback(const Callback& callback);
+
+    //! Set the function called every fixed update a Collider keeps touching this one.
+    void setStayCallback(const Callback& callback);
+
+    //! Set the function called when a Collider stops touching this one.
+    void setEndCallback(const Callback& callback);
+
+protected:
+    //! Class constructor with the half size of the box and the radius around it.
+    Collider(float half_width, float half_height, float radius);
+
+    float _half_width, _half_height, _radius;
+
+private:
+    friend class CollisionSystem;
+
+    void attach();
+    void detach();
+
+    CollisionSystem* _system;
+    // Index in the arrays of _system, -1 while not in it
+    long long _index;
+    hum::Vector3f _offset;
+    Callback _begin_callback, _stay_callback, _end_callback;
+};
+
+/*!
+  \class Collider
+  \brief Base of the behaviors that make an Actor collide in the CollisionSystem.
+
+  The size of a collider is multiplied by the scale of the actor, its
+  rotation is ignored.
+*/
+
+
+class BoxCollider : public Collider
+{
+public:
+    //! Class constructor with the size of the box, centered on the actor.
+    BoxCollider(const hum::Vector3f& size);
+
+    //! Set the size of the box. Only x and y are used.
+    void setSize(const hum::Vector3f& size);
+
+    //! Get the size of the box.
+    hum::Vector3f getSize() const;
+
+    static const char* behaviorName();
+};
+
+/*!
+  \class BoxCollider
+  \brief Axis aligned box Collider.
+*/
+
+
+class CircleCollider : public Collider
+{
+public:
+    //! Class constructor with the radius of the circle, centered on the actor.
+    CircleCollider(float radius);
+
+    //! Set the radius of the circle.
+    void setRadius(float radius);
+
+    //! Get the radius of the circle.
+    float getRadius() const;
+
+    static const char* behaviorName();
+};
+
+/*!
+  \class CircleCollider
+  \brief Circle Collider. Scaled by the largest of the x and y scale of the actor.
+*/
+#endif /* COLLISION_SYSTEM_HPP */
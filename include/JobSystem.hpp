@@ -0,0 +1,82 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "hummingbird/hum.hpp"
+
+class JobSystem : public hum::Plugin
+{
+public:
+    //! Function run on a range [begin, end) of a parallelFor().
+    typedef std::function<void(std::size_t begin, std::size_t end)> RangeJob;
+
+    /*!
+      \brief Class constructor.
+
+      <worker_count> threads are started besides the calling one. By default one
+      less than the number of hardware threads.
+     */
+    JobSystem(unsigned int worker_count = defaultWorkerCount());
+
+    //! Class destructor. Stops the workers.
+    ~JobSystem();
+
+    /*!
+      \brief Run <job> over [0, count) split in ranges of at least <grain>
+      elements, and wait for all of them.
+
+      The calling thread works too. Calls from inside a job run serially.
+     */
+    void parallelFor(std::size_t count, std::size_t grain, const RangeJob& job);
+
+    //! Get the number of threads that run jobs, counting the calling one.
+    unsigned int threadCount() const;
+
+    static unsigned int defaultWorkerCount();
+
+private:
+    JobSystem(const JobSystem&) =delete;
+    JobSystem& operator=(const JobSystem&) =delete;
+
+    void workerLoop();
+    void runRanges();
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake, _done;
+    bool _stop;
+    unsigned long long _generation;
+
+    // State of the parallelFor() being run
+    const RangeJob* _job;
+    std::size_t _count, _grain;
+    std::atomic<std::size_t> _next;
+    std::atomic<unsigned int> _busy;
+    bool _running;
+};
+
+/*!
+  \class JobSystem
+  \brief Plugin owning a pool of worker threads to split data parallel work.
+
+  Systems that can split their work look for it with
+  `game().getPlugin<JobSystem>()` and run serially when it is not there.
+
+  \code
+  game.addPlugin<JobSystem>();
+  //...
+  game().getPlugin<JobSystem>()->parallelFor(count, 4096, [&](std::size_t begin, std::size_t end)
+  {
+      for (std::size_t i = begin; i < end; ++i)
+      {
+          positions[i] += velocities[i] * dt;
+      }
+  });
+  \endcode
+*/
+#endif /* ifndef JOB_SYSTEM_HPP */
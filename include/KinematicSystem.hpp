@@ -0,0 +1,165 @@
+#ifndef KINEMATIC_SYSTEM_HPP
+#define KINEMATIC_SYSTEM_HPP
+
+#include <cstddef>
+#include <vector>
+#include "hummingbird/hum.hpp"
+
+class JobSystem;
+class KinematicBody;
+
+class KinematicSystem : public hum::Plugin
+{
+public:
+    //! Class constructor.
+    KinematicSystem();
+
+    void gameStart() override;
+    void postFixedUpdate() override;
+
+    /*!
+      \brief Interpolate every body <lag> ahead of its last fixed update.
+
+      The results are read with KinematicBody::simulated(). Calling it again
+      with the same <lag> and no fixed update in between does nothing.
+     */
+    void simulate(const hum::Time& lag);
+
+    //! Get the number of bodies in the system.
+    std::size_t size() const;
+
+    /*!
+      \brief Set whether to split the work across the JobSystem plugin, if present.
+
+      By default enabled.
+     */
+    void setMultithreaded(bool multithreaded);
+
+    //! Get whether the work is split across the JobSystem plugin.
+    bool isMultithreaded() const;
+
+    /*!
+      \brief Set the number of bodies per job.
+
+      By default 4096.
+     */
+    void setGrain(std::size_t grain);
+
+    //! Get the number of bodies per job.
+    std::size_t getGrain() const;
+
+private:
+    friend class KinematicBody;
+
+    // position, rotation and scale, x y z each
+    static const unsigned int CHANNELS = 9;
+
+    typedef std::vector<float> Channels[CHANNELS];
+
+    KinematicSystem(const KinematicSystem&) =delete;
+    KinematicSystem& operator=(const KinematicSystem&) =delete;
+
+    void add(KinematicBody* body, const hum::Transformation& velocity, const hum::Transformation& acceleration);
+    void remove(KinematicBody* body);
+    hum::Transformation get(const Channels& channels, std::size_t index) const;
+    void set(Channels& channels, std::size_t index, const hum::Transformation& value);
+
+    void forEachRange(void (KinematicSystem::*function)(std::size_t, std::size_t, float), float dt);
+    void step(std::size_t begin, std::size_t end, float dt);
+    void interpolate(std::size_t begin, std::size_t end, float lag);
+    void gather(std::size_t begin, std::size_t end);
+    void scatter(std::size_t begin, std::size_t end);
+
+    JobSystem* _job_system;
+    bool _multithreaded;
+    std::size_t _grain;
+    std::vector<KinematicBody*> _bodies;
+    std::vector<hum::Actor*> _actors;
+    Channels _transform, _velocity, _acceleration, _simulated;
+    unsigned long long _step, _simulated_step;
+    long long _simulated_lag;
+    bool _simulated_valid;
+};
+
+/*!
+  \class KinematicSystem
+  \brief Plugin that moves every KinematicBody in one batched pass per fixed update.
+
+  Data oriented replacement for hum::KinematicWorld. Transforms, velocities and
+  accelerations of all the bodies are kept in contiguous arrays, one per
+  component, integrated with SIMD (SSE when available) and split across the
+  JobSystem plugin when it is present.
+
+  Each fixed update the system picks up the actor transforms changed by other
+  code, integrates and writes the result back to the actors, so
+  `actor().transform()` stays the source of truth.
+
+  rendering::Plugin interpolates the bodies with one call to simulate() per
+  frame instead of one hum::Kinematic::simulate() per actor.
+
+  \code
+  game.addPlugin<JobSystem>();
+  game.addPlugin<KinematicSystem>();
+  //...
+  KinematicBody* body = actor->addBehavior<KinematicBody>();
+  hum::Transformation velocity;
+  velocity.position.x = 10;
+  body->setVelocity(velocity);
+  \endcode
+*/
+
+
+class KinematicBody : public hum::Behavior
+{
+public:
+    //! Class constructor.
+    KinematicBody();
+
+    void init() override;
+    void onActivate() override;
+    void onDeactivate() override;
+    void onDestroy() override;
+
+    //! Set the velocity, per second.
+    void setVelocity(const hum::Transformation& velocity);
+
+    //! Get the velocity.
+    hum::Transformation getVelocity() const;
+
+    //! Set the acceleration, per second squared.
+    void setAcceleration(const hum::Transformation& acceleration);
+
+    //! Get the acceleration.
+    hum::Transformation getAcceleration() const;
+
+    /*!
+      \brief Get the transform interpolated by the last KinematicSystem::simulate().
+
+      Same as `actor().transform()` if the body is not in the system.
+     */
+    hum::Transformation simulated() const;
+
+    static const char* behaviorName();
+
+private:
+    friend class KinematicSystem;
+
+    void attach();
+    void detach();
+
+    KinematicSystem* _system;
+    // Index in the arrays of _system, -1 while not in it
+    long long _index;
+    // Used while the body is not in the system
+    hum::Transformation _velocity, _acceleration;
+};
+
+/*!
+  \class KinematicBody
+  \brief Behavior that gives an Actor a velocity and an acceleration integrated by KinematicSystem.
+
+  Counterpart of hum::Kinematic. The velocity and acceleration are stored by
+  the KinematicSystem, so they are set and read by value. Inactive bodies are
+  taken out of the system and keep their values until they are activated again.
+*/
+#endif /* KINEMATIC_SYSTEM_HPP */
@@ -0,0 +1,72 @@
+#ifndef TICK_RUNNER_HPP
+#define TICK_RUNNER_HPP
+
+#include <vector>
+#include "hummingbird/hum.hpp"
+
+class TickRunner : public hum::Plugin
+{
+public:
+    /*!
+      \brief Class constructor.
+
+      Stops the game after <ticks> fixed updates. 0 never stops it, the ticks
+      are only timed.
+     */
+    TickRunner(unsigned long long ticks);
+
+    void gameStart() override;
+    void preFixedUpdate() override;
+    void preUpdate() override;
+
+    //! Get the number of fixed updates timed so far.
+    unsigned long long ticks() const;
+
+    //! Get the time of every fixed update timed, in milliseconds.
+    const std::vector<float>& tickTimes() const;
+
+    //! Get the mean time of a fixed update, in milliseconds.
+    float mean() const;
+
+    /*!
+      \brief Get the time under which the <percentile> (in [0, 1]) of the fixed updates ran, in milliseconds.
+
+      Same range as RenderStatistics::percentile(): 0.99f gives the 99th percentile.
+     */
+    float percentile(float percentile) const;
+
+    //! Get the number of fixed updates that fit in a second at the mean time.
+    float ticksPerSecond() const;
+
+private:
+    void endTick();
+
+    unsigned long long _max_ticks;
+    std::vector<float> _tick_times;
+    bool _in_tick;
+    hum::Clock _clock;
+};
+
+/*!
+  \class TickRunner
+  \brief Plugin that times the fixed updates and ends the game after a number of them.
+
+  Meant for benchmarks and simulations, together with a headless
+  rendering::Plugin. A tick goes from the preFixedUpdate() of this Plugin to
+  the next preFixedUpdate() or preUpdate(), so it must be the first Plugin
+  added for the time to cover all the others and the fixed updates of the
+  behaviors.
+
+  The game loop still paces the fixed updates to the fixed update time: they
+  only run back to back when one costs more than it. ticksPerSecond() is the
+  capacity given by the time they take, not how many ran in a second.
+
+  \code
+  TickRunner* runner = game.addPlugin<TickRunner>(600);
+  game.addPlugin<rendering::Plugin>(true);
+  //...
+  game.run();
+  hum::log("p99: ", runner->percentile(0.99f), " ms");
+  \endcode
+*/
+#endif /* TICK_RUNNER_HPP */
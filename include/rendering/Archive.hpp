@@ -0,0 +1,110 @@
+#ifndef RENDERING_ARCHIVE_HPP
+#define RENDERING_ARCHIVE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ArchiveFormat.hpp"
+
+namespace rendering
+{
+class Archive
+{
+public:
+    //! Class constructor
+    Archive();
+
+    //! Class destructor. Views returned by the Archive are invalid afterwards.
+    ~Archive();
+
+    /*!
+      \brief Memory-map the archive <filename> (see archive_format).
+
+      \return Whether the file could be mapped and is a valid archive.
+     */
+    bool open(const std::string& filename);
+
+    //! Unmap the archive, if open.
+    void close();
+
+    //! Get whether an archive is open.
+    bool isOpen() const;
+
+    //! Get whether the archive has an entry named <name>.
+    bool contains(std::string_view name) const;
+
+    /*!
+      \brief Get the contents of the entry <name>.
+
+      Uncompressed entries are served straight from the mapping, with no
+      copy. Compressed ones are decompressed once and kept until the Archive
+      is closed.
+
+      \return The contents, or a view with a null data() if there is no such entry.
+     */
+    std::string_view get(std::string_view name);
+
+    //! Get the number of entries.
+    std::size_t size() const;
+
+    /*!
+      \brief Make <archive> visible to the loaders, before the file system.
+
+      Shader::loadFromFile(), MeshData::loadFromFile() and Font::loadFromFile()
+      look their file name up in the mounted archives first, the last mounted
+      first (shaders compiled into the engine come before them, see
+      embedded_shaders). The Archive must exist while it is mounted.
+     */
+    static void mount(Archive* archive);
+
+    //! Stop serving files from <archive>.
+    static void unmount(Archive* archive);
+
+    /*!
+      \brief Find <name> in the mounted archives.
+
+      \return The contents, or a view with a null data() if no mounted archive has it.
+     */
+    static std::string_view findMounted(std::string_view name);
+
+private:
+    Archive(const Archive&) =delete;
+    Archive& operator=(const Archive&) =delete;
+
+    const archive_format::Entry* find(std::string_view name) const;
+
+    static std::vector<Archive*> _mounted;
+
+    void* _mapping;
+    std::size_t _mapping_size;
+    const archive_format::Header* _header;
+    const archive_format::Entry* _table;
+    const char* _names;
+    // Decompressed entries, by their slot in the table
+    std::unordered_map<const archive_format::Entry*, std::unique_ptr<char[]>> _decompressed;
+};
+
+/*!
+  \class rendering::Archive
+  \brief A memory-mapped pack of assets, built with tools/pack.
+
+  Opening an archive is one file open and one mapping, and looking an entry up
+  is a hash and usually one probe, whatever the working directory is.
+
+  \code
+  rendering::Archive assets;
+  if (assets.open("assets.pak"))
+  {
+      rendering::Archive::mount(&assets);
+  }
+  // From here "meshes/ship.mesh" is read from the archive
+  \endcode
+
+  Build the archive with `make assets`. LZ4 compressed entries need the tree
+  built with `make LZ4=1`.
+*/
+}
+#endif /* RENDERING_ARCHIVE_HPP */
@@ -0,0 +1,74 @@
+#ifndef RENDERING_ARCHIVE_FORMAT_HPP
+#define RENDERING_ARCHIVE_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rendering
+{
+namespace archive_format
+{
+//! "RPAK" in little endian.
+const std::uint32_t MAGIC = 0x4B415052;
+const std::uint32_t VERSION = 1;
+
+//! Default alignment, in bytes, of the data of every entry.
+const std::uint32_t DEFAULT_ALIGNMENT = 16;
+
+//! Entry::flags bits.
+const std::uint32_t FLAG_USED = 1;
+const std::uint32_t FLAG_LZ4 = 2;
+
+//! First bytes of an archive. All the values are little endian.
+struct Header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t entry_count;
+    //! Number of Entry slots of the table, a power of two.
+    std::uint32_t table_size;
+    //! Offset of the Entry table, from the start of the file.
+    std::uint64_t table_offset;
+    //! Offset of the names, stored one after the other without terminators.
+    std::uint64_t names_offset;
+};
+
+//! A slot of the open addressing (linear probing) table of contents.
+struct Entry
+{
+    //! hash() of the name. The slot of an entry is hash & (table_size - 1) or the next free one.
+    std::uint64_t hash;
+    std::uint64_t offset;
+    //! Size in the archive, compressed or not.
+    std::uint64_t size;
+    //! Size once decompressed. Equal to size if not compressed.
+    std::uint64_t original_size;
+    //! Name of the entry, relative to names_offset.
+    std::uint32_t name_offset;
+    std::uint32_t name_size;
+    std::uint32_t flags;
+    std::uint32_t padding;
+};
+
+//! 64 bit FNV-1a hash of the entry names.
+inline std::uint64_t hash(const char* name, std::size_t size)
+{
+    std::uint64_t value = 0xCBF29CE484222325ull;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        value ^= static_cast<unsigned char>(name[i]);
+        value *= 0x100000001B3ull;
+    }
+    return value;
+}
+}
+/*!
+  \namespace rendering::archive_format
+  \brief Layout of the asset archives written by tools/pack.
+
+  An archive is a Header, the data of every entry (each aligned, so it can be
+  used in place), the Entry table and the names. Entries may be LZ4
+  compressed when that makes them smaller.
+*/
+}
+#endif /* RENDERING_ARCHIVE_FORMAT_HPP */
@@ -0,0 +1,31 @@
+#ifndef RENDERING_BATCH_HPP
+#define RENDERING_BATCH_HPP
+
+namespace rendering
+{
+class Batch
+{
+public:
+    virtual ~Batch() {}
+
+    /*!
+      \brief Draw everything accumulated since the last flush and clear it.
+
+      Called by rendering::Plugin after all the Drawable%s of a View have been
+      drawn, with the View still bound.
+     */
+    virtual void flush() =0;
+};
+
+/*!
+  \class rendering::Batch
+  \brief Interface for objects that accumulate the geometry of many Drawable%s
+  and draw it at once.
+
+  A Drawable using a Batch appends its geometry to it from Drawable::draw()
+  (already in world space, see rendering::Plugin::currentModelMatrix()) instead
+  of issuing its own draw call. Batches are registered with
+  rendering::Plugin::addBatch().
+*/
+}
+#endif /* RENDERING_BATCH_HPP */
@@ -117,6 +117,14 @@ public:
      */
     const glm::mat4& getView();
 
+    /*!
+      \brief Get the planes of the frustum of the camera. (Internal use only).
+
+      Normalized and pointing inside, in the order left, right, bottom, top,
+      near and far.
+     */
+    void getFrustumPlanes(glm::vec4 planes[6]);
+
     /*!
       \brief Return whether the projection matrix has changed since the last
       getProjection(). (Internal use only).
@@ -1,12 +1,17 @@
 #ifndef RENDERING_DRAWABLE_HPP
 #define RENDERING_DRAWABLE_HPP
 
+#include <vector>
 #include <GL/glew.h>
 #include "hummingbird/hum.hpp"
+#include "common.hpp"
 #include "ShaderProgram.hpp"
 
 namespace rendering
 {
+class Plugin;
+class Texture;
+
 class Drawable : public hum::Behavior
 {
 public:
@@ -39,10 +44,29 @@ public:
     */
     bool isEnabled() const;
 
+    /*!
+      \brief Mark the Drawable as static: it is not expected to move.
+
+      Static opaque Rectangle%s are baked, already in world space, into the vertex
+      buffer of their spatial cell with the other static ones and drawn with
+      the whole cell in one draw call (see StaticBatcher). Moving, changing
+      the Material of or disabling one re-bakes its cell, so only mark the
+      ones that seldom change. Other Drawable%s, translucent Rectangle%s
+      included, are drawn as usual.
+
+      A Drawable is not static by default.
+    */
+    void setStatic(bool is_static);
+
+    //! Get whether the Drawable is marked as static.
+    bool isStatic() const;
+
     /*!
       \brief Get a reference to the Drawable's hum::Transformation.
 
-      This hum::Transformation is relative to the Drawable's hum::Actor.
+      This hum::Transformation is relative to the Drawable's hum::Actor, or to
+      its parent if it has one. Getting it this way marks it as changed, so
+      its world transformation and the ones of its children get recomputed.
 
       \return Drawable's hum::Transformation..
     */
@@ -51,12 +75,28 @@ public:
     /*!
       \brief Get a constant reference to the Drawable's hum::Transformation.
 
-      This hum::Transformation is relative to the Drawable's hum::Actor.
+      This hum::Transformation is relative to the Drawable's hum::Actor, or to
+      its parent if it has one.
 
       \return Drawable's hum::Transformation..
     */
     const hum::Transformation& transform() const;
 
+    /*!
+      \brief Attach the Drawable to <parent>, or detach it with nullptr.
+
+      A Drawable with a parent is placed relative to the parent's world
+      transformation instead of to its own hum::Actor. The parent may belong to
+      another hum::Actor, but it can't be a descendant of this Drawable.
+     */
+    void setParent(Drawable* parent);
+
+    //! Get the parent of the Drawable, nullptr if it has none.
+    Drawable* getParent() const;
+
+    //! Get the Drawable%s attached to this one.
+    const std::vector<Drawable*>& children() const;
+
     /*!
       \brief Set the ShaderProgram to use with the Drawable.
 
@@ -96,13 +136,108 @@ public:
      */
     const hum::Vector3f& getOrigin() const;
 
+    /*!
+      \brief Set the bounding sphere of the Drawable, used for level of detail.
+
+      <center> is in the same local coordinates as the geometry. A <radius> of
+      0 (the default) disables level of detail selection.
+     */
+    void setBounds(const hum::Vector3f& center, float radius);
+
+    //! Get the center of the bounding sphere.
+    const hum::Vector3f& getBoundsCenter() const;
+
+    //! Get the radius of the bounding sphere.
+    float getBoundsRadius() const;
+
+    /*!
+      \brief Draw <level> instead of this Drawable when it looks smaller than <screen_size>.
+
+      <screen_size> is the projected diameter of the bounding sphere over the
+      height of the View. <level> is attached to this Drawable (see
+      setParent()) and is only drawn in its place. Any number of levels can be
+      added, coarser ones with smaller sizes. The Drawable needs bounds.
+     */
+    void addLevelOfDetail(Drawable* level, float screen_size);
+
+    /*!
+      \brief Draw a flat, batched quad of <color> when the Drawable looks smaller than <screen_size>.
+
+      The quad faces the camera and covers the bounding sphere. All the
+      impostors of a View are drawn with one draw call. A <screen_size> of 0
+      disables it.
+     */
+    void setImpostor(const Color& color, float screen_size);
+
+    /*!
+      \brief Get the level of detail drawn last.
+
+      0 is this Drawable, then the added levels in order. One past the last
+      level is the impostor.
+     */
+    unsigned int levelOfDetail() const;
+
+    /*!
+      \brief Get whether the Drawable is a unit quad with the default shading of Rectangle, and the index of its Material. (Internal use only).
+
+      Those can be drawn without the Drawable: by the GPU-driven path (see
+      Plugin::setGpuDriven()) or baked in a static batch (see setStatic()).
+      By default false.
+     */
+    virtual bool unitQuadMaterial(unsigned int& material) const;
+
+    /*!
+      \brief Get whether the Drawable covers the unit quad [0, 1]x[0, 1] of its model space, and whether it is opaque. (Internal use only).
+
+      Used by the occlusion culling (see Plugin::setOcclusionCulling()): opaque
+      quads hide what is behind them, any quad can be hidden. By default false.
+     */
+    virtual bool coversUnitQuad(bool& opaque) const;
+
+    /*!
+      \brief Get the Texture mapped over the unit quad [0, 1]x[0, 1] of its model space. (Internal use only).
+
+      rendering::Plugin tells the TextureManager how big it is drawn, which
+      picks the mip levels kept resident. By default nullptr.
+     */
+    virtual Texture* texture() const;
+
     static const char* behaviorName();
 
+protected:
+    /*!
+      \brief Get whether the rendering::Plugin is headless.
+
+      Derived classes must not touch OpenGL in init() nor setShaderProgram()
+      when it is: there is no context.
+     */
+    bool isHeadless() const;
+
 private:
+    friend class Plugin;
+
+    struct LevelOfDetail_t {
+        Drawable* drawable;
+        float screen_size;
+    };
+
     bool _is_enabled;
+    bool _is_static;
+    // Set whenever the local transformation or origin may have changed, cleared by the Plugin
+    bool _transform_changed;
     hum::Transformation _transform;
     hum::Vector3f _origin;
     ShaderProgram* _shader_program;
+    Drawable* _parent;
+    std::vector<Drawable*> _children;
+    hum::Vector3f _bounds_center;
+    float _bounds_radius;
+    // Sorted from the finest to the coarsest
+    std::vector<LevelOfDetail_t> _levels;
+    Drawable* _lod_owner;
+    unsigned int _lod_level;
+    Color _impostor_color;
+    float _impostor_screen_size;
 };
 
 /*!
@@ -114,6 +249,9 @@ private:
   id relative to its hum::Actor one; An origin for defining the center; shaderProgram
   setter and getters; and the ability to disable and enable it.
 
+  Drawable%s can be attached to a parent Drawable (see setParent()) to build
+  composite objects, like a turret on a tank, without extra hum::Actor%s.
+
   Example:
   \code
   class MyDrawable : public mogl::Drawable
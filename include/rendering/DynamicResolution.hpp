@@ -0,0 +1,84 @@
+#ifndef RENDERING_DYNAMIC_RESOLUTION_HPP
+#define RENDERING_DYNAMIC_RESOLUTION_HPP
+
+namespace rendering
+{
+class DynamicResolution
+{
+public:
+    /*!
+      \brief Default constructor.
+
+      Constructs the controller with the following default values:
+      \code
+      rendering::DynamicResolution dr;
+      dr.setTargetFrameTime(16.f);
+      dr.setScaleBounds(0.5f, 1.f);
+      dr.setHeadroom(0.1f);
+      \endcode
+     */
+    DynamicResolution();
+
+    //! Set the GPU frame time, in milliseconds, that the controller tries to hold.
+    void setTargetFrameTime(float milliseconds);
+
+    //! Get the GPU frame time, in milliseconds, that the controller tries to hold.
+    float getTargetFrameTime() const;
+
+    /*!
+      \brief Set the bounds of the resolution scale.
+
+      The scale is applied to both the width and the height of the window.
+      Bounds are clamped to (0, 1].
+     */
+    void setScaleBounds(float min_scale, float max_scale);
+
+    //! Get the lower bound of the resolution scale.
+    float getMinScale() const;
+
+    //! Get the upper bound of the resolution scale.
+    float getMaxScale() const;
+
+    /*!
+      \brief Set the fraction of the target frame time that is tolerated around
+      it before changing the scale.
+
+      With a headroom of 0.1 and a target of 16ms, the scale goes down above
+      17.6ms and goes up below 14.4ms.
+     */
+    void setHeadroom(float headroom);
+
+    /*!
+      \brief Feed a measured GPU frame time and compute the next scale.
+
+      Negative times (no measurement available) leave the scale untouched.
+
+      \return The new scale.
+     */
+    float update(float gpu_milliseconds);
+
+    //! Get the current resolution scale.
+    float scale() const;
+
+    //! Get the smoothed GPU frame time the controller is working with.
+    float smoothedFrameTime() const;
+
+private:
+    float _target, _min_scale, _max_scale, _headroom;
+    float _scale, _smoothed;
+};
+
+/*!
+  \class rendering::DynamicResolution
+  \brief Controller that picks the render resolution scale from the measured
+  GPU frame time.
+
+  The cost of a frame is assumed to be proportional to the number of pixels, so
+  when the smoothed frame time is over budget the scale is multiplied by
+  `sqrt(target / time)`. Scaling up is done in small steps to avoid oscillating
+  between two resolutions.
+
+  It is used by rendering::Plugin (see rendering::Plugin::setDynamicResolution()).
+*/
+}
+#endif /* RENDERING_DYNAMIC_RESOLUTION_HPP */
@@ -0,0 +1,54 @@
+#ifndef RENDERING_EMBEDDED_SHADERS_HPP
+#define RENDERING_EMBEDDED_SHADERS_HPP
+
+#include <string_view>
+
+namespace rendering
+{
+namespace embedded_shaders
+{
+//! A file of shaders/ compiled into the engine.
+struct Entry
+{
+    //! Path of the file, as loaded (e.g. "shaders/plain.vert").
+    std::string_view name;
+    std::string_view source;
+};
+
+#if __has_include("EmbeddedShaderData.inc")
+//! Whether the build generated the table (see `make`), without it every source is read from disk.
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+//! Every embedded file, followed by an entry with an empty name.
+constexpr Entry ENTRIES[] = {
+#if __has_include("EmbeddedShaderData.inc")
+#include "EmbeddedShaderData.inc"
+#endif
+    { std::string_view(), std::string_view() }
+};
+
+/*!
+  \brief Find the embedded source of <name>.
+
+  Can be evaluated at compile time, e.g. in a `static_assert` or to
+  initialize a `constexpr std::string_view`.
+
+  \return The source, or a view with a null data() if <name> is not embedded.
+ */
+constexpr std::string_view find(std::string_view name)
+{
+    for (const Entry& entry : ENTRIES)
+    {
+        if (!entry.name.empty() && entry.name == name)
+        {
+            return entry.source;
+        }
+    }
+    return std::string_view();
+}
+}
+}
+#endif /* RENDERING_EMBEDDED_SHADERS_HPP */
@@ -0,0 +1,91 @@
+#ifndef RENDERING_FONT_HPP
+#define RENDERING_FONT_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#include <SDL2/SDL_ttf.h>
+
+namespace rendering
+{
+class Font
+{
+public:
+    //! Size, in pixels, at which glyphs are rasterized before computing their distance field.
+    static const int BASE_SIZE = 48;
+
+    //! Distance, in pixels of BASE_SIZE, covered by the distance field around the outline.
+    static const int SPREAD = 6;
+
+    //! Width and height of an atlas page.
+    static const int PAGE_SIZE = 512;
+
+    //! Placement of a glyph in the atlas. Metrics are in em (1 = the font size).
+    struct Glyph
+    {
+        unsigned int page;
+        float u0, v0, u1, v1;
+        float x, y, width, height;
+        float advance;
+    };
+
+    //! Class constructor
+    Font();
+
+    //! Class destructor
+    ~Font();
+
+    /*!
+      \brief Load a TrueType font from the file <filename>.
+
+      The file is looked up in the mounted Archive%s first. A font read from
+      an Archive needs it mounted while glyphs are generated.
+
+      \return Whether the font could be opened.
+     */
+    bool loadFromFile(const std::string& filename);
+
+    /*!
+      \brief Get the Glyph for the code point <code_point>, generating it if needed.
+
+      Generating glyphs needs an active OpenGL context.
+     */
+    const Glyph& glyph(unsigned int code_point);
+
+    //! Get the distance between two baselines, in em.
+    float lineHeight() const;
+
+    //! Get the native handler of the texture of the atlas page <page>.
+    GLuint pageTexture(unsigned int page) const;
+
+    //! Get the number of atlas pages.
+    unsigned int pageCount() const;
+
+private:
+    Font(const Font&) =delete;
+    Font& operator=(const Font&) =delete;
+
+    void addPage();
+
+    TTF_Font* _font;
+    std::unordered_map<unsigned int, Glyph> _glyphs;
+    std::vector<GLuint> _pages;
+    // Shelf packer state of the last page
+    int _shelf_x, _shelf_y, _shelf_height;
+    float _line_height;
+};
+
+/*!
+  \class rendering::Font
+  \brief A TrueType font rendered as signed distance field glyphs.
+
+  Glyphs are rasterized once at BASE_SIZE the first time they are used, turned
+  into a signed distance field and packed in `GL_R8` atlas pages of
+  PAGE_SIZE x PAGE_SIZE. As the distance field can be sampled at any scale, one
+  atlas serves every text size.
+
+  Used by rendering::Text.
+*/
+}
+#endif /* RENDERING_FONT_HPP */
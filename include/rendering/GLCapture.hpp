@@ -0,0 +1,70 @@
+#ifndef RENDERING_GL_CAPTURE_HPP
+#define RENDERING_GL_CAPTURE_HPP
+
+#include <string>
+
+namespace rendering
+{
+class GLCapture
+{
+public:
+    /*!
+      \brief Record the OpenGL calls of frames [<first_frame>, <first_frame> + <frame_count>) to <filename>.
+
+      Must be called before the game starts: the calls that create the
+      objects used by the captured frames are recorded from the first frame
+      on. Frames count from the first one drawn by rendering::Plugin. Returns
+      false, and logs why, when the file can't be opened, the game already
+      started or the build doesn't support capture (see the class
+      documentation).
+     */
+    static bool start(const std::string& filename, unsigned int first_frame, unsigned int frame_count);
+
+    //! Stop recording and close the trace. Called by itself after the last frame and at exit.
+    static void stop();
+
+    //! Get whether calls are being recorded.
+    static bool isCapturing();
+
+    //! Hook the OpenGL functions if a capture was started. (Internal use only). Called once GLEW is initialized.
+    static void install();
+
+    //! Mark the end of a frame drawn to a <width>x<height> window. (Internal use only).
+    static void endFrame(int width, int height);
+
+private:
+    GLCapture() =delete;
+};
+
+/*!
+  \class rendering::GLCapture
+  \brief Records the OpenGL calls of rendering into a trace for tools/glreplay.
+
+  Only available when built with `make GLCAPTURE=1` (which defines
+  RENDERING_GL_CAPTURE), otherwise start() fails and nothing is hooked.
+
+  The functions GLEW loads are hooked by swapping its function pointers; the
+  OpenGL 1.1 ones that are linked directly (glDrawArrays, glClear,
+  glTexImage2D...) are interposed, which needs a platform where
+  `dlsym(RTLD_NEXT)` finds the system ones (Linux, macOS). Buffer and texture
+  uploads, shader sources and uniforms are stored with the calls, so the
+  trace replays without the assets. Queries (glGet*, timer queries) are not
+  recorded, nor is the OpenGL 4.3 work of the GPU-driven path (see
+  Plugin::setGpuDriven()): capture with it disabled.
+
+  The frames before <first_frame> are recorded without their draws and
+  clears: they only rebuild the objects the timed frames use.
+
+  \code
+  rendering::GLCapture::start("frames.gltrace", 300, 60);
+  game.run();
+  \endcode
+
+  Then replay it anywhere, even without a GPU:
+
+  \code
+  LIBGL_ALWAYS_SOFTWARE=1 tools/glreplay frames.gltrace
+  \endcode
+*/
+}
+#endif /* RENDERING_GL_CAPTURE_HPP */
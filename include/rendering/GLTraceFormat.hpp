@@ -0,0 +1,225 @@
+#ifndef RENDERING_GL_TRACE_FORMAT_HPP
+#define RENDERING_GL_TRACE_FORMAT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <GL/glew.h>
+
+namespace rendering
+{
+namespace gl_trace_format
+{
+//! "GLTR" in little endian.
+const std::uint32_t MAGIC = 0x52544C47;
+const std::uint32_t VERSION = 2;
+
+//! First bytes of a trace. All the values are little endian.
+struct Header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    //! Index of the first frame that is timed. The frames before only set up the objects.
+    std::uint32_t first_frame;
+    //! Number of frames, set up and timed ones, in the trace.
+    std::uint32_t frame_count;
+};
+
+//! Header of every recorded call, followed by <size> bytes of arguments.
+struct Record
+{
+    std::uint16_t op;
+    std::uint16_t padding;
+    std::uint32_t size;
+};
+
+/*!
+  \brief Recorded calls.
+
+  The arguments are 32 bit words in the order of the OpenGL function, with
+  the 64 bit sizes and offsets as two words (low first). Data pointed to is
+  stored as a blob: a word with its size in bytes, the bytes and padding up
+  to a multiple of 4. A blob of size 0 stands for a null pointer. Object
+  names are the ones of the captured run, the replay maps them to its own.
+ */
+enum class Op : std::uint16_t
+{
+    //! Window width, height. Ends a frame.
+    FRAME_END,
+
+    GEN_BUFFERS,            // n, names[n]
+    DELETE_BUFFERS,         // n, names[n]
+    BIND_BUFFER,            // target, buffer
+    BIND_BUFFER_BASE,       // target, index, buffer
+    BUFFER_DATA,            // target, size (64), usage, blob
+    BUFFER_SUB_DATA,        // target, offset (64), size (64), blob
+    //! glMapBufferRange() followed by writes and glUnmapBuffer(). target, offset (64), length (64), access, blob
+    MAP_WRITE,
+
+    GEN_VERTEX_ARRAYS,      // n, names[n]
+    DELETE_VERTEX_ARRAYS,   // n, names[n]
+    BIND_VERTEX_ARRAY,      // array
+    ENABLE_VERTEX_ATTRIB_ARRAY, // index
+    VERTEX_ATTRIB_POINTER,  // index, size, type, normalized, stride, offset (64)
+    VERTEX_ATTRIB_I_POINTER, // index, size, type, stride, offset (64)
+    VERTEX_ATTRIB_DIVISOR,  // index, divisor
+
+    GEN_TEXTURES,           // n, names[n]
+    DELETE_TEXTURES,        // n, names[n]
+    BIND_TEXTURE,           // target, texture
+    ACTIVE_TEXTURE,         // texture
+    TEX_PARAMETER_I,        // target, name, param
+    TEX_IMAGE_2D,           // target, level, internal format, width, height, border, format, type, blob
+    TEX_SUB_IMAGE_2D,       // target, level, x, y, width, height, format, type, blob
+    PIXEL_STORE_I,          // name, param
+
+    GEN_FRAMEBUFFERS,       // n, names[n]
+    DELETE_FRAMEBUFFERS,    // n, names[n]
+    BIND_FRAMEBUFFER,       // target, framebuffer
+    FRAMEBUFFER_TEXTURE_2D, // target, attachment, texture target, texture, level
+    FRAMEBUFFER_RENDERBUFFER, // target, attachment, renderbuffer target, renderbuffer
+    DRAW_BUFFER,            // buffer
+    DRAW_BUFFERS,           // n, buffers[n]
+    BLIT_FRAMEBUFFER,       // src x0, y0, x1, y1, dst x0, y0, x1, y1, mask, filter
+
+    GEN_RENDERBUFFERS,      // n, names[n]
+    DELETE_RENDERBUFFERS,   // n, names[n]
+    BIND_RENDERBUFFER,      // target, renderbuffer
+    RENDERBUFFER_STORAGE,   // target, internal format, width, height
+
+    CREATE_SHADER,          // type, shader
+    DELETE_SHADER,          // shader
+    SHADER_SOURCE,          // shader, blob with the strings one after the other
+    COMPILE_SHADER,         // shader
+    CREATE_PROGRAM,         // program
+    DELETE_PROGRAM,         // program
+    ATTACH_SHADER,          // program, shader
+    BIND_ATTRIB_LOCATION,   // program, index, blob with the name
+    LINK_PROGRAM,           // program
+    USE_PROGRAM,            // program
+    //! Lookups, replayed to map the captured locations. program, location, blob with the name
+    GET_UNIFORM_LOCATION,
+    GET_ATTRIB_LOCATION,
+    GET_UNIFORM_BLOCK_INDEX,
+    UNIFORM_BLOCK_BINDING,  // program, block index, binding
+
+    UNIFORM_1I,             // location, v0
+    UNIFORM_1F,             // location, v0
+    UNIFORM_2F,             // location, v0, v1
+    UNIFORM_3F,             // location, v0, v1, v2
+    UNIFORM_4F,             // location, v0, v1, v2, v3
+    UNIFORM_MATRIX_4FV,     // location, count, transpose, blob
+
+    ENABLE,                 // capability
+    DISABLE,                // capability
+    BLEND_FUNC,             // source factor, destination factor
+    DEPTH_MASK,             // flag
+    VIEWPORT,               // x, y, width, height
+    SCISSOR,                // x, y, width, height
+    CLEAR_COLOR,            // red, green, blue, alpha
+    CLEAR,                  // mask
+
+    DRAW_ARRAYS,            // mode, first, count
+    DRAW_ARRAYS_INSTANCED,  // mode, first, count, instance count
+    DRAW_ELEMENTS,          // mode, count, type, offset (64)
+
+    COUNT
+};
+
+//! Name of the OpenGL function of <op>, for reports.
+inline const char* opName(Op op)
+{
+    static const char* const names[] = {
+        "<frame end>",
+        "glGenBuffers", "glDeleteBuffers", "glBindBuffer", "glBindBufferBase", "glBufferData",
+        "glBufferSubData", "glMapBufferRange+write",
+        "glGenVertexArrays", "glDeleteVertexArrays", "glBindVertexArray", "glEnableVertexAttribArray",
+        "glVertexAttribPointer", "glVertexAttribIPointer", "glVertexAttribDivisor",
+        "glGenTextures", "glDeleteTextures", "glBindTexture", "glActiveTexture", "glTexParameteri",
+        "glTexImage2D", "glTexSubImage2D", "glPixelStorei",
+        "glGenFramebuffers", "glDeleteFramebuffers", "glBindFramebuffer", "glFramebufferTexture2D",
+        "glFramebufferRenderbuffer", "glDrawBuffer", "glDrawBuffers", "glBlitFramebuffer",
+        "glGenRenderbuffers", "glDeleteRenderbuffers", "glBindRenderbuffer", "glRenderbufferStorage",
+        "glCreateShader", "glDeleteShader", "glShaderSource", "glCompileShader", "glCreateProgram",
+        "glDeleteProgram", "glAttachShader", "glBindAttribLocation", "glLinkProgram", "glUseProgram",
+        "glGetUniformLocation", "glGetAttribLocation", "glGetUniformBlockIndex", "glUniformBlockBinding",
+        "glUniform1i", "glUniform1f", "glUniform2f", "glUniform3f", "glUniform4f", "glUniformMatrix4fv",
+        "glEnable", "glDisable", "glBlendFunc", "glDepthMask", "glViewport", "glScissor",
+        "glClearColor", "glClear",
+        "glDrawArrays", "glDrawArraysInstanced", "glDrawElements"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<std::size_t>(Op::COUNT),
+            "A name for every Op");
+    return op < Op::COUNT ? names[static_cast<std::size_t>(op)] : "<unknown>";
+}
+
+//! Whether <op> draws or clears: left out of the frames before first_frame.
+inline bool isDraw(Op op)
+{
+    return op == Op::DRAW_ARRAYS || op == Op::DRAW_ARRAYS_INSTANCED || op == Op::DRAW_ELEMENTS
+            || op == Op::CLEAR || op == Op::BLIT_FRAMEBUFFER;
+}
+
+//! Bytes glTexImage2D() and glTexSubImage2D() read from their pixels, stored in their blob.
+inline std::size_t imageSize(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint unpack_alignment)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return 0;
+    }
+    std::size_t components;
+    switch (format)
+    {
+        case GL_RG:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+            components = 3;
+            break;
+        case GL_RGBA:
+        case GL_BGRA:
+            components = 4;
+            break;
+        default:
+            components = 1;
+    }
+    std::size_t pixel;
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            pixel = components;
+            break;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            pixel = 2 * components;
+            break;
+        case GL_UNSIGNED_INT:
+        case GL_INT:
+        case GL_FLOAT:
+            pixel = 4 * components;
+            break;
+        case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+            pixel = 8;
+            break;
+        default:
+            // Packed types hold the whole pixel
+            pixel = 4;
+    }
+    std::size_t alignment = std::max<GLint>(unpack_alignment, 1);
+    std::size_t row = (width * pixel + alignment - 1) / alignment * alignment;
+    return row * height;
+}
+}
+/*!
+  \namespace rendering::gl_trace_format
+  \brief Layout of the OpenGL traces written by rendering::GLCapture and replayed by tools/glreplay.
+
+  A trace is a Header and the Record%s of every call, in order. The frames
+  before Header::first_frame hold the calls that create and fill the objects
+  the timed frames use, without their draws.
+*/
+}
+#endif /* RENDERING_GL_TRACE_FORMAT_HPP */
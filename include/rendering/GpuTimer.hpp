@@ -0,0 +1,55 @@
+#ifndef RENDERING_GPU_TIMER_HPP
+#define RENDERING_GPU_TIMER_HPP
+
+#include <GL/glew.h>
+
+namespace rendering
+{
+class GpuTimer
+{
+public:
+    //! Class constructor
+    GpuTimer();
+
+    //! Class destructor
+    ~GpuTimer();
+
+    /*!
+      \brief Start measuring the GPU time of the commands issued from now on.
+
+      Must be paired with end(). This method must be called with an active
+      OpenGL context.
+     */
+    void begin();
+
+    //! Stop measuring. See begin().
+    void end();
+
+    /*!
+      \brief Take the GPU time in milliseconds measured since the last call.
+
+      Results are read back a few frames late so that the CPU never waits for
+      the GPU. Returns a negative value when no new result arrived since the
+      last call or when timer queries are not supported.
+     */
+    float milliseconds();
+
+private:
+    GpuTimer(const GpuTimer&) =delete;
+    GpuTimer& operator=(const GpuTimer&) =delete;
+
+    static const unsigned int QUERY_COUNT = 4;
+
+    GLuint _queries[QUERY_COUNT];
+    bool _pending[QUERY_COUNT];
+    unsigned int _current;
+    bool _supported, _initialized, _running;
+    float _milliseconds;
+};
+
+/*!
+  \class rendering::GpuTimer
+  \brief Measures GPU time using a ring of `GL_TIME_ELAPSED` queries.
+*/
+}
+#endif /* RENDERING_GPU_TIMER_HPP */
@@ -0,0 +1,60 @@
+#ifndef RENDERING_IMPOSTOR_BATCH_HPP
+#define RENDERING_IMPOSTOR_BATCH_HPP
+
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+#include "common.hpp"
+#include "glm.hpp"
+#include "Batch.hpp"
+#include "ShaderProgram.hpp"
+
+namespace rendering
+{
+class Plugin;
+
+class ImpostorBatch : public Batch
+{
+public:
+    /*!
+      \brief Class constructor. Needs an active OpenGL context.
+     */
+    ImpostorBatch(Plugin* plugin);
+
+    //! Class destructor
+    ~ImpostorBatch();
+
+    /*!
+      \brief Add a camera facing disc of <radius> at <center>, in world space.
+
+      <right> and <up> are the unit axes of the camera in world space.
+     */
+    void add(const glm::vec3& center, float radius, const glm::vec3& right, const glm::vec3& up, const Color& color);
+
+    void flush() override;
+
+private:
+    struct Vertex_t {
+        float x, y, z;
+        float u, v;
+        unsigned char r, g, b, a;
+    };
+
+    ImpostorBatch(const ImpostorBatch&) =delete;
+    ImpostorBatch& operator=(const ImpostorBatch&) =delete;
+
+    Plugin* _plugin;
+    ShaderProgram* _shader_program;
+    GLuint _VAO, _VBO;
+    std::size_t _capacity;
+    std::vector<Vertex_t> _vertices;
+};
+
+/*!
+  \class rendering::ImpostorBatch
+  \brief Batch of the impostors of far away Drawable%s (see Drawable::setImpostor()).
+
+  Owned by rendering::Plugin, which fills it while drawing a View.
+*/
+}
+#endif /* RENDERING_IMPOSTOR_BATCH_HPP */
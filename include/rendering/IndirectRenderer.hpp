@@ -0,0 +1,108 @@
+#ifndef RENDERING_INDIRECT_RENDERER_HPP
+#define RENDERING_INDIRECT_RENDERER_HPP
+
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+#include "glm.hpp"
+#include "Camera.hpp"
+#include "ShaderProgram.hpp"
+
+namespace rendering
+{
+class IndirectRenderer
+{
+public:
+    //! Get whether the OpenGL context has what the IndirectRenderer needs (OpenGL 4.3).
+    static bool isSupported();
+
+    /*!
+      \brief Class constructor. Needs an active OpenGL 4.3 context.
+     */
+    IndirectRenderer();
+
+    //! Class destructor
+    ~IndirectRenderer();
+
+    //! Get a free instance slot. It draws nothing until set().
+    unsigned int acquire();
+
+    //! Stop drawing the instance in <slot> and free it.
+    void release(unsigned int slot);
+
+    //! Draw the unit quad in <slot> with the <model> matrix and the Material index <material>.
+    void set(unsigned int slot, const glm::mat4& model, unsigned int material);
+
+    //! Get the Material index of the instance in <slot>.
+    unsigned int material(unsigned int slot) const;
+
+    //! Get the number of instances being drawn.
+    std::size_t size() const;
+
+    /*!
+      \brief Upload the instances set since the last call.
+
+      Called by rendering::Plugin once per frame, before drawing.
+     */
+    void upload();
+
+    /*!
+      \brief Cull the instances against the frustum of <camera> and draw the visible ones.
+
+      The culling runs in a compute shader and everything is drawn with one
+      multi-draw indirect call, the CPU cost doesn't depend on the number of
+      instances.
+     */
+    void draw(Camera& camera);
+
+private:
+    // std430 layout of an element of the `instances` array
+    struct Instance_t {
+        glm::mat4 model;
+        GLuint material;
+        GLuint enabled;
+        GLuint padding[2];
+    };
+
+    // Layout fixed by glMultiDrawArraysIndirect
+    struct DrawArraysIndirectCommand_t {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first;
+        GLuint base_instance;
+    };
+
+    IndirectRenderer(const IndirectRenderer&) =delete;
+    IndirectRenderer& operator=(const IndirectRenderer&) =delete;
+
+    void markDirty(std::size_t slot);
+    void reserve(std::size_t capacity);
+
+    ShaderProgram* _cull_program;
+    ShaderProgram* _draw_program;
+    GLuint _VAO, _quad_VBO, _index_VBO;
+    GLuint _instance_SSBO, _command_buffer;
+    std::size_t _capacity;
+    std::vector<Instance_t> _instances;
+    std::vector<unsigned int> _free_slots;
+    std::size_t _dirty_begin, _dirty_end;
+};
+
+/*!
+  \class rendering::IndirectRenderer
+  \brief GPU-driven drawing of the Rectangle%s with the default shading (see Plugin::setGpuDriven()).
+
+  Every instance keeps its model matrix and Material index in a shader
+  storage buffer that lives as long as the IndirectRenderer and is only
+  written where instances changed. Each frame a compute shader tests their
+  bounding spheres against the frustum and writes one
+  `DrawArraysIndirectCommand` per instance, empty for the culled ones, and
+  `glMultiDrawArraysIndirect` draws all of them. The base instance of each
+  command selects the instance through an instanced vertex attribute, which
+  keeps it within OpenGL 4.3 (`gl_BaseInstance` needs 4.6).
+
+  The instances are drawn before the other Drawable%s and unsorted: meant
+  for opaque Material%s.
+*/
+}
+#endif /* RENDERING_INDIRECT_RENDERER_HPP */
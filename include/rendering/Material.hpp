@@ -0,0 +1,130 @@
+#ifndef RENDERING_MATERIAL_HPP
+#define RENDERING_MATERIAL_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#include "common.hpp"
+#include "glm.hpp"
+#include "ShaderProgram.hpp"
+
+namespace rendering
+{
+class Material
+{
+public:
+    //! Maximum number of Material%s alive at once.
+    static const unsigned int MAX_MATERIALS = 256;
+
+    //! Uniform buffer binding point of the material table.
+    static const GLuint BINDING = 0;
+
+    //! Class constructor with the base color.
+    Material(const Color& color = Color(255, 255, 255));
+
+    //! Class destructor. Frees the slot of the Material.
+    ~Material();
+
+    /*!
+      \brief Get the Material shared by everything filled with the plain <color>.
+
+      Created on first use and destroyed with its last user. The Color
+      constructors and setColor() of Rectangle and Mesh use it, so any number
+      of them only take one slot of the table per distinct color. Its color
+      must not be changed.
+     */
+    static std::shared_ptr<Material> shared(const Color& color);
+
+    //! Set the base color.
+    void setColor(const Color& color);
+
+    //! Get the base color.
+    const Color& getColor() const;
+
+    //! Set four free parameters, for shaders that need more than a color.
+    void setParameters(const glm::vec4& parameters);
+
+    //! Get the free parameters.
+    const glm::vec4& getParameters() const;
+
+    /*!
+      \brief Get the index of the Material in the `materials` array of the shaders.
+
+      Constant for the whole life of the Material.
+     */
+    unsigned int index() const;
+
+    /*!
+      \brief Upload the Material%s changed since the last call and bind the table. (Internal use only).
+
+      Called by rendering::Plugin once per frame, before drawing.
+     */
+    static void upload();
+
+    /*!
+      \brief Connect the `Materials` block of <shader_program> to the material table.
+
+      To be called once after linking a ShaderProgram that uses materials.
+     */
+    static void bindTable(ShaderProgram* shader_program);
+
+private:
+    // std140 layout of an element of the `materials` array
+    struct Entry_t {
+        glm::vec4 color;
+        glm::vec4 parameters;
+    };
+
+    Material(const Material&) =delete;
+    Material& operator=(const Material&) =delete;
+
+    void markDirty();
+
+    static std::vector<Entry_t> _entries;
+    static std::vector<unsigned int> _free_slots;
+    static unsigned int _dirty_begin, _dirty_end;
+    static GLuint _UBO;
+    // Shared Materials by packed RGBA color
+    static std::unordered_map<std::uint32_t, std::weak_ptr<Material>> _shared;
+
+    unsigned int _index;
+    Color _color;
+    glm::vec4 _parameters;
+};
+
+/*!
+  \class rendering::Material
+  \brief Shading parameters stored once on the GPU and shared by every Drawable using them.
+
+  All the Material%s live in one uniform buffer, the material table. A
+  Material only uploads its entry when one of its parameters changes, so
+  drawing with it costs a single `int` uniform (or vertex attribute, for
+  instanced and batched draws) with its index().
+
+  Shaders declare the table as:
+  \code
+  struct Material
+  {
+      vec4 color;
+      vec4 parameters;
+  };
+  layout(std140) uniform Materials
+  {
+      Material materials[256];
+  };
+  uniform int material_index;
+  \endcode
+
+  \code
+  rendering::Material red(rendering::Color(255, 0, 0));
+  // All these rectangles share the same GPU data
+  for (hum::Actor* actor : actors)
+  {
+      actor->addBehavior<rendering::Rectangle>(&red);
+  }
+  \endcode
+*/
+}
+#endif /* RENDERING_MATERIAL_HPP */
@@ -0,0 +1,81 @@
+#ifndef RENDERING_MESH_HPP
+#define RENDERING_MESH_HPP
+
+#include <memory>
+#include "common.hpp"
+#include "Drawable.hpp"
+#include "Material.hpp"
+#include "MeshData.hpp"
+#include "ShaderPermutations.hpp"
+
+namespace rendering
+{
+class Mesh : public Drawable
+{
+public:
+    /*!
+      \brief Class constructor with the geometry and a fill color.
+
+      The Mesh doesn't handle the given pointer and the MeshData must exist
+      while the Mesh is using it. The Mesh uses the Material shared by every
+      user of the color (see Material::shared()).
+     */
+    Mesh(MeshData* data, const Color& color);
+
+    /*!
+      \brief Class constructor with the geometry and a shared Material.
+
+      Neither pointer is handled by the Mesh, both must exist while the Mesh
+      is using them.
+     */
+    Mesh(MeshData* data, Material* material);
+
+    //! Class destructor
+    ~Mesh();
+
+    void init() override;
+    void onDestroy() override;
+
+    void setShaderProgram(ShaderProgram* shader_program) override;
+
+    //! Set fill color for the Mesh. Switches to the Material shared by every user of the color.
+    void setColor(const Color& color);
+
+    //! Get fill color for the Mesh
+    const Color& getColor() const;
+
+    //! Use the shared Material <material>.
+    void setMaterial(Material* material);
+
+    //! Get the Material of the Mesh.
+    Material* getMaterial() const;
+
+    //! Get the geometry of the Mesh.
+    MeshData* getData() const;
+
+    //! Draw the Mesh with one indexed draw call.
+    void draw() override;
+
+    static const char* behaviorName();
+
+private:
+    static ShaderPermutations* _permutations;
+    MeshData* _data;
+    GLuint _VAO;
+    bool _has_normal;
+    // Shared Material of the fill color, empty when using one given by the user
+    std::shared_ptr<Material> _color_material;
+    Material* _material;
+};
+
+/*!
+  \class rendering::Mesh
+  \brief A Drawable for indexed geometry loaded in a MeshData.
+
+  Every attribute of the MeshData's VertexLayout is bound to the shader input
+  of the same name, if the shader uses it. The default shader uses `position`
+  and, when present, `normal` (its HAS_NORMAL variant, see ShaderPermutations). Its bounds (see Drawable::setBounds()) are set
+  from the MeshData, so it is ready for Drawable::addLevelOfDetail().
+*/
+}
+#endif /* RENDERING_MESH_HPP */
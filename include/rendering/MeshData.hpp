@@ -0,0 +1,134 @@
+#ifndef RENDERING_MESH_DATA_HPP
+#define RENDERING_MESH_DATA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+namespace rendering
+{
+//! One input of the vertex shader, interleaved in a vertex.
+struct VertexAttribute
+{
+    std::string name;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    unsigned int offset;
+};
+
+//! Interleaved layout of the vertices of a MeshData.
+struct VertexLayout
+{
+    std::vector<VertexAttribute> attributes;
+    unsigned int stride;
+};
+
+class MeshData
+{
+public:
+    //! Class constructor
+    MeshData();
+
+    //! Class destructor
+    ~MeshData();
+
+    /*!
+      \brief Map the binary mesh file <filename> (see mesh_format).
+
+      The file is looked up in the mounted Archive%s first. Only its header
+      and attributes are validated here: the indices are trusted to be below
+      the vertex count, as tools/meshconv checks when writing them. Its data
+      is uploaded by upload(), straight from the mapping, and then unmapped.
+
+      \return Whether the file could be mapped and is a valid mesh.
+     */
+    bool loadFromFile(const std::string& filename);
+
+    /*!
+      \brief Use the mesh file already in memory at <data>.
+
+      Nothing is copied: <data> must stay valid until upload().
+
+      \return Whether <data> is a valid mesh.
+     */
+    bool loadFromBuffer(const void* data, std::size_t size);
+
+    /*!
+      \brief Set the geometry from memory, for procedural meshes.
+
+      <vertices> holds <vertex_count> vertices laid out as <layout>. The data
+      is copied until upload().
+     */
+    void loadFromMemory(const VertexLayout& layout, const void* vertices, std::size_t vertex_count,
+            const std::vector<std::uint32_t>& indices);
+
+    /*!
+      \brief Create the OpenGL buffers, if not created yet.
+
+      Needs an active OpenGL context. Called by Mesh::init().
+     */
+    void upload();
+
+    //! Get the layout of the vertices.
+    const VertexLayout& layout() const;
+
+    //! Get the native handler of the vertex buffer. 0 until upload().
+    GLuint vertexBuffer() const;
+
+    //! Get the native handler of the index buffer. 0 until upload().
+    GLuint indexBuffer() const;
+
+    //! Get the number of indices.
+    std::size_t indexCount() const;
+
+    //! Get the type of the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+    GLenum indexType() const;
+
+    //! Get the minimum corner of the bounding box.
+    const float* boundsMin() const;
+
+    //! Get the maximum corner of the bounding box.
+    const float* boundsMax() const;
+
+private:
+    MeshData(const MeshData&) =delete;
+    MeshData& operator=(const MeshData&) =delete;
+
+    bool parse(const void* data, std::size_t size);
+    void unmap();
+
+    VertexLayout _layout;
+    GLuint _VBO, _EBO;
+    std::size_t _vertex_count, _index_count;
+    GLenum _index_type;
+    float _bounds_min[3], _bounds_max[3];
+
+    // Pending data, either mapped from a file or copied from memory
+    void* _mapping;
+    std::size_t _mapping_size;
+    const void* _vertex_data;
+    const void* _index_data;
+    std::vector<unsigned char> _vertex_copy;
+    std::vector<std::uint32_t> _index_copy;
+};
+
+/*!
+  \class rendering::MeshData
+  \brief Indexed geometry shared by any number of Mesh%es.
+
+  Meshes are usually converted offline with tools/meshconv, which writes them
+  already optimized for the post-transform vertex cache and for vertex fetch.
+  Those files are memory-mapped and handed to OpenGL as they are: there is no
+  parsing nor intermediate copy.
+
+  \code
+  rendering::MeshData ship;
+  ship.loadFromFile("meshes/ship.mesh");
+  actor->addBehavior<rendering::Mesh>(&ship, rendering::Color(200, 200, 255));
+  \endcode
+*/
+}
+#endif /* RENDERING_MESH_DATA_HPP */
@@ -0,0 +1,64 @@
+#ifndef RENDERING_MESH_FORMAT_HPP
+#define RENDERING_MESH_FORMAT_HPP
+
+#include <cstdint>
+
+namespace rendering
+{
+namespace mesh_format
+{
+//! "RMSH" in little endian.
+const std::uint32_t MAGIC = 0x48534D52;
+const std::uint32_t VERSION = 1;
+
+//! Alignment, in bytes, of the vertex and index data in the file.
+const std::uint32_t DATA_ALIGNMENT = 16;
+
+//! Component types, with the values of their OpenGL enums.
+const std::uint32_t TYPE_UNSIGNED_BYTE = 0x1401;
+const std::uint32_t TYPE_UNSIGNED_SHORT = 0x1403;
+const std::uint32_t TYPE_UNSIGNED_INT = 0x1405;
+const std::uint32_t TYPE_FLOAT = 0x1406;
+
+const std::uint32_t MAX_ATTRIBUTE_NAME = 24;
+
+//! First bytes of a mesh file. All the values are little endian.
+struct Header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t attribute_count;
+    std::uint32_t vertex_stride;
+    std::uint32_t vertex_count;
+    std::uint32_t index_count;
+    //! TYPE_UNSIGNED_SHORT or TYPE_UNSIGNED_INT.
+    std::uint32_t index_type;
+    //! Offsets, from the start of the file, of the vertex and index data.
+    std::uint32_t vertex_offset;
+    std::uint32_t index_offset;
+    float bounds_min[3];
+    float bounds_max[3];
+};
+
+//! One per vertex attribute, right after the Header.
+struct Attribute
+{
+    //! Name of the shader input, null terminated.
+    char name[MAX_ATTRIBUTE_NAME];
+    std::uint32_t size;
+    std::uint32_t type;
+    std::uint32_t normalized;
+    std::uint32_t offset;
+};
+}
+/*!
+  \namespace rendering::mesh_format
+  \brief Layout of the binary mesh files written by tools/meshconv.
+
+  A file is a Header, Header::attribute_count Attribute%s, and then the
+  interleaved vertices and the indices, each aligned to DATA_ALIGNMENT. The
+  data is stored exactly as OpenGL consumes it, so rendering::MeshData can
+  upload it straight from the mapped file.
+*/
+}
+#endif /* RENDERING_MESH_FORMAT_HPP */
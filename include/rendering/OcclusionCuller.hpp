@@ -0,0 +1,105 @@
+#ifndef RENDERING_OCCLUSION_CULLER_HPP
+#define RENDERING_OCCLUSION_CULLER_HPP
+
+#include <vector>
+#include "glm.hpp"
+
+namespace rendering
+{
+class OcclusionCuller
+{
+public:
+    /*!
+      \brief Default constructor.
+
+      Constructs the culler with the following default values:
+      \code
+      rendering::OcclusionCuller culler;
+      culler.setResolution(128, 72);
+      culler.setMaxOccluders(64);
+      \endcode
+     */
+    OcclusionCuller();
+
+    /*!
+      \brief Set the size, in texels, of the depth buffer the occluders are drawn to.
+
+      Bigger finds more occluded objects at a higher CPU cost. Clamped to at
+      least 1x1.
+     */
+    void setResolution(unsigned int width, unsigned int height);
+
+    //! Get the width of the depth buffer.
+    unsigned int getWidth() const;
+
+    //! Get the height of the depth buffer.
+    unsigned int getHeight() const;
+
+    //! Set how many occluders, the biggest on screen, are drawn each View.
+    void setMaxOccluders(unsigned int max_occluders);
+
+    //! Get how many occluders are drawn each View.
+    unsigned int getMaxOccluders() const;
+
+    //! Start a View seen through <view_projection>. Forgets the occluders of the last one.
+    void begin(const glm::mat4& view_projection);
+
+    //! Add the opaque unit quad [0, 1]x[0, 1] transformed by <model> as an occluder candidate. Ignored if it crosses the near plane.
+    void addOccluder(const glm::mat4& model);
+
+    //! Draw the biggest occluder candidates and build the depth pyramid.
+    void build();
+
+    //! Get whether the unit quad transformed by <model> is hidden behind the occluders.
+    bool isQuadOccluded(const glm::mat4& model) const;
+
+    //! Get whether the sphere of <radius> at <center>, in world space, is hidden behind the occluders.
+    bool isSphereOccluded(const glm::vec3& center, float radius) const;
+
+    //! Get the number of occluders drawn by the last build().
+    unsigned int occluderCount() const;
+
+private:
+    struct Occluder_t {
+        glm::vec2 corners[4];
+        float depth;
+        float area;
+    };
+
+    // Screen rectangle in texels of level 0 and the nearest depth of a projected shape
+    struct Rect_t {
+        float x0, y0, x1, y1;
+        float depth;
+    };
+
+    bool project(const glm::vec3& point, glm::vec3& screen) const;
+    bool projectPoints(const glm::vec3* points, unsigned int count, Rect_t& rect) const;
+    bool isRectOccluded(const Rect_t& rect) const;
+    void rasterize(const Occluder_t& occluder);
+
+    unsigned int _width, _height;
+    unsigned int _max_occluders;
+    unsigned int _occluder_count;
+    glm::mat4 _view_projection;
+    std::vector<Occluder_t> _candidates;
+    // Farthest depth of every texel, level 0 first, then every half size level
+    std::vector<std::vector<float>> _levels;
+    std::vector<unsigned int> _level_widths, _level_heights;
+};
+
+/*!
+  \class rendering::OcclusionCuller
+  \brief Hierarchical depth test of Drawable%s against the biggest opaque ones in front of them.
+
+  The occluders are drawn on the CPU into a small depth buffer: a texel only
+  gets the farthest depth of an occluder when the occluder covers all of it,
+  so the buffer never hides more than the real one would. From it a pyramid
+  of half size levels keeps the farthest depth of the texels below. An
+  object is hidden when its nearest depth is behind the farthest depth of
+  the, at most 5x5, texels of the first level where its screen rectangle
+  spans 4 texels or less.
+
+  It is used by rendering::Plugin (see rendering::Plugin::setOcclusionCulling()).
+*/
+}
+#endif /* RENDERING_OCCLUSION_CULLER_HPP */
@@ -0,0 +1,133 @@
+#ifndef RENDERING_PARTICLE_SYSTEM_HPP
+#define RENDERING_PARTICLE_SYSTEM_HPP
+
+#include <cstdint>
+#include <vector>
+#include "common.hpp"
+#include "Drawable.hpp"
+
+class JobSystem;
+
+namespace rendering
+{
+class ParticleSystem : public Drawable
+{
+public:
+    //! Configuration of the particles spawned by a ParticleSystem.
+    struct Emitter
+    {
+        //! Particles spawned per second.
+        float rate;
+        //! Range of the lifetime, in seconds.
+        float min_lifetime, max_lifetime;
+        //! Range of the initial speed, in units per second.
+        float min_speed, max_speed;
+        //! Range of the initial direction, in degrees.
+        float min_angle, max_angle;
+        //! Acceleration applied to every particle, in units per second squared.
+        float acceleration_x, acceleration_y;
+        //! Color of the spawned particles. They fade out during the second half of their life.
+        Color color;
+
+        //! Default emitter: 100 white particles per second in every direction, living 1 to 2 seconds.
+        Emitter();
+    };
+
+    /*!
+      \brief Class constructor with the maximum number of live particles.
+
+      All the memory of the system is allocated here.
+     */
+    ParticleSystem(std::size_t capacity);
+
+    //! Class destructor
+    ~ParticleSystem();
+
+    void init() override;
+    void update() override;
+    void onDestroy() override;
+
+    void setShaderProgram(ShaderProgram* shader_program) override;
+
+    //! Get the Emitter configuration, to change it.
+    Emitter& emitter();
+
+    //! Get the Emitter configuration.
+    const Emitter& emitter() const;
+
+    //! Spawn <count> particles right away. Particles over the capacity are dropped.
+    void emit(std::size_t count);
+
+    //! Set the width and height of every particle.
+    void setParticleSize(float size);
+
+    //! Get the width and height of every particle.
+    float getParticleSize() const;
+
+    /*!
+      \brief Split the simulation across the JobSystem plugin, if present.
+
+      Disabled by default.
+     */
+    void setMultithreaded(bool multithreaded);
+
+    //! Get the number of live particles.
+    std::size_t count() const;
+
+    //! Get the maximum number of live particles.
+    std::size_t capacity() const;
+
+    /*!
+      \brief Draw all the particles with a single instanced draw call.
+     */
+    void draw() override;
+
+    static const char* behaviorName();
+
+private:
+    struct Instance_t {
+        float x, y, t;
+        std::uint32_t color;
+    };
+
+    void integrate(std::size_t begin, std::size_t end, float dt);
+    void writeInstances(Instance_t* instances, std::size_t begin, std::size_t end) const;
+    float random(float min, float max);
+
+    static ShaderProgram* _shader_program;
+    GLuint _VAO, _VBO;
+    GLint _particle_loc, _color_loc;
+
+    // Particles in structure of arrays layout. Live particles are packed in
+    // [0, _count): a dying particle is replaced by the last one, so
+    // [_count, _capacity) is the free list and nothing is ever allocated.
+    std::vector<float> _x, _y, _vx, _vy, _age, _lifetime;
+    std::vector<std::uint32_t> _color;
+    std::size_t _count, _capacity;
+
+    Emitter _emitter;
+    float _particle_size;
+    float _emit_accumulator;
+    std::uint32_t _random_state;
+    bool _multithreaded, _uploaded;
+    JobSystem* _job_system;
+};
+
+/*!
+  \class rendering::ParticleSystem
+  \brief A Drawable that simulates and draws a large amount of particles.
+
+  Particles live in the local space of the Drawable, so they follow the
+  hum::Actor. They are simulated every frame with SIMD (SSE when available) and,
+  optionally, on every thread of the JobSystem plugin. The whole system is drawn
+  with one instanced draw call from a buffer streamed once per frame.
+
+  \code
+  auto particles = actor->addBehavior<rendering::ParticleSystem>(1000000);
+  particles->emitter().rate = 200000;
+  particles->emitter().acceleration_y = 9.8f;
+  particles->setMultithreaded(true);
+  \endcode
+*/
+}
+#endif /* RENDERING_PARTICLE_SYSTEM_HPP */
@@ -3,12 +3,27 @@
 
 #include <unordered_map>
 #include <algorithm>
+#include <memory>
+#include <vector>
 #include <GL/glew.h>
 #include "hummingbird/hum.hpp"
+#include "JobSystem.hpp"
+#include "KinematicSystem.hpp"
 #include "SDLPlugin.hpp"
 #include "rendering/common.hpp"
+#include "rendering/Batch.hpp"
 #include "rendering/Camera.hpp"
 #include "rendering/Drawable.hpp"
+#include "rendering/DynamicResolution.hpp"
+#include "rendering/GpuTimer.hpp"
+#include "rendering/ImpostorBatch.hpp"
+#include "rendering/IndirectRenderer.hpp"
+#include "rendering/OcclusionCuller.hpp"
+#include "rendering/RenderGraph.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/StaticBatcher.hpp"
+#include "rendering/TextureManager.hpp"
+#include "rendering/View.hpp"
 
 namespace rendering
 {
@@ -22,12 +37,28 @@ namespace rendering
 typedef std::function<void(const hum::Game&, hum::Transformation&)> SpaceTransformation;
 void defaultSpaceTransform(const hum::Game&, hum::Transformation&);
 
+/*!
+  \brief Signature for a batched space transformation method. (see Plugin::setBatchDrawSpaceTransform()).
+
+  Same as SpaceTransformation, but receives <count> contiguous accumulated
+  hum::Transformation%s at once.
+ */
+typedef std::function<void(const hum::Game&, hum::Transformation*, std::size_t)> BatchSpaceTransformation;
+
 
 class Plugin : public hum::Plugin
 {
 public:
-    Plugin();
+    /*!
+      \brief Class constructor.
+
+      A <headless> Plugin needs neither SDLPlugin nor an OpenGL context:
+      Drawable%s are still registered and kept in the hierarchy, but nothing
+      is uploaded nor drawn. For servers and simulations without a display.
+     */
+    Plugin(bool headless = false);
     void gameStart() override;
+    void postFixedUpdate() override;
     void postUpdate() override;
 
     //! Set the clear color for OpenGL
@@ -41,18 +72,66 @@ public:
      */
     void setCamera(const Camera& camera);
 
-    //! Get the Camera being used
+    //! Get the Camera being used by the main View
     const Camera& getCamera() const;
 
-    //! Get the Camera being used
+    //! Get the Camera being used by the main View
     Camera& getCamera();
 
+    /*!
+      \brief Add a View with its own Camera, viewport and target.
+
+      The returned View is owned by the Plugin and exists until removeView()
+      is called on it.
+     */
+    View* addView();
+
+    //! Remove a View added with addView().
+    void removeView(View* view);
+
+    /*!
+      \brief Get the main View.
+
+      It exists from the construction of the Plugin, renders to the window and
+      can't be removed. Its Camera is the one returned by getCamera().
+     */
+    View& mainView();
+
+    /*!
+      \brief Get the View being drawn. (Internal use only).
+
+      Only valid from Drawable::draw().
+     */
+    View& currentView();
+
+    /*!
+      \brief Get the model matrix of the Drawable being drawn. (Internal use only).
+
+      Only valid from Drawable::draw().
+     */
+    const glm::mat4& currentModelMatrix() const;
+
     //! Register a Drawable to be drawn (Internal use only).
     void addDrawable(Drawable* drawable);
 
     //! Register a Drawable to be drawn (Internal use only).
     void removeDrawable(Drawable* drawable);
 
+    //! Add a Drawable to the transformation hierarchy, enabled or not (Internal use only).
+    void addNode(Drawable* drawable);
+
+    //! Remove a Drawable from the transformation hierarchy (Internal use only).
+    void removeNode(Drawable* drawable);
+
+    //! Rebuild the transformation hierarchy before the next frame (Internal use only).
+    void invalidateHierarchy();
+
+    //! Register a Batch to be flushed after every View (Internal use only).
+    void addBatch(Batch* batch);
+
+    //! Unregister a Batch (Internal use only).
+    void removeBatch(Batch* batch);
+
     /*!
       \brief Set the space transformation between the game logic space and the
       draw space.
@@ -80,21 +159,260 @@ public:
      */
     void setDrawSpaceTransform(const SpaceTransformation& space_transform);
 
+    /*!
+      \brief Set the space transformation as a function over arrays of
+      hum::Transformation%s.
+
+      Same as setDrawSpaceTransform(), but the function is called with all the
+      Drawable%s' transformations at once (or in ranges, see
+      setParallelSpaceTransform()), which lets it vectorize its work or share
+      lookups between neighbours.
+
+      Example:
+      \code
+      void setTerrainHeights(const hum::Game& game, hum::Transformation* r, std::size_t count)
+      {
+        const Terrain& terrain = game.getPlugin<Terrains>()->getCurrent();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          r[i].position.z = terrain.height(r[i].position.x, r[i].position.y);
+        }
+      }
+      \endcode
+     */
+    void setBatchDrawSpaceTransform(const BatchSpaceTransformation& space_transform);
+
+    /*!
+      \brief Split the space transformation in ranges run on the JobSystem
+      plugin, if present.
+
+      Only enable it if the space transformation is safe to call from several
+      threads at once. Disabled by default.
+     */
+    void setParallelSpaceTransform(bool parallel);
+
+    /*!
+      \brief Enable or disable dynamic resolution scaling.
+
+      When enabled the scene is rendered into an offscreen target whose
+      resolution is scaled between the bounds of dynamicResolution() to hold
+      its target GPU frame time. The result is upscaled to the window with a
+      filtered blit.
+
+      Disabled by default.
+     */
+    void setDynamicResolution(bool enabled);
+
+    //! Get whether dynamic resolution scaling is enabled.
+    bool isDynamicResolutionEnabled() const;
+
+    //! Get the dynamic resolution controller, to configure its target and bounds.
+    DynamicResolution& dynamicResolution();
+
+    //! Get the dynamic resolution controller.
+    const DynamicResolution& dynamicResolution() const;
+
+    /*!
+      \brief Set how far past a threshold the screen size of a Drawable must
+      go to switch its level of detail, as a fraction of the threshold.
+
+      Avoids popping between levels of objects around a threshold. Defaults
+      to 0.1 (see Drawable::addLevelOfDetail()).
+     */
+    void setLODHysteresis(float hysteresis);
+
+    //! Get the level of detail hysteresis.
+    float getLODHysteresis() const;
+
+    /*!
+      \brief Enable or disable the GPU-driven path for Rectangle%s.
+
+      When enabled, opaque Rectangle%s with the default shading, without levels
+      of detail and not static (see Drawable::setStatic()) are culled and drawn on the GPU by an IndirectRenderer: the
+      CPU only uploads the ones that changed and issues one draw per View.
+      They are drawn before, and not sorted with, the other Drawable%s, so
+      translucent ones stay on the usual path. Needs OpenGL 4.3, without it
+      a warning is logged and it stays disabled.
+
+      Disabled by default.
+     */
+    void setGpuDriven(bool enabled);
+
+    //! Get whether the GPU-driven path is enabled.
+    bool isGpuDriven() const;
+
+    /*!
+      \brief Set the size of the spatial cells static Rectangle%s are batched in (see Drawable::setStatic()).
+
+      Bigger cells mean fewer draw calls but coarser culling and more to
+      re-bake when a static Rectangle changes. 256 world units by default.
+     */
+    void setStaticCellSize(float cell_size);
+
+    //! Get the size of the cells static Rectangle%s are batched in.
+    float getStaticCellSize() const;
+
+    /*!
+      \brief Enable or disable occlusion culling.
+
+      When enabled, before drawing each View the biggest opaque Rectangle%s
+      on screen are drawn to a small CPU depth pyramid (see OcclusionCuller)
+      and the Drawable%s fully behind them are not drawn. Only Drawable%s with
+      bounds (see Drawable::setBounds()) or Rectangle%s can be culled. The
+      ones drawn by the GPU-driven path are only occluders. The culled ones
+      are counted in FrameStatistics_t::drawables_occluded.
+
+      Disabled by default.
+     */
+    void setOcclusionCulling(bool enabled);
+
+    //! Get whether occlusion culling is enabled.
+    bool isOcclusionCullingEnabled() const;
+
+    //! Get the occlusion culler, to configure its resolution and number of occluders.
+    OcclusionCuller& occlusionCuller();
+
+    //! Get the occlusion culler.
+    const OcclusionCuller& occlusionCuller() const;
+
+    /*!
+      \brief Get the texture manager, to load Texture%s and set the GPU memory budget.
+
+      Each frame the Plugin tells it how big the Texture%s of the drawn
+      Drawable%s are on screen (see Drawable::texture()) and lets it stream in
+      or evict their mip levels before drawing. Headless, Texture%s are loaded
+      but never made resident.
+     */
+    TextureManager& textureManager();
+
+    //! Get the texture manager.
+    const TextureManager& textureManager() const;
+
+    /*!
+      \brief Set how many pending ShaderPermutations variants are compiled after each frame.
+
+      Defaults to 1. Use 0 to only compile them with ShaderPermutations::precompileAll().
+     */
+    void setShaderWarmUp(unsigned int variants_per_frame);
+
+    //! Get how many pending shader variants are compiled after each frame.
+    unsigned int getShaderWarmUp() const;
+
+    /*!
+      \brief Get the RenderGraph compiled for the last frame.
+
+      Use it to inspect the passes, the lifetimes of their attachments and the
+      texture memory they use (see RenderGraph::describe()).
+     */
+    const RenderGraph& renderGraph() const;
+
+    /*!
+      \brief Get the counters of the last frames (draw calls, state changes,
+      uploads and CPU time per stage).
+
+      Always on, see RenderStatistics. Use the non-const version to change the
+      length of the history.
+     */
+    const RenderStatistics& statistics() const;
+
+    //! Get the counters of the last frames.
+    RenderStatistics& statistics();
+
+    //! Get whether the Plugin was created headless (see Plugin()).
+    bool isHeadless() const;
+
 private:
+    struct Prepared_t {
+        Drawable* drawable;
+        unsigned int node;
+        glm::mat4 model;
+    };
+
+    // A Drawable in the hierarchy. Nodes are stored breadth first, so a
+    // parent is always before its children.
+    struct Node_t {
+        Drawable* drawable;
+        int parent;
+        unsigned int actor_slot;
+        bool dirty, changed;
+        // Index in _prepared this frame, -1 if the Drawable is disabled
+        int prepared;
+        // Instance slot in _indirect_renderer, -1 if drawn by drawView()
+        int indirect_slot;
+        // Member slot in _static_batcher, -1 if not baked
+        int static_slot;
+        hum::Transformation world;
+        glm::mat4 model;
+    };
+
+    // Interpolated transform of an actor, shared by all of its drawables
+    struct ActorTransform_t {
+        const hum::Actor* actor;
+        const hum::Kinematic* kinematic;
+        const KinematicBody* body;
+        unsigned int drawables;
+        bool valid, changed;
+        unsigned long long tick;
+        long long lag;
+        hum::Transformation transform;
+    };
+
     struct DrawOrder_t {
         double order;
-        hum::Transformation transform;
-        Drawable* drawable;
+        unsigned int index;
     };
 
+    void prepareDrawables();
+    void prepareBatched();
+    void buildHierarchy();
+    unsigned int selectLevelOfDetail(Drawable& drawable, float screen_size);
+    void drawViews(const std::vector<View*>& views, int width, int height);
+    void drawView(View& view, int height);
+    void cullOccluded(Camera& camera);
+
     SDLPlugin* _sdl_plugin;
     Color _clear_color;
+    bool _headless;
     bool _game_started;
-    Camera _camera;
-    std::unordered_set<Drawable*> _drawable_set;
+    std::vector<std::unique_ptr<View>> _views;
+    const Camera* _uploaded_camera;
+    View* _current_view;
+    const glm::mat4* _current_model;
+    std::vector<Prepared_t> _prepared;
+    // World transforms of _prepared, contiguous for the batched space transformation
+    std::vector<hum::Transformation> _transforms;
+    std::vector<DrawOrder_t> _draw_order;
+    // Indices in _prepared drawn by drawView(), the rest are drawn by _static_batcher or _indirect_renderer
+    std::vector<unsigned int> _cpu_drawn;
+    std::vector<Batch*> _batches;
+    std::vector<Node_t> _nodes;
+    std::unordered_map<Drawable*, unsigned int> _node_index;
+    std::vector<ActorTransform_t> _actor_transforms;
+    std::vector<unsigned int> _free_actor_slots;
+    std::unordered_map<const hum::Actor*, unsigned int> _actor_slots;
     std::unordered_map<ShaderProgram*, unsigned int> _shader_program_usage;
-    std::unordered_map<Drawable*, const hum::Kinematic*> _drawable_kinematic;
-    SpaceTransformation _space_transform;
+    BatchSpaceTransformation _space_transform;
+    bool _space_transform_identity, _parallel_space_transform;
+    JobSystem* _job_system;
+    KinematicSystem* _kinematic_system;
+    unsigned long long _fixed_tick;
+    bool _hierarchy_dirty;
+    float _lod_hysteresis;
+    unsigned int _shader_warm_up;
+    std::unique_ptr<ImpostorBatch> _impostor_batch;
+    bool _gpu_driven;
+    std::unique_ptr<IndirectRenderer> _indirect_renderer;
+    float _static_cell_size;
+    std::unique_ptr<StaticBatcher> _static_batcher;
+    bool _occlusion_culling;
+    OcclusionCuller _occlusion_culler;
+    TextureManager _texture_manager;
+    bool _dynamic_resolution_enabled;
+    DynamicResolution _dynamic_resolution;
+    RenderGraph _render_graph;
+    GpuTimer _gpu_timer;
+    RenderStatistics _statistics;
+    hum::Clock _stage_clock;
 };
 }
 #endif /* RENDERING_PLUGIN_HPP */
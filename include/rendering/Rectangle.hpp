@@ -1,7 +1,11 @@
 #ifndef MOGL_RECTANGLE_HPP
 #define MOGL_RECTANGLE_HPP
+#include <memory>
 #include "common.hpp"
 #include "Drawable.hpp"
+#include "Material.hpp"
+#include "ShaderPermutations.hpp"
+#include "Texture.hpp"
 
 namespace rendering
 {
@@ -10,9 +14,20 @@ class Rectangle : public Drawable
 public:
     /*!
       \brief Class construtor with fill color
+
+      The Rectangle uses the Material shared by every user of the color (see
+      Material::shared()).
      */
     Rectangle (const Color&);
 
+    /*!
+      \brief Class construtor with a shared Material
+
+      The Rectangle doesn't handle the given pointer and the Material must
+      exist while the Rectangle is using it.
+     */
+    Rectangle (Material* material);
+
     void init() override;
     void onDestroy() override;
 
@@ -20,6 +35,10 @@ public:
 
     /*!
       \brief Set fill color for the Rectangle
+
+      Switches to the Material shared by every user of <color> (see
+      Material::shared()), so the other users of the previous Material aren't
+      affected.
      */
     void setColor(const Color& color);
 
@@ -28,18 +47,50 @@ public:
      */
     const Color& getColor() const;
 
+    //! Use the shared Material <material> (see Rectangle(Material*)).
+    void setMaterial(Material* material);
+
+    //! Get the Material of the Rectangle.
+    Material* getMaterial() const;
+
+    /*!
+      \brief Multiply the Material color by <texture>, stretched over the Rectangle.
+
+      nullptr goes back to the plain color. The Texture must exist while the
+      Rectangle is using it, and the Rectangle isn't drawn until it is loaded. Textured Rectangle%s are drawn one by one, not by
+      the GPU-driven path nor static batches.
+     */
+    void setTexture(Texture* texture);
+
+    //! Get the Texture of the Rectangle, nullptr if it has none.
+    Texture* getTexture() const;
+
     /*!
       \brief Draw the Rectangle
      */
     void draw() override;
 
+    bool unitQuadMaterial(unsigned int& material) const override;
+
+    bool coversUnitQuad(bool& opaque) const override;
+
+    Texture* texture() const override;
+
     static const char* behaviorName();
 
 private:
+    static ShaderPermutations* _permutations;
+    // Its plain and TEXTURED variants
     static ShaderProgram* _shader_program;
+    static ShaderProgram* _textured_program;
     static GLuint _VAO, _VBO;
+    // Material index last set on _shader_program, it keeps it between draws
+    static int _bound_material;
     GLuint _position_loc;
-    Color _color;
+    // Shared Material of the fill color, empty when using one given by the user
+    std::shared_ptr<Material> _color_material;
+    Material* _material;
+    Texture* _texture;
 };
 
 /*!
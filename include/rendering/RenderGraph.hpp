@@ -0,0 +1,196 @@
+#ifndef RENDERING_RENDER_GRAPH_HPP
+#define RENDERING_RENDER_GRAPH_HPP
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+namespace rendering
+{
+class RenderGraph
+{
+public:
+    //! Handle of a resource declared in the graph.
+    typedef unsigned int Resource;
+
+    //! Function that records the commands of a pass.
+    typedef std::function<void(RenderGraph&)> PassFunction;
+
+    //! Description of a 2D texture resource.
+    struct TextureDesc
+    {
+        int width, height;
+        GLenum internal_format;
+
+        bool operator==(const TextureDesc& other) const;
+        bool operator<(const TextureDesc& other) const;
+    };
+
+    //! Information about a pass after compile().
+    struct CompiledPass
+    {
+        std::string name;
+        std::vector<Resource> reads, writes;
+        bool culled;
+    };
+
+    //! Information about a resource after compile().
+    struct CompiledResource
+    {
+        std::string name;
+        TextureDesc desc;
+        bool imported;
+        //! Framebuffer of an imported resource, 0 for the default framebuffer.
+        GLuint imported_framebuffer;
+        //! Index in executionOrder() of the first and last pass using it.
+        unsigned int first_use, last_use;
+        //! Index of the pooled texture it is aliased to, -1 if culled or imported.
+        int physical;
+    };
+
+    //! Class constructor
+    RenderGraph();
+
+    //! Class destructor. Releases the pooled textures.
+    ~RenderGraph();
+
+    /*!
+      \brief Forget the passes and resources of the previous frame.
+
+      Pooled textures and framebuffers are kept to be reused by the next
+      compile().
+     */
+    void reset();
+
+    /*!
+      \brief Declare a transient texture.
+
+      Transient textures only live during the execution of the graph. Their
+      memory may be shared with other transient textures with the same
+      description whose lifetimes do not overlap.
+     */
+    Resource createTexture(const std::string& name, const TextureDesc& desc);
+
+    /*!
+      \brief Declare the default framebuffer as a resource.
+
+      Passes writing imported resources are never culled.
+     */
+    Resource importBackbuffer(const std::string& name, int width, int height);
+
+    /*!
+      \brief Declare an externally owned framebuffer as a resource.
+
+      See importBackbuffer().
+     */
+    Resource importFramebuffer(const std::string& name, GLuint framebuffer, int width, int height);
+
+    /*!
+      \brief Add a pass that reads the resources <reads> and writes <writes>.
+
+      Before <execute> is called the framebuffer of <writes> is bound and the
+      viewport is set to its size. A pass must write either transient textures
+      or an imported resource, but not both.
+
+      Readers of a resource see the contents left by the last pass writing it.
+     */
+    void addPass(const std::string& name, const std::vector<Resource>& reads,
+            const std::vector<Resource>& writes, const PassFunction& execute);
+
+    /*!
+      \brief Order the passes, cull the unused ones and assign pooled textures to
+      the transient resources.
+
+      Must be called with an active OpenGL context.
+     */
+    void compile();
+
+    //! Execute the compiled passes in order.
+    void execute();
+
+    //! Get the native handler of the texture aliased to <resource>.
+    GLuint texture(Resource resource) const;
+
+    /*!
+      \brief Get a framebuffer with the textures of <attachments> attached.
+
+      Useful to read a texture with `glBlitFramebuffer`. Framebuffers are cached.
+     */
+    GLuint framebuffer(const std::vector<Resource>& attachments);
+
+    //! Get the declared passes, with their culled flag set by compile().
+    const std::vector<CompiledPass>& passes() const;
+
+    //! Get the declared resources, with their lifetimes set by compile().
+    const std::vector<CompiledResource>& resources() const;
+
+    //! Get the indices in passes() of the passes to execute, in order.
+    const std::vector<unsigned int>& executionOrder() const;
+
+    //! Get the bytes of texture memory used by the compiled graph.
+    std::size_t memoryFootprint() const;
+
+    //! Get the bytes the compiled graph would use without aliasing.
+    std::size_t unaliasedMemory() const;
+
+    //! Get the bytes of every texture kept in the pool.
+    std::size_t pooledMemory() const;
+
+    //! Get a human readable description of the compiled graph.
+    std::string describe() const;
+
+private:
+    RenderGraph(const RenderGraph&) =delete;
+    RenderGraph& operator=(const RenderGraph&) =delete;
+
+    struct PhysicalTexture_t {
+        GLuint id;
+        TextureDesc desc;
+        unsigned long long last_frame;
+    };
+
+    void bindFramebuffer(const CompiledPass& pass);
+    void releaseUnusedTextures();
+
+    std::vector<CompiledPass> _passes;
+    std::vector<PassFunction> _functions;
+    std::vector<CompiledResource> _resources;
+    std::vector<unsigned int> _order;
+    std::vector<PhysicalTexture_t> _pool;
+    std::map<std::vector<GLuint>, GLuint> _framebuffers;
+    unsigned long long _frame;
+    std::size_t _memory_footprint, _unaliased_memory;
+};
+
+/*!
+  \class rendering::RenderGraph
+  \brief Frame graph that orders passes by their declared attachments and
+  aliases transient textures.
+
+  The graph is declared every frame, compiled and executed:
+
+  \code
+  graph.reset();
+  auto backbuffer = graph.importBackbuffer("backbuffer", w, h);
+  auto color = graph.createTexture("color", {w, h, GL_RGBA8});
+  auto depth = graph.createTexture("depth", {w, h, GL_DEPTH_COMPONENT24});
+  graph.addPass("scene", {}, {color, depth}, [](rendering::RenderGraph&) {
+      // draw
+  });
+  graph.addPass("present", {color}, {backbuffer}, [=](rendering::RenderGraph& g) {
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, g.framebuffer({color}));
+      glBlitFramebuffer(0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  });
+  graph.compile();
+  graph.execute();
+  \endcode
+
+  Passes that do not contribute to an imported resource are culled. The
+  physical textures are kept in a pool between frames, so a graph that does
+  not change from frame to frame does not allocate. Pooled textures that are
+  not used for a few frames are released.
+*/
+}
+#endif /* RENDERING_RENDER_GRAPH_HPP */
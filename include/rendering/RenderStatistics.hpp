@@ -0,0 +1,170 @@
+#ifndef RENDERING_RENDER_STATISTICS_HPP
+#define RENDERING_RENDER_STATISTICS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+
+namespace rendering
+{
+//! Counters of one frame. Times are CPU milliseconds.
+struct FrameStatistics_t {
+    unsigned int drawables_registered;
+    // Drawables drawn and left out by the depth range, summed over the Views
+    unsigned int drawables_visible, drawables_culled;
+    // Drawables left out because they were behind occluders, summed over the Views
+    unsigned int drawables_occluded;
+    unsigned int draw_calls;
+    // Draw calls that draw many objects at once: instanced draws and Batch flushes
+    unsigned int instanced_batches;
+    unsigned int program_switches, vao_switches, uniform_uploads;
+    unsigned long long buffer_bytes;
+    // Texture memory, see TextureManager. Evicted and streamed are the mip levels of this frame
+    unsigned long long texture_budget_bytes, texture_resident_bytes;
+    unsigned long long texture_evicted_bytes, texture_streamed_bytes;
+    float prepare_ms, draw_ms, present_ms, frame_ms;
+};
+
+class RenderStatistics
+{
+public:
+    //! Class constructor keeping the statistics of the last <history> frames.
+    RenderStatistics(std::size_t history = 240);
+
+    //! Count a draw call.
+    static void countDrawCall();
+
+    //! Count a draw call that draws many objects: instanced draws and Batch flushes.
+    static void countInstancedBatch();
+
+    //! Count a ShaderProgram change.
+    static void countProgramSwitch();
+
+    //! Count the binding of the vertex array <vao> for drawing. Binding the bound one again is not counted.
+    static void countVertexArray(GLuint vao);
+
+    //! Count a uniform upload.
+    static void countUniformUpload();
+
+    //! Count <bytes> uploaded to a buffer.
+    static void countBufferUpload(std::size_t bytes);
+
+    /*!
+      \brief Get the counters of the frame being drawn. (Internal use only).
+
+      rendering::Plugin fills the drawable counts and the times.
+     */
+    static FrameStatistics_t& current();
+
+    //! Store the current frame in the history and start a new one. (Internal use only).
+    void endFrame();
+
+    //! Set the number of frames kept. Clears the history.
+    void setHistorySize(std::size_t history);
+
+    //! Get the number of frames in the history.
+    std::size_t size() const;
+
+    //! Get the <i>-th frame of the history, 0 being the oldest.
+    const FrameStatistics_t& frame(std::size_t i) const;
+
+    //! Get the last complete frame. All zeros before the first one.
+    const FrameStatistics_t& last() const;
+
+    /*!
+      \brief Get the <percentile> (in [0, 1]) of <field> over the history.
+
+      \code
+      // 99th percentile of the frame time
+      float p99 = statistics.percentile(&rendering::FrameStatistics_t::frame_ms, 0.99f);
+      \endcode
+     */
+    template <typename T>
+    T percentile(T FrameStatistics_t::* field, float percentile) const;
+
+private:
+    static FrameStatistics_t _current;
+    static GLuint _current_vao;
+
+    std::vector<FrameStatistics_t> _history;
+    std::size_t _capacity, _next;
+    FrameStatistics_t _last;
+};
+
+/*!
+  \class rendering::RenderStatistics
+  \brief Per frame counters of rendering::Plugin and a rolling history of them.
+
+  Counting is an increment of a plain integer, so the statistics can stay
+  enabled in release builds. The Drawable%s and Batch%es that issue OpenGL
+  commands count them; rendering::Plugin counts the Drawable%s and times its
+  stages, and moves the counters to the history at the end of each frame.
+
+  \code
+  const rendering::RenderStatistics& statistics = game().getPlugin<rendering::Plugin>()->statistics();
+  hum::log("Draw calls: ", statistics.last().draw_calls,
+          " frame time p95: ", statistics.percentile(&rendering::FrameStatistics_t::frame_ms, 0.95f));
+  \endcode
+*/
+
+
+inline void RenderStatistics::countDrawCall()
+{
+    ++_current.draw_calls;
+}
+
+inline void RenderStatistics::countInstancedBatch()
+{
+    ++_current.draw_calls;
+    ++_current.instanced_batches;
+}
+
+inline void RenderStatistics::countProgramSwitch()
+{
+    ++_current.program_switches;
+}
+
+inline void RenderStatistics::countVertexArray(GLuint vao)
+{
+    if (vao != _current_vao)
+    {
+        _current_vao = vao;
+        ++_current.vao_switches;
+    }
+}
+
+inline void RenderStatistics::countUniformUpload()
+{
+    ++_current.uniform_uploads;
+}
+
+inline void RenderStatistics::countBufferUpload(std::size_t bytes)
+{
+    _current.buffer_bytes += bytes;
+}
+
+inline FrameStatistics_t& RenderStatistics::current()
+{
+    return _current;
+}
+
+template <typename T>
+T RenderStatistics::percentile(T FrameStatistics_t::* field, float percentile) const
+{
+    if (_history.empty())
+    {
+        return T();
+    }
+    std::vector<T> values;
+    values.reserve(_history.size());
+    for (const FrameStatistics_t& frame : _history)
+    {
+        values.push_back(frame.*field);
+    }
+    std::size_t rank = static_cast<std::size_t>(std::min(std::max(percentile, 0.f), 1.f) * (values.size() - 1) + 0.5f);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+}
+#endif /* RENDERING_RENDER_STATISTICS_HPP */
@@ -0,0 +1,59 @@
+#ifndef RENDERING_RENDER_TARGET_HPP
+#define RENDERING_RENDER_TARGET_HPP
+
+#include <GL/glew.h>
+
+namespace rendering
+{
+class RenderTarget
+{
+public:
+    //! Class constructor
+    RenderTarget();
+
+    //! Class destructor
+    ~RenderTarget();
+
+    /*!
+      \brief Create (or recreate) the framebuffer with a color and a depth
+      attachment of size <width>x<height>.
+
+      This method must be called with an active OpenGL context.
+
+      \return Whether the framebuffer is complete.
+     */
+    bool create(int width, int height);
+
+    //! Release the OpenGL objects of the RenderTarget.
+    void destroy();
+
+    //! Get the native handler of the framebuffer.
+    GLuint framebuffer() const;
+
+    //! Get the native handler of the color texture.
+    GLuint colorTexture() const;
+
+    //! Get the width of the attachments.
+    int width() const;
+
+    //! Get the height of the attachments.
+    int height() const;
+
+private:
+    RenderTarget(const RenderTarget&) =delete;
+    RenderTarget& operator=(const RenderTarget&) =delete;
+
+    GLuint _framebuffer, _color_texture, _depth_renderbuffer;
+    int _width, _height;
+};
+
+/*!
+  \class rendering::RenderTarget
+  \brief Offscreen framebuffer with an RGBA8 color texture and a 24 bit depth
+  renderbuffer.
+
+  Views drawing into it (see View::setTarget()) get a pass of the
+  RenderGraph that imports its framebuffer, which binds it.
+*/
+}
+#endif /* RENDERING_RENDER_TARGET_HPP */
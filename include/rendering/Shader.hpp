@@ -2,6 +2,8 @@
 #define RENDERING_SHADER_INCLUDE_HPP
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include <GL/glew.h>
 
 namespace rendering
@@ -12,8 +14,10 @@ public:
     /*!
       \enum Type
       \brief Type of a Shader.
+
+      COMPUTE_SHADER needs an OpenGL 4.3 context.
      */
-    enum class Type { VERTEX_SHADER, FRAGMENT_SHADER };
+    enum class Type { VERTEX_SHADER, FRAGMENT_SHADER, COMPUTE_SHADER };
 
     //! Class constructor
     Shader();
@@ -22,20 +26,41 @@ public:
     ~Shader();
 
     /*!
-      \brief Load a shader of Shader::Type <type> from a `std::string` containing the source.
+      \brief Load a shader of Shader::Type <type> from a string containing the source.
+
+      The source doesn't need to be null terminated, so it can be a view of a
+      mapped Archive. Each of <defines> (e.g. "HAS_NORMAL" or "LIGHTS 4") is
+      injected as a `#define` right after the `#version` line, without
+      copying the source, and error lines still match the file.
 
       This method must be called with an active OpenGL context.
      */
-    void loadFromSource(const Type type, const std::string& source);
+    void loadFromSource(const Type type, std::string_view source, const std::vector<std::string>& defines = {});
 
     /*!
       \brief Load a shader of Shader::Type <type> from the file <filename>
 
-      This method must be called with an active OpenGL context.
+      The file is looked up in the sources compiled into the engine first (see
+      embedded_shaders::find()), then in the mounted Archive%s (see
+      Archive::mount()) and last on disk, relative to the working directory. With the disk
+      override (see setDiskOverride()) the disk comes first.
+      <defines> are injected as in loadFromSource(). This method must be called with an active OpenGL context.
 
       \return Whether there was and error reading the file.
      */
-    bool loadFromFile(const Type type, const std::string& filename);
+    bool loadFromFile(const Type type, const std::string& filename, const std::vector<std::string>& defines = {});
+
+    /*!
+      \brief Read shader files from disk before the Archive%s and the embedded sources.
+
+      Meant for development: shaders edited in shaders/ are used without
+      rebuilding, as long as the program runs from the root of the tree.
+      Disabled by default.
+     */
+    static void setDiskOverride(bool enabled);
+
+    //! Get whether shader files are read from disk first.
+    static bool hasDiskOverride();
 
     //! Get the native handler of the shader.
     GLuint getId() const;
@@ -62,12 +87,13 @@ private:
     GLuint _shader_id;
     bool _compiled;
     std::string _error_log;
+    static bool _disk_override;
 
 };
 
 /*!
   \class rendering::Shader
-  \brief Class for loading a Vertex Shader or a Fragment Shader.
+  \brief Class for loading a Vertex, Fragment or Compute Shader.
 
   To be used with ShaderProgram.
 */
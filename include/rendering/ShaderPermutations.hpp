@@ -0,0 +1,139 @@
+#ifndef RENDERING_SHADER_PERMUTATIONS_HPP
+#define RENDERING_SHADER_PERMUTATIONS_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ShaderProgram.hpp"
+
+namespace rendering
+{
+class ShaderPermutations
+{
+public:
+    //! Set of keywords, bit i being the i-th keyword given to the constructor.
+    typedef std::uint32_t Mask;
+
+    /*!
+      \brief Class constructor with the sources and the feature <keywords> they understand.
+
+      Keywords are `#ifdef`ed in the sources. At most 32 keywords.
+     */
+    ShaderPermutations(const std::string& vertex_file, const std::string& fragment_file,
+            const std::vector<std::string>& keywords);
+
+    //! Class destructor. Deletes all the variants.
+    ~ShaderPermutations();
+
+    /*!
+      \brief Set a function called on every variant right after linking it.
+
+      Use it to bind uniform blocks (see Material::bindTable()) or set
+      constant uniforms.
+     */
+    void setLinkCallback(const std::function<void(ShaderProgram*)>& callback);
+
+    //! Get the Mask of the keywords <keywords>. Unknown keywords are ignored.
+    Mask mask(const std::vector<std::string>& keywords) const;
+
+    /*!
+      \brief Get the variant for <mask>, compiling it right away if needed.
+
+      Compiling here stalls the frame: variants should be required() and
+      compiled ahead with precompile() or warmUp().
+
+      \return The variant, or nullptr if it doesn't compile or link.
+     */
+    ShaderProgram* get(Mask mask);
+
+    //! Declare that the variant <mask> will be used, so it gets compiled ahead.
+    void require(Mask mask);
+
+    //! Get whether the variant <mask> is compiled.
+    bool isCompiled(Mask mask) const;
+
+    //! Get every variant required or used so far.
+    std::vector<Mask> used() const;
+
+    //! Compile every required variant now.
+    void precompile();
+
+    /*!
+      \brief Compile at most <max_variants> of the pending variants.
+
+      The number compiled, failed compiles included, is stored in <compiled>
+      if it isn't null.
+
+      \return Whether there are no pending variants left.
+     */
+    bool warmUp(unsigned int max_variants, unsigned int* compiled = nullptr);
+
+    /*!
+      \brief Call warmUp() on every ShaderPermutations until <max_variants> were compiled in total.
+
+      \return Whether no ShaderPermutations has pending variants left.
+     */
+    static bool warmUpAll(unsigned int max_variants);
+
+    //! Call precompile() on every ShaderPermutations.
+    static void precompileAll();
+
+    /*!
+      \brief Write the variants used by every ShaderPermutations to <filename>.
+
+      Loading it in the next run with loadManifest() lets the game compile
+      them all at startup.
+     */
+    static bool saveManifest(const std::string& filename);
+
+    /*!
+      \brief Require the variants listed in <filename> by saveManifest().
+
+      Entries of ShaderPermutations that don't exist (yet) are kept and
+      applied when they are created.
+     */
+    static bool loadManifest(const std::string& filename);
+
+private:
+    ShaderPermutations(const ShaderPermutations&) =delete;
+    ShaderPermutations& operator=(const ShaderPermutations&) =delete;
+
+    ShaderProgram* compile(Mask mask);
+    std::string key() const;
+
+    static std::vector<ShaderPermutations*> _instances;
+    // Masks from a manifest, by key(), waiting for their ShaderPermutations
+    static std::multimap<std::string, Mask> _manifest;
+
+    std::string _vertex_file, _fragment_file;
+    std::vector<std::string> _keywords;
+    std::function<void(ShaderProgram*)> _link_callback;
+    // Variants by Mask. A null program is a required variant not compiled yet,
+    // or one that failed (see _failed).
+    std::map<Mask, std::unique_ptr<ShaderProgram>> _variants;
+    std::vector<Mask> _failed;
+};
+
+/*!
+  \class rendering::ShaderPermutations
+  \brief Table of the variants of a pair of shaders, keyed by a bitmask of feature keywords.
+
+  Each variant is compiled with its keywords `#define`d (see
+  Shader::loadFromSource()), so one source serves every combination of
+  features. Variants can be required ahead and compiled at startup
+  (precompile()) or a few per frame (warmUp(), called by rendering::Plugin),
+  so a new combination doesn't compile on the critical path.
+
+  \code
+  rendering::ShaderPermutations plain("shaders/plain.vert", "shaders/plain.frag", {"INSTANCED", "FOG"});
+  plain.require(plain.mask({"FOG"}));
+  plain.require(plain.mask({"INSTANCED", "FOG"}));
+  // ... later, already compiled
+  ShaderProgram* program = plain.get(plain.mask({"FOG"}));
+  \endcode
+*/
+}
+#endif /* RENDERING_SHADER_PERMUTATIONS_HPP */
@@ -38,6 +38,25 @@ public:
      */
     GLint bindVertexAttribute(const std::string& attrib_name, GLint size, GLsizei stride, GLvoid* first_pointer);
 
+    /*!
+      \brief Bind a vertex attribute of components of type <type> to the ShaderProgram
+
+      The attribute reaches the shaders as floats. If <normalized> integer
+      components are mapped to [0, 1] (or [-1, 1] for signed types).
+
+      \return The location of the attribute.
+     */
+    GLint bindVertexAttribute(const std::string& attrib_name, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLvoid* first_pointer);
+
+    /*!
+      \brief Bind a vertex attribute of integer components of type <type> to the ShaderProgram
+
+      The attribute reaches the shaders as integers (`int`, `uint`, `ivecN`...).
+
+      \return The location of the attribute.
+     */
+    GLint bindVertexAttributeI(const std::string& attrib_name, GLint size, GLenum type, GLsizei stride, GLvoid* first_pointer);
+
     /*!
       \brief Link the various Shaders added into the ShaderProgram
 
@@ -48,10 +67,26 @@ public:
     /*!
       \brief Set the ShaderProgram as the one currently being used
 
+      Does nothing if it already is.
+
       \return A pointer to itself.
      */
     ShaderProgram* use();
 
+    /*!
+      \brief Pass an `int` (or sampler) uniform wth name <uniform_name> to the associated shaders.
+
+      \return A pointer to itself.
+     */
+    ShaderProgram* setUniform1i(const std::string& uniform_name, int v0);
+
+    /*!
+      \brief Pass a `float` uniform wth name <uniform_name> to the associated shaders.
+
+      \return A pointer to itself.
+     */
+    ShaderProgram* setUniform1f(const std::string& uniform_name, float v0);
+
     /*!
       \brief Pass a `vec2` uniform wth name <uniform_name> to the associated shaders.
 
@@ -80,6 +115,13 @@ public:
      */
     ShaderProgram* setUniformMatrix4f(const std::string& uniform_name, const glm::mat4& mat);
 
+    /*!
+      \brief Connect the uniform block <block_name> to the uniform buffer binding point <binding>.
+
+      Must be called after link(). Blocks the shaders don't declare are ignored.
+     */
+    ShaderProgram* bindUniformBlock(const std::string& block_name, GLuint binding);
+
     /*!
       \brief Get whether the ShaderProgram was able to link all the associated
       Shader%s.
@@ -97,6 +139,9 @@ private:
     ShaderProgram(const ShaderProgram&) =delete;
     ShaderProgram& operator=(const ShaderProgram&) =delete;
 
+    // Program bound by the last use()
+    static GLuint _current_program;
+
     GLuint _program_id;
     bool _linked;
     std::string _error_log;
@@ -0,0 +1,113 @@
+#ifndef RENDERING_STATIC_BATCHER_HPP
+#define RENDERING_STATIC_BATCHER_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#include "glm.hpp"
+#include "Camera.hpp"
+#include "ShaderProgram.hpp"
+
+namespace rendering
+{
+class StaticBatcher
+{
+public:
+    /*!
+      \brief Class constructor. Needs an active OpenGL context.
+
+      Cells are squares of <cell_size> world units on the XY plane.
+     */
+    StaticBatcher(float cell_size = 256.f);
+
+    //! Class destructor
+    ~StaticBatcher();
+
+    //! Get a free member slot. It draws nothing until set().
+    unsigned int acquire();
+
+    //! Take the member in <slot> out of its cell and free the slot.
+    void release(unsigned int slot);
+
+    /*!
+      \brief Bake the unit quad transformed by <model> with the Material index <material> in <slot>.
+
+      The member goes to the cell of its center, the cells it leaves and
+      joins are re-baked before their next draw.
+     */
+    void set(unsigned int slot, const glm::mat4& model, unsigned int material);
+
+    //! Get the Material index of the member in <slot>.
+    unsigned int material(unsigned int slot) const;
+
+    //! Set the size of the cells. Re-bakes everything.
+    void setCellSize(float cell_size);
+
+    //! Get the size of the cells.
+    float getCellSize() const;
+
+    //! Get the number of cells with members.
+    std::size_t cellCount() const;
+
+    /*!
+      \brief Re-bake the changed cells and draw the ones in the frustum of <camera>.
+
+      One draw call per cell drawn.
+     */
+    void draw(Camera& camera);
+
+private:
+    struct Vertex_t {
+        float x, y, z;
+        GLint material;
+    };
+
+    struct Member_t {
+        glm::vec3 corners[4];
+        unsigned int material;
+        long long cell;
+        // Index in the members of the cell, -1 while the slot is free or not set
+        int index;
+    };
+
+    struct Cell_t {
+        std::vector<unsigned int> members;
+        GLuint VAO, VBO;
+        std::size_t capacity;
+        GLsizei vertex_count;
+        bool dirty;
+        glm::vec3 min, max;
+    };
+
+    StaticBatcher(const StaticBatcher&) =delete;
+    StaticBatcher& operator=(const StaticBatcher&) =delete;
+
+    long long cellKey(const glm::vec3& position) const;
+    void join(unsigned int slot);
+    void leave(unsigned int slot);
+    void bake(Cell_t& cell);
+
+    ShaderProgram* _shader_program;
+    float _cell_size;
+    std::vector<Member_t> _members;
+    std::vector<unsigned int> _free_slots;
+    std::unordered_map<long long, Cell_t> _cells;
+};
+
+/*!
+  \class rendering::StaticBatcher
+  \brief Bakes the static Rectangle%s into merged vertex buffers, one per spatial cell (see Drawable::setStatic()).
+
+  Owned by rendering::Plugin, which sets the members that changed each frame.
+  The quads are stored in world space with their Material index as a vertex
+  attribute, so the Rectangle%s of any Material share a cell and each cell is
+  drawn with one call. A cell is only re-baked when one of its members is
+  set, released or moved to another cell, and cells out of the frustum are
+  not drawn.
+
+  The cells are drawn before the other Drawable%s and are not sorted with
+  them: rendering::Plugin only bakes opaque Material%s in them.
+*/
+}
+#endif /* RENDERING_STATIC_BATCHER_HPP */
@@ -0,0 +1,57 @@
+#ifndef RENDERING_STATISTICS_OVERLAY_HPP
+#define RENDERING_STATISTICS_OVERLAY_HPP
+
+#include "Text.hpp"
+
+namespace rendering
+{
+class StatisticsOverlay : public Text
+{
+public:
+    /*!
+      \brief Class constructor with the Font, the size and the color of the text.
+
+      The StatisticsOverlay doesn't handle the given Font and it must exist
+      while the overlay is using it.
+     */
+    StatisticsOverlay(Font* font, float size = 12.f, const Color& color = Color(255, 255, 0));
+
+    void init() override;
+    void update() override;
+
+    /*!
+      \brief Set how often the text is refreshed, in seconds.
+
+      Defaults to 0.25, so the numbers can be read and the overlay itself
+      costs little.
+     */
+    void setRefreshInterval(float seconds);
+
+    //! Get how often the text is refreshed, in seconds.
+    float getRefreshInterval() const;
+
+    static const char* behaviorName();
+
+private:
+    void refresh();
+
+    Plugin* _statistics_plugin;
+    float _refresh_interval, _elapsed;
+};
+
+/*!
+  \class rendering::StatisticsOverlay
+  \brief A Text that shows the RenderStatistics of rendering::Plugin.
+
+  Shows the counters of the last frame and the median and 95th percentile of
+  the frame time over the history. Like any Drawable it is drawn by every
+  View, so place its actor where the camera of the View meant for it looks.
+
+  \code
+  hum::Actor* overlay = game.actors().create();
+  overlay->addBehavior<rendering::StatisticsOverlay>(&font);
+  overlay->transform().position = hum::Vector3f(4, 4, 0);
+  \endcode
+*/
+}
+#endif /* RENDERING_STATISTICS_OVERLAY_HPP */
@@ -0,0 +1,98 @@
+#ifndef RENDERING_TEXT_HPP
+#define RENDERING_TEXT_HPP
+
+#include <string>
+#include <vector>
+#include "common.hpp"
+#include "Drawable.hpp"
+#include "Font.hpp"
+
+namespace rendering
+{
+class Plugin;
+class TextBatch;
+
+class Text : public Drawable
+{
+public:
+    /*!
+      \brief Class constructor with the Font, the string, the size (height of
+      an em in world units) and the color.
+
+      The Text doesn't handle the given Font and it must exist while the Text
+      is using it.
+     */
+    Text(Font* font, const std::string& string = "", float size = 16.f, const Color& color = Color(255, 255, 255));
+
+    void init() override;
+    void onDestroy() override;
+
+    //! Set the UTF-8 string to draw. Lines are separated by `'\n'`.
+    void setString(const std::string& string);
+
+    //! Get the string being drawn.
+    const std::string& getString() const;
+
+    //! Set the height of an em, in world units.
+    void setSize(float size);
+
+    //! Get the height of an em, in world units.
+    float getSize() const;
+
+    //! Set the color of the Text.
+    void setColor(const Color& color);
+
+    //! Get the color of the Text.
+    const Color& getColor() const;
+
+    //! Set the Font of the Text.
+    void setFont(Font* font);
+
+    //! Get the Font of the Text.
+    Font* getFont() const;
+
+    /*!
+      \brief Append the glyphs of the Text to the text batch.
+     */
+    void draw() override;
+
+    static const char* behaviorName();
+
+private:
+    struct Quad_t {
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+        unsigned int page;
+    };
+
+    void layout();
+
+    static ShaderProgram* _shader_program;
+    static TextBatch* _batch;
+    Font* _font;
+    std::string _string;
+    float _size;
+    Color _color;
+    std::vector<Quad_t> _layout;
+    bool _layout_dirty;
+    Plugin* _plugin;
+};
+
+/*!
+  \class rendering::Text
+  \brief A Drawable that draws a string with a signed distance field Font.
+
+  The layout of the string (the quad of every glyph in the local space of the
+  Text) is cached and only computed again when the string, the size or the Font
+  change, so unchanged labels cost a transform per glyph per frame.
+
+  Texts do not draw themselves. They append their glyphs, already in world
+  space, to a shared Batch that issues one draw call per Font atlas page after
+  each View, from one streamed vertex buffer per page. Texts are therefore
+  drawn on top of the other Drawable%s of the View.
+
+  The origin of the layout (0, 0) is the top left corner of the first line,
+  with the y-axis growing downwards as in the default Camera.
+*/
+}
+#endif /* RENDERING_TEXT_HPP */
@@ -0,0 +1,82 @@
+#ifndef RENDERING_TEXTURE_HPP
+#define RENDERING_TEXTURE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <GL/glew.h>
+
+namespace rendering
+{
+class Texture
+{
+public:
+    //! Class destructor
+    ~Texture();
+
+    /*!
+      \brief Get the native handler of the texture.
+
+      0 until the Texture is loaded. It changes when levels are streamed in
+      or evicted, so get it every time the Texture is bound.
+     */
+    GLuint getId() const;
+
+    //! Get whether the image is decoded and its mip levels built.
+    bool isLoaded() const;
+
+    //! Get the width of level 0. 0 while loading.
+    unsigned int getWidth() const;
+
+    //! Get the height of level 0. 0 while loading.
+    unsigned int getHeight() const;
+
+    //! Get the number of mip levels, down to 1x1. 0 while loading.
+    unsigned int levelCount() const;
+
+    //! Get the bytes of mip level <level>.
+    std::size_t levelBytes(unsigned int level) const;
+
+    //! Get the finest mip level resident on the GPU, levelCount() when none is.
+    unsigned int residentLevel() const;
+
+    //! Get the bytes the resident levels take on the GPU.
+    std::size_t residentBytes() const;
+
+private:
+    friend class TextureManager;
+
+    Texture();
+    Texture(const Texture&) =delete;
+    Texture& operator=(const Texture&) =delete;
+
+    unsigned int levelWidth(unsigned int level) const;
+    unsigned int levelHeight(unsigned int level) const;
+    // Bytes of the levels from <level> to the last one
+    std::size_t chainBytes(unsigned int level) const;
+    // Upload the levels from <level> to the last one into a new texture
+    void makeResident(unsigned int level);
+
+    GLuint _id;
+    unsigned int _width, _height;
+    // RGBA8 pixels of every level, bottom row first
+    std::vector<std::vector<unsigned char>> _levels;
+    unsigned int _resident_level;
+    // Finest level asked for by the draws since the last TextureManager::update()
+    unsigned int _wanted_level;
+    unsigned long long _last_used;
+    // Level the TextureManager keeps resident, updated every frame
+    unsigned int _target_level;
+};
+
+/*!
+  \class rendering::Texture
+  \brief A mipmapped RGBA image whose levels on the GPU are managed by a TextureManager.
+
+  Textures are created by rendering::TextureManager::load() or
+  rendering::TextureManager::create() and owned by the TextureManager. Every
+  mip level stays in system memory; only the resident ones, from
+  residentLevel() to the last, are on the GPU, in a texture whose level 0 is
+  residentLevel(). Sampling it always gets the finest resident level.
+*/
+}
+#endif /* RENDERING_TEXTURE_HPP */
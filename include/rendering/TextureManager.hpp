@@ -0,0 +1,179 @@
+#ifndef RENDERING_TEXTURE_MANAGER_HPP
+#define RENDERING_TEXTURE_MANAGER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Texture.hpp"
+
+namespace rendering
+{
+class TextureManager
+{
+public:
+    /*!
+      \brief Default constructor.
+
+      Constructs the manager with the following default values:
+      \code
+      rendering::TextureManager manager;
+      manager.setBudget(256 * 1024 * 1024);
+      manager.setUploadBudget(4 * 1024 * 1024);
+      \endcode
+     */
+    TextureManager();
+
+    //! Class destructor. Stops the loader thread and destroys every Texture.
+    ~TextureManager();
+
+    /*!
+      \brief Load the BMP image <filename> on the loader thread.
+
+      The file is looked up in the mounted Archive%s first (see
+      Archive::mount()), which must stay mounted until the Texture is loaded.
+      The Texture is returned right away and draws nothing until it is loaded;
+      on error it stays unloaded and an error is logged.
+     */
+    Texture* load(const std::string& filename);
+
+    /*!
+      \brief Create a Texture from the <width>x<height> RGBA8 <pixels>, bottom row first.
+
+      The mip levels are built on the calling thread. Like a load()ed one, the
+      Texture draws nothing until the next update() takes it.
+     */
+    Texture* create(unsigned int width, unsigned int height, const unsigned char* pixels);
+
+    //! Destroy <texture>. Nothing may draw it afterwards.
+    void release(Texture* texture);
+
+    /*!
+      \brief Record that <texture> is drawn covering <screen_size> pixels along its longest side.
+
+      Called by rendering::Plugin for the Drawable%s it draws (see
+      Drawable::texture()). The finest level asked for since the last
+      update() is the one streamed in.
+     */
+    void touch(Texture* texture, float screen_size);
+
+    /*!
+      \brief Take the loaded Texture%s and update which mip levels are resident.
+
+      Called by rendering::Plugin once per frame, before drawing. Needs an
+      active OpenGL context.
+     */
+    void update();
+
+    /*!
+      \brief Set the GPU memory, in bytes, the resident mip levels should fit in.
+
+      Levels are evicted from the least recently drawn Texture%s first. The
+      levels of 32x32 or smaller are never evicted, so the budget can be
+      exceeded by them alone.
+     */
+    void setBudget(std::size_t bytes);
+
+    //! Get the GPU memory budget in bytes.
+    std::size_t getBudget() const;
+
+    /*!
+      \brief Set the bytes of mip levels streamed in per frame.
+
+      Bounds the upload stall of a frame. At least one level is streamed in
+      every frame that needs one.
+     */
+    void setUploadBudget(std::size_t bytes);
+
+    //! Get the bytes of mip levels streamed in per frame.
+    std::size_t getUploadBudget() const;
+
+    //! Get the bytes the resident mip levels take on the GPU.
+    std::size_t residentBytes() const;
+
+    //! Get the bytes of mip levels evicted since the TextureManager was created.
+    unsigned long long evictedBytes() const;
+
+    //! Get the bytes of mip levels streamed in since the TextureManager was created.
+    unsigned long long streamedBytes() const;
+
+    //! Get the number of Texture%s, loaded or not.
+    std::size_t size() const;
+
+private:
+    struct Request_t {
+        unsigned int id;
+        std::string filename;
+        // Contents in a mounted Archive, null data() to read the file
+        std::string_view packed;
+    };
+
+    struct Loaded_t {
+        unsigned int id;
+        std::string filename;
+        unsigned int width, height;
+        // Empty if the image couldn't be decoded
+        std::vector<std::vector<unsigned char>> levels;
+    };
+
+    TextureManager(const TextureManager&) =delete;
+    TextureManager& operator=(const TextureManager&) =delete;
+
+    static bool decode(const Request_t& request, Loaded_t& loaded);
+    static void buildLevels(Loaded_t& loaded);
+    void loaderLoop();
+    void receive(Loaded_t& loaded);
+    // Finest level the draws since the last update() need, the tail if none
+    unsigned int neededLevel(const Texture& texture) const;
+    // Finest level of TAIL_SIZE or smaller, never evicted
+    unsigned int tailLevel(const Texture& texture) const;
+
+    std::size_t _budget, _upload_budget;
+    std::size_t _resident_bytes;
+    unsigned long long _evicted_bytes, _streamed_bytes;
+    unsigned long long _frame;
+    unsigned int _next_id;
+    std::unordered_map<unsigned int, std::unique_ptr<Texture>> _textures;
+    std::unordered_map<const Texture*, unsigned int> _ids;
+    std::vector<Texture*> _order;
+    // Shared with the loader thread
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::deque<Request_t> _requests;
+    std::vector<Loaded_t> _loaded;
+    bool _stop;
+    std::thread _loader;
+};
+
+/*!
+  \class rendering::TextureManager
+  \brief Keeps the mip levels of the Texture%s the frame needs on the GPU, within a memory budget.
+
+  Owned by rendering::Plugin (see rendering::Plugin::textureManager()).
+  Images are decoded and their mip levels built on a loader thread, started
+  with the first load(). Each frame the Plugin touches the Texture%s of the
+  Drawable%s it draws with their size on screen, which picks the finest level
+  worth having. update() then evicts levels, least recently drawn Texture%s
+  first, until the wanted ones fit in the budget, and streams in finer levels
+  one per Texture and frame, the most recently drawn first, within the upload
+  budget. A Texture nearing the camera gets sharper over a few frames instead
+  of stalling one.
+
+  The budget, the resident bytes and the bytes evicted and streamed in each
+  frame are in rendering::FrameStatistics_t.
+
+  \code
+  rendering::TextureManager& textures = game().getPlugin<rendering::Plugin>()->textureManager();
+  textures.setBudget(64 * 1024 * 1024);
+  rendering::Texture* bricks = textures.load("textures/bricks.bmp");
+  actor.addBehavior<rendering::Rectangle>(rendering::Color(255, 255, 255))->setTexture(bricks);
+  \endcode
+*/
+}
+#endif /* RENDERING_TEXTURE_MANAGER_HPP */
@@ -0,0 +1,121 @@
+#ifndef RENDERING_TILEMAP_HPP
+#define RENDERING_TILEMAP_HPP
+
+#include <vector>
+#include "common.hpp"
+#include "Drawable.hpp"
+
+namespace rendering
+{
+class Plugin;
+
+class Tilemap : public Drawable
+{
+public:
+    //! Index of a tile type. Tile 0 is empty and is never drawn.
+    typedef unsigned char Tile;
+
+    //! Width and height, in tiles, of a chunk.
+    static const unsigned int CHUNK_SIZE = 32;
+
+    /*!
+      \brief Class constructor with the size of the map in tiles.
+
+      All the tiles start empty (0).
+     */
+    Tilemap(unsigned int width, unsigned int height);
+
+    //! Class destructor
+    ~Tilemap();
+
+    void init() override;
+    void onDestroy() override;
+
+    void setShaderProgram(ShaderProgram* shader_program) override;
+
+    //! Set the tile at column <x> and row <y>.
+    void setTile(unsigned int x, unsigned int y, Tile tile);
+
+    //! Get the tile at column <x> and row <y>.
+    Tile getTile(unsigned int x, unsigned int y) const;
+
+    //! Set every tile of the map to <tile>.
+    void fill(Tile tile);
+
+    /*!
+      \brief Set the color used to draw tiles of type <tile>.
+
+      All tile types are white by default.
+     */
+    void setTileColor(Tile tile, const Color& color);
+
+    //! Get the width of the map in tiles.
+    unsigned int width() const;
+
+    //! Get the height of the map in tiles.
+    unsigned int height() const;
+
+    //! Get the number of chunks drawn by the last draw().
+    unsigned int chunksDrawn() const;
+
+    //! Get the number of chunks that currently have their geometry on the GPU.
+    unsigned int chunksResident() const;
+
+    //! Get the bytes of CPU memory used by the tiles.
+    std::size_t memoryUsage() const;
+
+    /*!
+      \brief Draw the visible chunks of the Tilemap
+     */
+    void draw() override;
+
+    static const char* behaviorName();
+
+private:
+    struct Chunk_t {
+        //! Empty while every tile of the chunk equals `fill`
+        std::vector<Tile> tiles;
+        Tile fill;
+        GLuint VBO;
+        GLsizei tile_count;
+        bool dirty;
+        unsigned long long last_drawn;
+    };
+
+    Chunk_t& chunkAt(unsigned int x, unsigned int y);
+    const Chunk_t& chunkAt(unsigned int x, unsigned int y) const;
+    void bake(Chunk_t& chunk, unsigned int chunk_x, unsigned int chunk_y);
+    void release(Chunk_t& chunk);
+
+    static ShaderProgram* _shader_program;
+    static GLuint _VAO;
+    GLuint _tile_loc;
+    GLuint _palette_texture;
+    std::vector<unsigned char> _palette;
+    bool _palette_dirty;
+    unsigned int _width, _height, _chunks_x, _chunks_y;
+    std::vector<Chunk_t> _chunks;
+    unsigned long long _frame;
+    unsigned int _chunks_drawn, _chunks_resident;
+    Plugin* _plugin;
+};
+
+/*!
+  \class rendering::Tilemap
+  \brief A grid of 1x1 tiles drawn by chunks.
+
+  Tiles are stored in chunks of CHUNK_SIZE x CHUNK_SIZE. A chunk whose tiles are
+  all equal (e.g. a freshly created or filled map) only stores one tile. The
+  geometry of a chunk (4 bytes per non empty tile) is baked into a static
+  vertex buffer the first time it is visible and only rebuilt after one of its
+  tiles changes. Buffers of chunks that have not been visible for a while are
+  released.
+
+  Every visible chunk costs one instanced draw call. Chunks are culled as a
+  whole against the View being drawn.
+
+  For different tile sizes use the scale in either the hum::Actor hum::Transform
+  of the Drawable's hum::Transform.
+*/
+}
+#endif /* RENDERING_TILEMAP_HPP */
@@ -0,0 +1,83 @@
+#ifndef RENDERING_VIEW_HPP
+#define RENDERING_VIEW_HPP
+
+#include "rendering/Camera.hpp"
+#include "rendering/RenderTarget.hpp"
+
+namespace rendering
+{
+class View
+{
+public:
+    /*!
+      \brief Default constructor.
+
+      The View covers the whole window with a default Camera.
+     */
+    View();
+
+    //! Get the Camera of the View.
+    Camera& camera();
+
+    //! Get the Camera of the View.
+    const Camera& camera() const;
+
+    /*!
+      \brief Set the region of the target covered by the View.
+
+      Values are fractions of the target size with (0, 0) at the top left
+      corner. By default the View covers the whole target: (0, 0, 1, 1).
+     */
+    void setViewport(float x, float y, float width, float height);
+
+    //! Get the region of the target covered by the View. See setViewport().
+    const glm::vec4& getViewport() const;
+
+    /*!
+      \brief Set the RenderTarget to render to.
+
+      `nullptr` (the default) renders to the window. The View doesn't handle the
+      given pointer and the pointed object must exist while the View is using it.
+     */
+    void setTarget(RenderTarget* target);
+
+    //! Get the RenderTarget the View renders to, `nullptr` for the window.
+    RenderTarget* getTarget() const;
+
+    //! Enable the View. Views are enabled by default.
+    void enable();
+
+    //! Disable the View. A disabled View is not rendered.
+    void disable();
+
+    //! Query if the View is enabled.
+    bool isEnabled() const;
+
+private:
+    Camera _camera;
+    glm::vec4 _viewport;
+    RenderTarget* _target;
+    bool _is_enabled;
+};
+
+/*!
+  \class rendering::View
+  \brief A Camera rendering into a region of the window or of a RenderTarget.
+
+  Views are created with rendering::Plugin::addView(). Every View draws all the
+  Drawable%s, but the per frame work that does not depend on the Camera
+  (interpolation, space transformation and model matrices) is done once and
+  shared by all of them.
+
+  Example (minimap on the top right corner):
+  \code
+  rendering::View* minimap = game().getPlugin<rendering::Plugin>()->addView();
+  minimap->setViewport(0.75f, 0.f, 0.25f, 0.25f);
+  minimap->camera().setOrthogonal(0, 1000, 1000, 0);
+  \endcode
+
+  Views are rendered in the order they were added. Views rendering to a
+  RenderTarget are rendered before the ones rendering to the window.
+*/
+}
+#endif /* RENDERING_VIEW_HPP */
@@ -0,0 +1,16 @@
+#version 330
+
+in vec2 disc_uv;
+in vec4 disc_color;
+out vec4 out_color;
+
+void main()
+{
+    float distance = length(disc_uv);
+    if (distance > 1.0)
+    {
+        discard;
+    }
+    // Darker towards the rim, so the disc reads as a sphere
+    out_color = vec4(disc_color.rgb * (1.0 - 0.4 * distance * distance), disc_color.a);
+}
@@ -0,0 +1,18 @@
+#version 430
+
+struct Material
+{
+    vec4 color;
+    vec4 parameters;
+};
+layout(std140) uniform Materials
+{
+    Material materials[256];
+};
+flat in uint material_index;
+out vec4 out_color;
+
+void main()
+{
+    out_color = materials[material_index].color;
+}
@@ -0,0 +1,25 @@
+#version 430
+
+struct Instance
+{
+    mat4 model;
+    uint material;
+    uint enabled;
+    uint padding0, padding1;
+};
+layout(std430, binding = 0) readonly buffer Instances
+{
+    Instance instances[];
+};
+uniform mat4 projection, view;
+in vec2 position;
+// Index in instances, read with the base instance of the draw command
+in uint instance;
+flat out uint material_index;
+
+void main()
+{
+    Instance data = instances[instance];
+    material_index = data.material;
+    gl_Position = projection * view * data.model * vec4(position, 0.0, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 330
+
+struct Material
+{
+    vec4 color;
+    vec4 parameters;
+};
+layout(std140) uniform Materials
+{
+    Material materials[256];
+};
+uniform int material_index;
+#ifdef HAS_NORMAL
+in vec3 world_normal;
+#endif
+out vec4 out_color;
+
+const vec3 light_direction = vec3(0.267, 0.535, 0.802);
+
+void main()
+{
+    vec4 color = materials[material_index].color;
+#ifdef HAS_NORMAL
+    float light = 0.4 + 0.6 * max(dot(normalize(world_normal), light_direction), 0.0);
+    color.rgb *= light;
+#endif
+    out_color = color;
+}
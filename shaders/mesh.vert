@@ -0,0 +1,16 @@
+#version 330
+
+uniform mat4 projection, view, model;
+in vec3 position;
+#ifdef HAS_NORMAL
+in vec3 normal;
+out vec3 world_normal;
+#endif
+
+void main()
+{
+#ifdef HAS_NORMAL
+    world_normal = mat3(model) * normal;
+#endif
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}
@@ -0,0 +1,9 @@
+#version 330
+
+in vec4 particle_color;
+out vec4 out_color;
+
+void main()
+{
+    out_color = particle_color;
+}
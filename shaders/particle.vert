@@ -0,0 +1,18 @@
+#version 330
+
+uniform mat4 projection, view, model;
+uniform float particle_size;
+in vec3 particle;
+in vec4 color;
+out vec4 particle_color;
+
+void main()
+{
+    // Two triangles per particle instance, centered on its position
+    int corner = gl_VertexID;
+    vec2 offset = vec2(corner == 1 || corner == 2 || corner == 4 ? 0.5 : -0.5,
+                       corner == 2 || corner == 4 || corner == 5 ? 0.5 : -0.5);
+    // particle.z is the normalized age, fade out during the last half of the life
+    particle_color = vec4(color.rgb, color.a * clamp(2.0 - 2.0 * particle.z, 0.0, 1.0));
+    gl_Position = projection * view * model * vec4(particle.xy + offset * particle_size, 0.0, 1.0);
+}
@@ -1,10 +1,25 @@
 #version 330
 
-uniform sampler2D tex;
-uniform vec4 color;
+struct Material
+{
+    vec4 color;
+    vec4 parameters;
+};
+layout(std140) uniform Materials
+{
+    Material materials[256];
+};
+uniform int material_index;
+#ifdef TEXTURED
+uniform sampler2D texture_map;
+in vec2 uv;
+#endif
 out vec4 out_color;
 
 void main()
 {
-    out_color = color;
+    out_color = materials[material_index].color;
+#ifdef TEXTURED
+    out_color *= texture(texture_map, uv);
+#endif
 }
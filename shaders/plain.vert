@@ -2,8 +2,14 @@
 
 uniform mat4 projection, view, model;
 in vec2 position;
+#ifdef TEXTURED
+out vec2 uv;
+#endif
 
 void main()
 {
+#ifdef TEXTURED
+    uv = position;
+#endif
     gl_Position = projection * view * model * vec4(position, 0.0, 1.0);
 }
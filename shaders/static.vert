@@ -0,0 +1,13 @@
+#version 330
+
+uniform mat4 projection, view;
+// Already in world space
+in vec3 position;
+in int material;
+flat out int material_index;
+
+void main()
+{
+    material_index = material;
+    gl_Position = projection * view * vec4(position, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330
+
+uniform sampler2D atlas;
+in vec2 glyph_uv;
+in vec4 glyph_color;
+out vec4 out_color;
+
+void main()
+{
+    // The outline is at 0.5 in the distance field; fwidth keeps the edge one pixel wide at any size
+    float distance = texture(atlas, glyph_uv).r;
+    float width = max(fwidth(distance) * 0.7, 0.001);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    out_color = vec4(glyph_color.rgb, glyph_color.a * alpha);
+}
@@ -0,0 +1,15 @@
+#version 330
+
+uniform mat4 projection, view, model;
+in vec3 position;
+in vec2 uv;
+in vec4 color;
+out vec2 glyph_uv;
+out vec4 glyph_color;
+
+void main()
+{
+    glyph_uv = uv;
+    glyph_color = color;
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}
@@ -0,0 +1,9 @@
+#version 330
+
+in vec4 tile_color;
+out vec4 out_color;
+
+void main()
+{
+    out_color = tile_color;
+}
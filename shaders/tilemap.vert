@@ -0,0 +1,17 @@
+#version 330
+
+uniform mat4 projection, view, model;
+uniform vec2 chunk_offset;
+uniform sampler2D palette;
+in vec3 tile;
+out vec4 tile_color;
+
+void main()
+{
+    // Two triangles per tile instance: (0,0) (1,0) (1,1) (0,0) (1,1) (0,1)
+    int corner = gl_VertexID;
+    vec2 offset = vec2(corner == 1 || corner == 2 || corner == 4 ? 1.0 : 0.0,
+                       corner == 2 || corner == 4 || corner == 5 ? 1.0 : 0.0);
+    tile_color = texelFetch(palette, ivec2(int(tile.z), 0), 0);
+    gl_Position = projection * view * model * vec4(chunk_offset + tile.xy + offset, 0.0, 1.0);
+}
@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <iterator>
+#include "AsyncLog.hpp"
+
+namespace
+{
+const char* levelName(AsyncLog::Level level)
+{
+    switch (level)
+    {
+        case AsyncLog::Level::DEBUG:
+            return "DEBUG";
+        case AsyncLog::Level::INFO:
+            return "INFO";
+        case AsyncLog::Level::WARNING:
+            return "WARNING";
+        default:
+            return "ERROR";
+    }
+}
+
+std::int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::atomic<unsigned long long> s_next_id(1);
+}
+
+thread_local AsyncLog::ThreadRings_t AsyncLog::t_rings;
+
+
+AsyncLog::Ring_t::Ring_t(std::size_t capacity):
+head(0),
+tail(0),
+orphaned(false)
+{
+    std::size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+bool AsyncLog::Ring_t::push(const char* data, std::size_t size)
+{
+    std::size_t h = head.load(std::memory_order_relaxed);
+    std::size_t t = tail.load(std::memory_order_acquire);
+    if (buffer.size() - (h - t) < size)
+    {
+        return false;
+    }
+    std::size_t begin = h & mask;
+    std::size_t first = std::min(size, buffer.size() - begin);
+    std::memcpy(&buffer[begin], data, first);
+    std::memcpy(&buffer[0], data + first, size - first);
+    head.store(h + size, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLog::Ring_t::pop(char* data)
+{
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    std::size_t h = head.load(std::memory_order_acquire);
+    if (h == t)
+    {
+        return false;
+    }
+    // The size is the first field of the record, read it before the rest
+    std::uint32_t size = 0;
+    for (std::size_t i = 0; i < sizeof(size); ++i)
+    {
+        reinterpret_cast<char*>(&size)[i] = buffer[(t + i) & mask];
+    }
+    std::size_t begin = t & mask;
+    std::size_t first = std::min<std::size_t>(size, buffer.size() - begin);
+    std::memcpy(data, &buffer[begin], first);
+    std::memcpy(data + first, &buffer[0], size - first);
+    tail.store(t + size, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLog::Ring_t::empty() const
+{
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+AsyncLog::ThreadRings_t::~ThreadRings_t()
+{
+    // After the last push of the thread, the writer thread drains them once more
+    for (auto& ring : rings)
+    {
+        ring.second->orphaned.store(true, std::memory_order_release);
+    }
+}
+
+
+AsyncLog::AsyncLog(std::size_t ring_size, FullPolicy policy, std::FILE* output):
+_ring_size(std::max(ring_size, MAX_RECORD)),
+_policy(policy),
+_output(output),
+_dropped(0),
+_written(0),
+_stop(false),
+_start(now()),
+_id(s_next_id++)
+{
+    _writer = std::thread(&AsyncLog::writerLoop, this);
+}
+
+AsyncLog::~AsyncLog()
+{
+    _stop = true;
+    _wake.notify_one();
+    _writer.join();
+}
+
+void AsyncLog::gameEnd()
+{
+    flush();
+}
+
+void AsyncLog::flush()
+{
+    _wake.notify_one();
+    while (true)
+    {
+        {
+            // The writer thread holds the lock while it writes what it popped
+            std::lock_guard<std::mutex> lock(_rings_mutex);
+            bool empty = std::all_of(_rings.begin(), _rings.end(),
+                    [](const std::shared_ptr<Ring_t>& ring) { return ring->empty(); });
+            if (empty)
+            {
+                break;
+            }
+        }
+        std::this_thread::yield();
+    }
+    std::fflush(_output);
+}
+
+void AsyncLog::setFullPolicy(FullPolicy policy)
+{
+    _policy = policy;
+}
+
+AsyncLog::FullPolicy AsyncLog::getFullPolicy() const
+{
+    return _policy;
+}
+
+unsigned long long AsyncLog::dropped() const
+{
+    return _dropped;
+}
+
+unsigned long long AsyncLog::written() const
+{
+    return _written;
+}
+
+void AsyncLog::encode(char*& out, char* end, bool value)
+{
+    std::uint8_t raw = value;
+    encodeRaw(out, end, Type::BOOL, &raw, sizeof(raw));
+}
+
+void AsyncLog::encode(char*& out, char* end, char value)
+{
+    encodeRaw(out, end, Type::CHAR, &value, sizeof(value));
+}
+
+void AsyncLog::encode(char*& out, char* end, const char* value)
+{
+    encodeString(out, end, value, std::strlen(value));
+}
+
+void AsyncLog::encode(char*& out, char* end, const std::string& value)
+{
+    encodeString(out, end, value.data(), value.size());
+}
+
+void AsyncLog::encode(char*& out, char* end, const std::string_view& value)
+{
+    encodeString(out, end, value.data(), value.size());
+}
+
+void AsyncLog::encodeString(char*& out, char* end, const char* value, std::size_t size)
+{
+    // Tag, 16 bits of length, then the characters
+    std::size_t header = 1 + sizeof(std::uint16_t);
+    if (out + header > end)
+    {
+        return;
+    }
+    std::uint16_t length = std::min<std::size_t>(size, end - out - header);
+    *out = static_cast<char>(Type::STRING);
+    std::memcpy(out + 1, &length, sizeof(length));
+    std::memcpy(out + header, value, length);
+    out += header + length;
+}
+
+void AsyncLog::encodeRaw(char*& out, char* end, Type type, const void* value, std::size_t size)
+{
+    // Arguments that don't fit are left out, the writer stops at the end of the record
+    if (out + 1 + size > end)
+    {
+        return;
+    }
+    *out = static_cast<char>(type);
+    std::memcpy(out + 1, value, size);
+    out += 1 + size;
+}
+
+AsyncLog::Ring_t& AsyncLog::threadRing()
+{
+    if (t_rings.last_owner == _id)
+    {
+        return *t_rings.last_ring;
+    }
+    auto it = t_rings.rings.find(_id);
+    if (it == t_rings.rings.end())
+    {
+        // Rings only this thread still holds belong to destroyed AsyncLogs
+        for (auto ring = t_rings.rings.begin(); ring != t_rings.rings.end();)
+        {
+            ring = ring->second.use_count() == 1 ? t_rings.rings.erase(ring) : std::next(ring);
+        }
+        std::shared_ptr<Ring_t> ring = std::make_shared<Ring_t>(_ring_size);
+        {
+            std::lock_guard<std::mutex> lock(_rings_mutex);
+            _rings.push_back(ring);
+        }
+        it = t_rings.rings.emplace(_id, ring).first;
+    }
+    t_rings.last_owner = _id;
+    t_rings.last_ring = it->second.get();
+    return *t_rings.last_ring;
+}
+
+void AsyncLog::submit(const char* record, std::size_t size)
+{
+    Ring_t& ring = threadRing();
+    while (!ring.push(record, size))
+    {
+        if (_policy == FullPolicy::DROP)
+        {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        _wake.notify_one();
+        std::this_thread::yield();
+    }
+}
+
+void AsyncLog::writerLoop()
+{
+    while (!_stop)
+    {
+        if (!writePending())
+        {
+            // Threads that log never lock this mutex, they are only waited for with a timeout
+            std::unique_lock<std::mutex> lock(_wake_mutex);
+            _wake.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+    while (writePending())
+    {}
+    std::fflush(_output);
+}
+
+bool AsyncLog::writePending()
+{
+    char record[MAX_RECORD];
+    bool wrote = false;
+    std::lock_guard<std::mutex> lock(_rings_mutex);
+    for (auto it = _rings.begin(); it != _rings.end();)
+    {
+        Ring_t& ring = **it;
+        // Read before draining: an orphaned ring gets no more records
+        bool orphaned = ring.orphaned.load(std::memory_order_acquire);
+        while (ring.pop(record))
+        {
+            write(record);
+            wrote = true;
+        }
+        it = orphaned ? _rings.erase(it) : it + 1;
+    }
+    if (wrote)
+    {
+        std::fflush(_output);
+    }
+    return wrote;
+}
+
+void AsyncLog::write(const char* record)
+{
+    Record_t header;
+    std::memcpy(&header, record, sizeof(Record_t));
+    const char* in = record + sizeof(Record_t);
+    const char* end = record + header.size;
+
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.6f", (header.time - _start) / 1e6);
+    _line.assign(number);
+    _line += " [";
+    _line += levelName(header.level);
+    _line += "] ";
+
+    // Decodes the next argument at the end of _line
+    auto append_argument = [this, &in, end, &number]()
+    {
+        Type type = static_cast<Type>(*in);
+        ++in;
+        switch (type)
+        {
+            case Type::BOOL:
+                _line += *in ? "true" : "false";
+                in += 1;
+                break;
+            case Type::CHAR:
+                _line += *in;
+                in += 1;
+                break;
+            case Type::INT:
+            {
+                std::int64_t value;
+                std::memcpy(&value, in, sizeof(value));
+                std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value));
+                _line += number;
+                in += sizeof(value);
+                break;
+            }
+            case Type::UINT:
+            {
+                std::uint64_t value;
+                std::memcpy(&value, in, sizeof(value));
+                std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+                _line += number;
+                in += sizeof(value);
+                break;
+            }
+            case Type::FLOAT:
+            {
+                double value;
+                std::memcpy(&value, in, sizeof(value));
+                std::snprintf(number, sizeof(number), "%g", value);
+                _line += number;
+                in += sizeof(value);
+                break;
+            }
+            case Type::STRING:
+            {
+                std::uint16_t length;
+                std::memcpy(&length, in, sizeof(length));
+                _line.append(in + sizeof(length), length);
+                in += sizeof(length) + length;
+                break;
+            }
+            case Type::VECTOR3:
+            {
+                double xyz[3];
+                std::memcpy(xyz, in, sizeof(xyz));
+                std::snprintf(number, sizeof(number), "(%g, %g, %g)", xyz[0], xyz[1], xyz[2]);
+                _line += number;
+                in += sizeof(xyz);
+                break;
+            }
+        }
+    };
+
+    for (const char* c = header.format; *c != '\0'; ++c)
+    {
+        if (c[0] == '{' && c[1] == '}' && in < end)
+        {
+            append_argument();
+            ++c;
+        }
+        else
+        {
+            _line += *c;
+        }
+    }
+    while (in < end)
+    {
+        _line += ' ';
+        append_argument();
+    }
+    _line += '\n';
+    std::fwrite(_line.data(), 1, _line.size(), _output);
+    _written.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,582 @@
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "CollisionSystem.hpp"
+#include "JobSystem.hpp"
+
+namespace
+{
+// Colliders per range when the work runs in parallel
+const std::size_t COLLISION_GRAIN = 1024;
+// Cells per range when the pairs are searched in parallel
+const std::size_t CELL_GRAIN = 512;
+
+bool contactLess(const CollisionSystem::Contact_t& a, const CollisionSystem::Contact_t& b)
+{
+    std::less<Collider*> less;
+    return less(a.a, b.a) || (a.a == b.a && less(a.b, b.b));
+}
+
+// Whether a box of half size (hx, hy) grown by r overlaps the origin when moved by (dx, dy)
+bool overlaps(float dx, float dy, float hx, float hy, float r)
+{
+    float ex = std::max(std::abs(dx) - hx, 0.f);
+    float ey = std::max(std::abs(dy) - hy, 0.f);
+    return ex * ex + ey * ey <= r * r;
+}
+}
+
+
+bool CollisionSystem::CellRange_t::operator==(const CellRange_t& other) const
+{
+    return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+}
+
+std::size_t CollisionSystem::CellHash::operator()(std::uint64_t key) const
+{
+    // Spread the packed coordinates over all the bits
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<std::size_t>(key);
+}
+
+
+CollisionSystem::CollisionSystem(float cell_size):
+_cell_size(cell_size),
+_multithreaded(true),
+_job_system(nullptr)
+{
+    hum::assert_msg(cell_size > 0.f, "The cell size of a CollisionSystem must be positive");
+}
+
+void CollisionSystem::gameStart()
+{
+    try
+    {
+        _job_system = game().getPlugin<JobSystem>();
+    }
+    catch (hum::exception::PluginNotFound e)
+    {
+        _job_system = nullptr;
+    }
+}
+
+void CollisionSystem::postFixedUpdate()
+{
+    std::size_t count = _colliders.size();
+
+    // Read the new positions and sizes
+    _new_ranges.resize(count);
+    forEachRange(count, COLLISION_GRAIN, [this](std::size_t begin, std::size_t end) { gather(begin, end); });
+
+    // Only the colliders that changed cells touch the hash
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!(_new_ranges[i] == _ranges[i]))
+        {
+            eraseCells(i, _ranges[i]);
+            insertCells(i, _new_ranges[i]);
+            _ranges[i] = _new_ranges[i];
+        }
+    }
+
+    // Pairs are searched cell by cell, each range of cells writes its own list
+    _cell_list.clear();
+    for (const auto& cell : _cells)
+    {
+        _cell_list.push_back(&cell);
+    }
+    _range_pairs.resize((_cell_list.size() + CELL_GRAIN - 1) / CELL_GRAIN);
+    for (std::vector<Pair_t>& pairs : _range_pairs)
+    {
+        pairs.clear();
+    }
+    forEachRange(_cell_list.size(), CELL_GRAIN, [this](std::size_t begin, std::size_t end)
+    {
+        findPairs(begin, end, _range_pairs[begin / CELL_GRAIN]);
+    });
+
+    if (!_removed.empty())
+    {
+        std::sort(_removed.begin(), _removed.end(), std::less<Collider*>());
+        auto removed = [this](const Contact_t& contact)
+        {
+            return std::binary_search(_removed.begin(), _removed.end(), contact.a, std::less<Collider*>()) ||
+                std::binary_search(_removed.begin(), _removed.end(), contact.b, std::less<Collider*>());
+        };
+        _contacts.erase(std::remove_if(_contacts.begin(), _contacts.end(), removed), _contacts.end());
+        _removed.clear();
+    }
+    _previous_contacts.swap(_contacts);
+    _contacts.clear();
+    for (const std::vector<Pair_t>& pairs : _range_pairs)
+    {
+        for (const Pair_t& pair : pairs)
+        {
+            Collider* a = _colliders[pair.a];
+            Collider* b = _colliders[pair.b];
+            if (std::less<Collider*>()(b, a))
+            {
+                std::swap(a, b);
+            }
+            _contacts.push_back(Contact_t{a, b});
+        }
+    }
+    std::sort(_contacts.begin(), _contacts.end(), contactLess);
+    dispatchEvents();
+}
+
+void CollisionSystem::setCellSize(float cell_size)
+{
+    hum::assert_msg(cell_size > 0.f, "The cell size of a CollisionSystem must be positive");
+    _cell_size = cell_size;
+    _cells.clear();
+    for (unsigned int i = 0; i < _colliders.size(); ++i)
+    {
+        float extent_x = _hx[i] + _radius[i];
+        float extent_y = _hy[i] + _radius[i];
+        _ranges[i] = cellRange(_x[i] - extent_x, _y[i] - extent_y, _x[i] + extent_x, _y[i] + extent_y);
+        insertCells(i, _ranges[i]);
+    }
+}
+
+float CollisionSystem::getCellSize() const
+{
+    return _cell_size;
+}
+
+void CollisionSystem::setMultithreaded(bool multithreaded)
+{
+    _multithreaded = multithreaded;
+}
+
+bool CollisionSystem::isMultithreaded() const
+{
+    return _multithreaded;
+}
+
+const std::vector<CollisionSystem::Contact_t>& CollisionSystem::begun() const
+{
+    return _begun;
+}
+
+const std::vector<CollisionSystem::Contact_t>& CollisionSystem::stayed() const
+{
+    return _stayed;
+}
+
+const std::vector<CollisionSystem::Contact_t>& CollisionSystem::ended() const
+{
+    return _ended;
+}
+
+void CollisionSystem::query(const hum::Vector3f& min, const hum::Vector3f& max, std::vector<Collider*>& result) const
+{
+    float center_x = (min.x + max.x) * 0.5f;
+    float center_y = (min.y + max.y) * 0.5f;
+    float half_x = (max.x - min.x) * 0.5f;
+    float half_y = (max.y - min.y) * 0.5f;
+    CellRange_t range = cellRange(min.x, min.y, max.x, max.y);
+    for (int y = range.y0; y <= range.y1; ++y)
+    {
+        for (int x = range.x0; x <= range.x1; ++x)
+        {
+            auto cell = _cells.find(cellKey(x, y));
+            if (cell == _cells.end())
+            {
+                continue;
+            }
+            for (unsigned int i : cell->second)
+            {
+                // Report each collider only in the first cell it shares with the box
+                const CellRange_t& other = _ranges[i];
+                if (std::max(range.x0, other.x0) != x || std::max(range.y0, other.y0) != y)
+                {
+                    continue;
+                }
+                if (overlaps(_x[i] - center_x, _y[i] - center_y, _hx[i] + half_x, _hy[i] + half_y, _radius[i]))
+                {
+                    result.push_back(_colliders[i]);
+                }
+            }
+        }
+    }
+}
+
+std::size_t CollisionSystem::size() const
+{
+    return _colliders.size();
+}
+
+void CollisionSystem::add(Collider* collider)
+{
+    collider->_index = _colliders.size();
+    _colliders.push_back(collider);
+    _actors.push_back(&collider->actor());
+    _x.push_back(0.f);
+    _y.push_back(0.f);
+    _hx.push_back(0.f);
+    _hy.push_back(0.f);
+    _radius.push_back(0.f);
+    // An empty range, so the next fixed update inserts it
+    _ranges.push_back(CellRange_t{0, 0, -1, -1});
+}
+
+void CollisionSystem::remove(Collider* collider)
+{
+    // Move the last collider into the slot of the removed one
+    unsigned int index = collider->_index;
+    unsigned int last = _colliders.size() - 1;
+    eraseCells(index, _ranges[index]);
+    if (index != last)
+    {
+        renameCells(last, index, _ranges[last]);
+        _colliders[index] = _colliders[last];
+        _actors[index] = _actors[last];
+        _x[index] = _x[last];
+        _y[index] = _y[last];
+        _hx[index] = _hx[last];
+        _hy[index] = _hy[last];
+        _radius[index] = _radius[last];
+        _ranges[index] = _ranges[last];
+        _colliders[index]->_index = index;
+    }
+    _colliders.pop_back();
+    _actors.pop_back();
+    _x.pop_back();
+    _y.pop_back();
+    _hx.pop_back();
+    _hy.pop_back();
+    _radius.pop_back();
+    _ranges.pop_back();
+    collider->_index = -1;
+
+    // Its contacts are forgotten at the next fixed update, so no event is reported with a dangling pointer
+    _removed.push_back(collider);
+}
+
+CollisionSystem::CellRange_t CollisionSystem::cellRange(float min_x, float min_y, float max_x, float max_y) const
+{
+    return CellRange_t{
+        static_cast<int>(std::floor(min_x / _cell_size)),
+        static_cast<int>(std::floor(min_y / _cell_size)),
+        static_cast<int>(std::floor(max_x / _cell_size)),
+        static_cast<int>(std::floor(max_y / _cell_size))
+    };
+}
+
+std::uint64_t CollisionSystem::cellKey(int x, int y)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+void CollisionSystem::insertCells(unsigned int index, const CellRange_t& range)
+{
+    for (int y = range.y0; y <= range.y1; ++y)
+    {
+        for (int x = range.x0; x <= range.x1; ++x)
+        {
+            _cells[cellKey(x, y)].push_back(index);
+        }
+    }
+}
+
+void CollisionSystem::eraseCells(unsigned int index, const CellRange_t& range)
+{
+    for (int y = range.y0; y <= range.y1; ++y)
+    {
+        for (int x = range.x0; x <= range.x1; ++x)
+        {
+            auto cell = _cells.find(cellKey(x, y));
+            std::vector<unsigned int>& indices = cell->second;
+            *std::find(indices.begin(), indices.end(), index) = indices.back();
+            indices.pop_back();
+            if (indices.empty())
+            {
+                _cells.erase(cell);
+            }
+        }
+    }
+}
+
+void CollisionSystem::renameCells(unsigned int from, unsigned int to, const CellRange_t& range)
+{
+    for (int y = range.y0; y <= range.y1; ++y)
+    {
+        for (int x = range.x0; x <= range.x1; ++x)
+        {
+            std::vector<unsigned int>& indices = _cells[cellKey(x, y)];
+            *std::find(indices.begin(), indices.end(), from) = to;
+        }
+    }
+}
+
+void CollisionSystem::forEachRange(std::size_t count, std::size_t grain,
+        const std::function<void(std::size_t, std::size_t)>& job)
+{
+    if (_multithreaded && _job_system != nullptr)
+    {
+        _job_system->parallelFor(count, grain, job);
+    }
+    else if (count > 0)
+    {
+        job(0, count);
+    }
+}
+
+void CollisionSystem::gather(std::size_t begin, std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const Collider* collider = _colliders[i];
+        const hum::Transformation& transform = _actors[i]->transform();
+        float scale_x = std::abs(transform.scale.x);
+        float scale_y = std::abs(transform.scale.y);
+        _x[i] = transform.position.x + collider->_offset.x;
+        _y[i] = transform.position.y + collider->_offset.y;
+        _hx[i] = collider->_half_width * scale_x;
+        _hy[i] = collider->_half_height * scale_y;
+        _radius[i] = collider->_radius * std::max(scale_x, scale_y);
+        float extent_x = _hx[i] + _radius[i];
+        float extent_y = _hy[i] + _radius[i];
+        _new_ranges[i] = cellRange(_x[i] - extent_x, _y[i] - extent_y, _x[i] + extent_x, _y[i] + extent_y);
+    }
+}
+
+void CollisionSystem::findPairs(std::size_t begin, std::size_t end, std::vector<Pair_t>& pairs)
+{
+    std::vector<Pair_t> candidates;
+    for (std::size_t c = begin; c < end; ++c)
+    {
+        std::uint64_t key = _cell_list[c]->first;
+        int x = static_cast<std::int32_t>(key >> 32);
+        int y = static_cast<std::int32_t>(key & 0xffffffff);
+        const std::vector<unsigned int>& indices = _cell_list[c]->second;
+        for (std::size_t k = 0; k < indices.size(); ++k)
+        {
+            for (std::size_t l = k + 1; l < indices.size(); ++l)
+            {
+                // Colliders sharing several cells are paired only in the first one
+                const CellRange_t& a = _ranges[indices[k]];
+                const CellRange_t& b = _ranges[indices[l]];
+                if (std::max(a.x0, b.x0) == x && std::max(a.y0, b.y0) == y)
+                {
+                    candidates.push_back(Pair_t{indices[k], indices[l]});
+                }
+            }
+        }
+    }
+    narrowphase(candidates, pairs);
+}
+
+void CollisionSystem::narrowphase(const std::vector<Pair_t>& candidates, std::vector<Pair_t>& pairs) const
+{
+    // Both colliders are boxes grown by a radius, so every combination of
+    // shapes is the same test: the box of summed half sizes grown by the
+    // summed radius around one center contains the other center.
+    std::size_t i = 0;
+#ifdef __SSE2__
+    const __m128 sign_mask = _mm_set1_ps(-0.f);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= candidates.size(); i += 4)
+    {
+        alignas(16) float dx[4], dy[4], hx[4], hy[4], r[4];
+        for (unsigned int k = 0; k < 4; ++k)
+        {
+            unsigned int a = candidates[i + k].a;
+            unsigned int b = candidates[i + k].b;
+            dx[k] = _x[a] - _x[b];
+            dy[k] = _y[a] - _y[b];
+            hx[k] = _hx[a] + _hx[b];
+            hy[k] = _hy[a] + _hy[b];
+            r[k] = _radius[a] + _radius[b];
+        }
+        __m128 ex = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign_mask, _mm_load_ps(dx)), _mm_load_ps(hx)), zero);
+        __m128 ey = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(sign_mask, _mm_load_ps(dy)), _mm_load_ps(hy)), zero);
+        __m128 distance2 = _mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey));
+        __m128 radius = _mm_load_ps(r);
+        int hits = _mm_movemask_ps(_mm_cmple_ps(distance2, _mm_mul_ps(radius, radius)));
+        for (unsigned int k = 0; k < 4; ++k)
+        {
+            if (hits & (1 << k))
+            {
+                pairs.push_back(candidates[i + k]);
+            }
+        }
+    }
+#endif
+    for (; i < candidates.size(); ++i)
+    {
+        unsigned int a = candidates[i].a;
+        unsigned int b = candidates[i].b;
+        if (overlaps(_x[a] - _x[b], _y[a] - _y[b], _hx[a] + _hx[b], _hy[a] + _hy[b], _radius[a] + _radius[b]))
+        {
+            pairs.push_back(candidates[i]);
+        }
+    }
+}
+
+void CollisionSystem::dispatchEvents()
+{
+    // Both lists are sorted, walk them together
+    _begun.clear();
+    _stayed.clear();
+    _ended.clear();
+    auto current = _contacts.begin();
+    auto previous = _previous_contacts.begin();
+    while (current != _contacts.end() || previous != _previous_contacts.end())
+    {
+        if (previous == _previous_contacts.end() || (current != _contacts.end() && contactLess(*current, *previous)))
+        {
+            _begun.push_back(*current++);
+        }
+        else if (current == _contacts.end() || contactLess(*previous, *current))
+        {
+            _ended.push_back(*previous++);
+        }
+        else
+        {
+            _stayed.push_back(*current++);
+            ++previous;
+        }
+    }
+
+    for (const Contact_t& contact : _begun)
+    {
+        if (contact.a->_begin_callback) contact.a->_begin_callback(*contact.b);
+        if (contact.b->_begin_callback) contact.b->_begin_callback(*contact.a);
+    }
+    for (const Contact_t& contact : _stayed)
+    {
+        if (contact.a->_stay_callback) contact.a->_stay_callback(*contact.b);
+        if (contact.b->_stay_callback) contact.b->_stay_callback(*contact.a);
+    }
+    for (const Contact_t& contact : _ended)
+    {
+        if (contact.a->_end_callback) contact.a->_end_callback(*contact.b);
+        if (contact.b->_end_callback) contact.b->_end_callback(*contact.a);
+    }
+}
+
+
+Collider::Collider(float half_width, float half_height, float radius):
+_half_width(half_width),
+_half_height(half_height),
+_radius(radius),
+_system(nullptr),
+_index(-1)
+{}
+
+void Collider::init()
+{
+    try
+    {
+        _system = actor().game().getPlugin<CollisionSystem>();
+    }
+    catch (hum::exception::PluginNotFound e)
+    {
+        hum::log_e("Plugin CollisionSystem not found. Required for Collider.");
+        throw e;
+    }
+    attach();
+}
+
+void Collider::onActivate()
+{
+    attach();
+}
+
+void Collider::onDeactivate()
+{
+    detach();
+}
+
+void Collider::onDestroy()
+{
+    detach();
+}
+
+void Collider::setOffset(const hum::Vector3f& offset)
+{
+    _offset = offset;
+}
+
+const hum::Vector3f& Collider::getOffset() const
+{
+    return _offset;
+}
+
+void Collider::setBeginCallback(const Callback& callback)
+{
+    _begin_callback = callback;
+}
+
+void Collider::setStayCallback(const Callback& callback)
+{
+    _stay_callback = callback;
+}
+
+void Collider::setEndCallback(const Callback& callback)
+{
+    _end_callback = callback;
+}
+
+void Collider::attach()
+{
+    if (_system != nullptr && _index < 0)
+    {
+        _system->add(this);
+    }
+}
+
+void Collider::detach()
+{
+    if (_index >= 0)
+    {
+        _system->remove(this);
+    }
+}
+
+
+BoxCollider::BoxCollider(const hum::Vector3f& size):
+Collider(size.x * 0.5f, size.y * 0.5f, 0.f)
+{}
+
+void BoxCollider::setSize(const hum::Vector3f& size)
+{
+    _half_width = size.x * 0.5f;
+    _half_height = size.y * 0.5f;
+}
+
+hum::Vector3f BoxCollider::getSize() const
+{
+    return hum::Vector3f(_half_width * 2.f, _half_height * 2.f, 0.f);
+}
+
+const char* BoxCollider::behaviorName()
+{
+    return "BoxCollider";
+}
+
+
+CircleCollider::CircleCollider(float radius):
+Collider(0.f, 0.f, radius)
+{}
+
+void CircleCollider::setRadius(float radius)
+{
+    _radius = radius;
+}
+
+float CircleCollider::getRadius() const
+{
+    return _radius;
+}
+
+const char* CircleCollider::behaviorName()
+{
+    return "CircleCollider";
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include "JobSystem.hpp"
+
+namespace
+{
+thread_local bool t_inside_job = false;
+}
+
+JobSystem::JobSystem(unsigned int worker_count):
+_stop(false),
+_generation(0),
+_job(nullptr),
+_count(0),
+_grain(1),
+_next(0),
+_busy(0),
+_running(false)
+{
+    for (unsigned int i = 0; i < worker_count; ++i)
+    {
+        _workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::parallelFor(std::size_t count, std::size_t grain, const RangeJob& job)
+{
+    grain = std::max<std::size_t>(grain, 1);
+    if (t_inside_job || _workers.empty() || count <= grain)
+    {
+        job(0, count);
+        return;
+    }
+
+    // Only one parallelFor at a time; nested or concurrent callers wait here
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] { return !_running; });
+    _job = &job;
+    _count = count;
+    _grain = grain;
+    _next = 0;
+    _busy = _workers.size() + 1;
+    _running = true;
+    ++_generation;
+    lock.unlock();
+    _wake.notify_all();
+
+    runRanges();
+
+    lock.lock();
+    _done.wait(lock, [this] { return _busy == 0; });
+    _running = false;
+    _job = nullptr;
+    lock.unlock();
+    _done.notify_all();
+}
+
+unsigned int JobSystem::threadCount() const
+{
+    return _workers.size() + 1;
+}
+
+unsigned int JobSystem::defaultWorkerCount()
+{
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+void JobSystem::workerLoop()
+{
+    unsigned long long seen = 0;
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.wait(lock, [this, seen] { return _stop || _generation != seen; });
+        if (_stop)
+        {
+            return;
+        }
+        seen = _generation;
+        lock.unlock();
+        runRanges();
+    }
+}
+
+void JobSystem::runRanges()
+{
+    t_inside_job = true;
+    while (true)
+    {
+        std::size_t begin = _next.fetch_add(_grain);
+        if (begin >= _count)
+        {
+            break;
+        }
+        (*_job)(begin, std::min(begin + _grain, _count));
+    }
+    t_inside_job = false;
+
+    if (--_busy == 0)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done.notify_all();
+    }
+}
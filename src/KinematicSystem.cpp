@@ -0,0 +1,343 @@
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "JobSystem.hpp"
+#include "KinematicSystem.hpp"
+
+namespace
+{
+// Integrate the channels <x> and <v> of [begin, end): v += a * dt, x += v * dt
+void integrateChannel(float* x, float* v, const float* a, std::size_t begin, std::size_t end, float dt)
+{
+    std::size_t i = begin;
+#ifdef __SSE2__
+    __m128 v_dt = _mm_set1_ps(dt);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 velocity = _mm_add_ps(_mm_loadu_ps(v + i), _mm_mul_ps(_mm_loadu_ps(a + i), v_dt));
+        _mm_storeu_ps(v + i, velocity);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(velocity, v_dt)));
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        v[i] += a[i] * dt;
+        x[i] += v[i] * dt;
+    }
+}
+
+// Same step as integrateChannel() written to <out>, leaving <x> and <v> untouched
+void interpolateChannel(float* out, const float* x, const float* v, const float* a,
+        std::size_t begin, std::size_t end, float lag)
+{
+    std::size_t i = begin;
+#ifdef __SSE2__
+    __m128 v_lag = _mm_set1_ps(lag);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 velocity = _mm_add_ps(_mm_loadu_ps(v + i), _mm_mul_ps(_mm_loadu_ps(a + i), v_lag));
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(velocity, v_lag)));
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        out[i] = x[i] + (v[i] + a[i] * lag) * lag;
+    }
+}
+}
+
+
+KinematicSystem::KinematicSystem():
+_job_system(nullptr),
+_multithreaded(true),
+_grain(4096),
+_step(0),
+_simulated_step(0),
+_simulated_lag(0),
+_simulated_valid(false)
+{}
+
+void KinematicSystem::gameStart()
+{
+    try
+    {
+        _job_system = game().getPlugin<JobSystem>();
+    }
+    catch (hum::exception::PluginNotFound e)
+    {
+        _job_system = nullptr;
+    }
+}
+
+void KinematicSystem::postFixedUpdate()
+{
+    forEachRange(&KinematicSystem::step, game().fixedUpdateTime().asSeconds());
+    ++_step;
+}
+
+void KinematicSystem::simulate(const hum::Time& lag)
+{
+    long long lag_us = lag.asMicroseconds();
+    if (_simulated_valid && _simulated_step == _step && _simulated_lag == lag_us)
+    {
+        return;
+    }
+    for (unsigned int c = 0; c < CHANNELS; ++c)
+    {
+        _simulated[c].resize(_bodies.size());
+    }
+    forEachRange(&KinematicSystem::interpolate, lag.asSeconds());
+    _simulated_step = _step;
+    _simulated_lag = lag_us;
+    _simulated_valid = true;
+}
+
+std::size_t KinematicSystem::size() const
+{
+    return _bodies.size();
+}
+
+void KinematicSystem::setMultithreaded(bool multithreaded)
+{
+    _multithreaded = multithreaded;
+}
+
+bool KinematicSystem::isMultithreaded() const
+{
+    return _multithreaded;
+}
+
+void KinematicSystem::setGrain(std::size_t grain)
+{
+    _grain = std::max<std::size_t>(grain, 1);
+}
+
+std::size_t KinematicSystem::getGrain() const
+{
+    return _grain;
+}
+
+void KinematicSystem::add(KinematicBody* body, const hum::Transformation& velocity, const hum::Transformation& acceleration)
+{
+    std::size_t index = _bodies.size();
+    _bodies.push_back(body);
+    _actors.push_back(&body->actor());
+    for (unsigned int c = 0; c < CHANNELS; ++c)
+    {
+        _transform[c].push_back(0.f);
+        _velocity[c].push_back(0.f);
+        _acceleration[c].push_back(0.f);
+    }
+    set(_transform, index, body->actor().transform());
+    set(_velocity, index, velocity);
+    set(_acceleration, index, acceleration);
+    body->_index = index;
+    _simulated_valid = false;
+}
+
+void KinematicSystem::remove(KinematicBody* body)
+{
+    // Move the last body into the slot of the removed one
+    std::size_t index = body->_index;
+    std::size_t last = _bodies.size() - 1;
+    if (index != last)
+    {
+        _bodies[index] = _bodies[last];
+        _actors[index] = _actors[last];
+        for (unsigned int c = 0; c < CHANNELS; ++c)
+        {
+            _transform[c][index] = _transform[c][last];
+            _velocity[c][index] = _velocity[c][last];
+            _acceleration[c][index] = _acceleration[c][last];
+        }
+        _bodies[index]->_index = index;
+    }
+    _bodies.pop_back();
+    _actors.pop_back();
+    for (unsigned int c = 0; c < CHANNELS; ++c)
+    {
+        _transform[c].pop_back();
+        _velocity[c].pop_back();
+        _acceleration[c].pop_back();
+    }
+    body->_index = -1;
+    _simulated_valid = false;
+}
+
+hum::Transformation KinematicSystem::get(const Channels& channels, std::size_t index) const
+{
+    hum::Transformation value;
+    value.position = hum::Vector3f(channels[0][index], channels[1][index], channels[2][index]);
+    value.rotation = hum::Vector3f(channels[3][index], channels[4][index], channels[5][index]);
+    value.scale = hum::Vector3f(channels[6][index], channels[7][index], channels[8][index]);
+    return value;
+}
+
+void KinematicSystem::set(Channels& channels, std::size_t index, const hum::Transformation& value)
+{
+    channels[0][index] = value.position.x;
+    channels[1][index] = value.position.y;
+    channels[2][index] = value.position.z;
+    channels[3][index] = value.rotation.x;
+    channels[4][index] = value.rotation.y;
+    channels[5][index] = value.rotation.z;
+    channels[6][index] = value.scale.x;
+    channels[7][index] = value.scale.y;
+    channels[8][index] = value.scale.z;
+}
+
+void KinematicSystem::forEachRange(void (KinematicSystem::*function)(std::size_t, std::size_t, float), float dt)
+{
+    if (_multithreaded && _job_system != nullptr)
+    {
+        _job_system->parallelFor(_bodies.size(), _grain,
+                [this, function, dt](std::size_t begin, std::size_t end) { (this->*function)(begin, end, dt); });
+    }
+    else
+    {
+        (this->*function)(0, _bodies.size(), dt);
+    }
+}
+
+void KinematicSystem::step(std::size_t begin, std::size_t end, float dt)
+{
+    gather(begin, end);
+    for (unsigned int c = 0; c < CHANNELS; ++c)
+    {
+        integrateChannel(_transform[c].data(), _velocity[c].data(), _acceleration[c].data(), begin, end, dt);
+    }
+    scatter(begin, end);
+}
+
+void KinematicSystem::interpolate(std::size_t begin, std::size_t end, float lag)
+{
+    gather(begin, end);
+    for (unsigned int c = 0; c < CHANNELS; ++c)
+    {
+        interpolateChannel(_simulated[c].data(), _transform[c].data(), _velocity[c].data(), _acceleration[c].data(),
+                begin, end, lag);
+    }
+}
+
+void KinematicSystem::gather(std::size_t begin, std::size_t end)
+{
+    // Actors may have been moved by other code since the last step
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        set(_transform, i, _actors[i]->transform());
+    }
+}
+
+void KinematicSystem::scatter(std::size_t begin, std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        _actors[i]->transform() = get(_transform, i);
+    }
+}
+
+
+KinematicBody::KinematicBody():
+_system(nullptr),
+_index(-1)
+{
+    // A Transformation scales by one by default, a rate of change must not
+    _velocity.scale = hum::Vector3f(0, 0, 0);
+    _acceleration.scale = hum::Vector3f(0, 0, 0);
+}
+
+void KinematicBody::init()
+{
+    try
+    {
+        _system = actor().game().getPlugin<KinematicSystem>();
+    }
+    catch (hum::exception::PluginNotFound e)
+    {
+        hum::log_e("Plugin KinematicSystem not found. Required for KinematicBody.");
+        throw e;
+    }
+    attach();
+}
+
+void KinematicBody::onActivate()
+{
+    attach();
+}
+
+void KinematicBody::onDeactivate()
+{
+    detach();
+}
+
+void KinematicBody::onDestroy()
+{
+    detach();
+}
+
+void KinematicBody::setVelocity(const hum::Transformation& velocity)
+{
+    if (_index < 0)
+    {
+        _velocity = velocity;
+    }
+    else
+    {
+        _system->set(_system->_velocity, _index, velocity);
+    }
+}
+
+hum::Transformation KinematicBody::getVelocity() const
+{
+    return _index < 0 ? _velocity : _system->get(_system->_velocity, _index);
+}
+
+void KinematicBody::setAcceleration(const hum::Transformation& acceleration)
+{
+    if (_index < 0)
+    {
+        _acceleration = acceleration;
+    }
+    else
+    {
+        _system->set(_system->_acceleration, _index, acceleration);
+    }
+}
+
+hum::Transformation KinematicBody::getAcceleration() const
+{
+    return _index < 0 ? _acceleration : _system->get(_system->_acceleration, _index);
+}
+
+hum::Transformation KinematicBody::simulated() const
+{
+    if (_index < 0 || !_system->_simulated_valid)
+    {
+        return actor().transform();
+    }
+    return _system->get(_system->_simulated, _index);
+}
+
+const char* KinematicBody::behaviorName()
+{
+    return "KinematicBody";
+}
+
+void KinematicBody::attach()
+{
+    if (_system != nullptr && _index < 0)
+    {
+        _system->add(this, _velocity, _acceleration);
+    }
+}
+
+void KinematicBody::detach()
+{
+    if (_index >= 0)
+    {
+        _velocity = getVelocity();
+        _acceleration = getAcceleration();
+        _system->remove(this);
+    }
+}
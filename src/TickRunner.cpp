@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "TickRunner.hpp"
+
+TickRunner::TickRunner(unsigned long long ticks):
+_max_ticks(ticks),
+_in_tick(false)
+{}
+
+void TickRunner::gameStart()
+{
+    _tick_times.clear();
+    if (_max_ticks > 0)
+    {
+        _tick_times.reserve(_max_ticks);
+    }
+    _in_tick = false;
+}
+
+void TickRunner::preFixedUpdate()
+{
+    // The previous tick ends where this one starts
+    endTick();
+    _in_tick = true;
+    _clock.reset();
+}
+
+void TickRunner::preUpdate()
+{
+    endTick();
+}
+
+void TickRunner::endTick()
+{
+    if (!_in_tick)
+    {
+        return;
+    }
+    _in_tick = false;
+    _tick_times.push_back(_clock.getTime().asMicroseconds() / 1000.f);
+    if (_max_ticks > 0 && _tick_times.size() >= _max_ticks)
+    {
+        game().setRunning(false);
+    }
+}
+
+unsigned long long TickRunner::ticks() const
+{
+    return _tick_times.size();
+}
+
+const std::vector<float>& TickRunner::tickTimes() const
+{
+    return _tick_times;
+}
+
+float TickRunner::mean() const
+{
+    if (_tick_times.empty())
+    {
+        return 0.f;
+    }
+    return std::accumulate(_tick_times.begin(), _tick_times.end(), 0.) / _tick_times.size();
+}
+
+float TickRunner::percentile(float percentile) const
+{
+    if (_tick_times.empty())
+    {
+        return 0.f;
+    }
+    std::vector<float> sorted(_tick_times);
+    std::sort(sorted.begin(), sorted.end());
+    float rank = std::min(std::max(percentile, 0.f), 1.f) * (sorted.size() - 1);
+    return sorted[static_cast<std::size_t>(std::lround(rank))];
+}
+
+float TickRunner::ticksPerSecond() const
+{
+    float tick_ms = mean();
+    return tick_ms > 0.f ? 1000.f / tick_ms : 0.f;
+}
@@ -1,5 +1,10 @@
 #include "hummingbird/hum.hpp"
+#include "AsyncLog.hpp"
+#include "CollisionSystem.hpp"
+#include "JobSystem.hpp"
+#include "KinematicSystem.hpp"
 #include "SDLPlugin.hpp"
+#include "rendering/Archive.hpp"
 #include "rendering/common.hpp"
 #include "rendering/Plugin.hpp"
 #include "rendering/Rectangle.hpp"
@@ -9,11 +14,20 @@
 class PrintPosition : public hum::Behavior
 {
 public:
+    void init() override
+    {
+        // all behaviors have a way to access the actor they are in, and from it the game
+        _log = actor().game().getPlugin<AsyncLog>();
+    }
+
     void fixedUpdate() override
     {
-        // all behaviors have a way to access the actor they are in
-        hum::log_d("Actor ", actor().id(), " position: ", actor().transform().position);
+        // Only copies the arguments, AsyncLog formats and prints them in its own thread
+        _log->log_d("Actor {} position: {}", actor().id(), actor().transform().position);
     }
+
+private:
+    AsyncLog* _log;
 };
 
 
@@ -51,13 +65,25 @@ private:
 
 int main(void)
 {
+    // Serve shaders from the packed archive when it was built (make assets),
+    // otherwise they are read from the shaders/ directory
+    rendering::Archive assets;
+    if (assets.open("assets.pak"))
+    {
+        rendering::Archive::mount(&assets);
+    }
+
     // Create a game instance
     hum::Game game;
 
     // Add a Plugin to the game instance.
-    // In this case KinematicWorld takes care of moving Actors with Kinematic behaviors
-    // The assignment is not needed here. I'm doing it to demonstrate how addPlugin works
-    game.addPlugin<hum::KinematicWorld>();
+    // In this case KinematicSystem takes care of moving Actors with KinematicBody behaviors,
+    // splitting the work across the threads of JobSystem
+    game.addPlugin<JobSystem>();
+    game.addPlugin<KinematicSystem>();
+    // Added after KinematicSystem so it tests the positions of this fixed update
+    game.addPlugin<CollisionSystem>();
+    game.addPlugin<AsyncLog>();
     // Both addPlugin and addBehavior have as arguments whatever the class passed
     // to he template needs for its constructor.
     game.addPlugin<CloseGame>(5);
@@ -67,13 +93,17 @@ int main(void)
 
     // Create a new actor (GameObject). It is stored and managed by a ActorPool in game.
     hum::Actor* actor = game.actors().create();
-    // Add a Kinematic behavior to the actor to give it some speed
-    hum::Kinematic* kinematic = actor->addBehavior<hum::Kinematic>();
-    kinematic->velocity().position.x = 10;
-    kinematic->velocity().position.y = -10;
-    kinematic->velocity().rotation.z = -100;
+    // Add a KinematicBody behavior to the actor to give it some speed
+    KinematicBody* body = actor->addBehavior<KinematicBody>();
+    hum::Transformation velocity = body->getVelocity();
+    velocity.position.x = 10;
+    velocity.position.y = -10;
+    velocity.rotation.z = -100;
+    body->setVelocity(velocity);
     // Add our custom behavior from before
     actor->addBehavior<PrintPosition>();
+    // A unit box scaled with the actor, like the rectangle
+    actor->addBehavior<BoxCollider>(hum::Vector3f(1, 1, 0));
     auto rectangle = actor->addBehavior<rendering::Rectangle>(rendering::Color(0,255,0));
     rectangle->setOrigin(hum::Vector3f(0.5, 0.5, 0));
     actor->transform().position = hum::Vector3f(50, 50, 0);
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef RENDERING_LZ4
+#include <lz4.h>
+#endif
+#include "hummingbird/hum.hpp"
+#include "rendering/Archive.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Whether [offset, offset + size) lies in [0, limit), without overflowing
+bool inRange(std::uint64_t offset, std::uint64_t size, std::uint64_t limit)
+{
+    return offset <= limit && size <= limit - offset;
+}
+
+// LZ4 can't compress by more than this ratio
+const std::uint64_t LZ4_MAX_RATIO = 255;
+}
+
+std::vector<Archive*> Archive::_mounted;
+
+Archive::Archive():
+_mapping(nullptr),
+_mapping_size(0),
+_header(nullptr),
+_table(nullptr),
+_names(nullptr)
+{}
+
+Archive::~Archive()
+{
+    unmount(this);
+    close();
+}
+
+bool Archive::open(const std::string& filename)
+{
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        hum::log_e("Unable to open archive ", filename);
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < sizeof(archive_format::Header))
+    {
+        hum::log_e("Archive ", filename, " is too small");
+        ::close(fd);
+        return false;
+    }
+    _mapping_size = file_stat.st_size;
+    _mapping = mmap(nullptr, _mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (_mapping == MAP_FAILED)
+    {
+        hum::log_e("Unable to map archive ", filename);
+        _mapping = nullptr;
+        _mapping_size = 0;
+        return false;
+    }
+
+    const char* bytes = static_cast<const char*>(_mapping);
+    const archive_format::Header* header = reinterpret_cast<const archive_format::Header*>(bytes);
+    bool valid = header->magic == archive_format::MAGIC && header->version == archive_format::VERSION
+        && header->table_size != 0 && (header->table_size & (header->table_size - 1)) == 0
+        && inRange(header->table_offset, std::uint64_t(header->table_size) * sizeof(archive_format::Entry), _mapping_size)
+        && header->names_offset <= _mapping_size;
+    // Every used entry must point inside the file, get() and find() don't check
+    const archive_format::Entry* table = reinterpret_cast<const archive_format::Entry*>(bytes + header->table_offset);
+    for (std::uint32_t i = 0; valid && i < header->table_size; ++i)
+    {
+        const archive_format::Entry& entry = table[i];
+        if (entry.flags & archive_format::FLAG_USED)
+        {
+            valid = inRange(entry.offset, entry.size, _mapping_size)
+                && inRange(header->names_offset + entry.name_offset, entry.name_size, _mapping_size)
+                && (!(entry.flags & archive_format::FLAG_LZ4) || entry.original_size <= entry.size * LZ4_MAX_RATIO);
+        }
+    }
+    if (!valid)
+    {
+        hum::log_e("Archive ", filename, " is not a valid archive");
+        munmap(_mapping, _mapping_size);
+        _mapping = nullptr;
+        _mapping_size = 0;
+        return false;
+    }
+    _header = header;
+    _table = table;
+    _names = bytes + header->names_offset;
+    return true;
+}
+
+void Archive::close()
+{
+    _decompressed.clear();
+    if (_mapping != nullptr)
+    {
+        munmap(_mapping, _mapping_size);
+    }
+    _mapping = nullptr;
+    _mapping_size = 0;
+    _header = nullptr;
+    _table = nullptr;
+    _names = nullptr;
+}
+
+bool Archive::isOpen() const
+{
+    return _mapping != nullptr;
+}
+
+bool Archive::contains(std::string_view name) const
+{
+    return find(name) != nullptr;
+}
+
+std::string_view Archive::get(std::string_view name)
+{
+    const archive_format::Entry* entry = find(name);
+    if (entry == nullptr)
+    {
+        return std::string_view();
+    }
+    const char* data = static_cast<const char*>(_mapping) + entry->offset;
+    if (!(entry->flags & archive_format::FLAG_LZ4))
+    {
+        return std::string_view(data, entry->size);
+    }
+
+    auto it = _decompressed.find(entry);
+    if (it != _decompressed.end())
+    {
+        return std::string_view(it->second.get(), entry->original_size);
+    }
+#ifdef RENDERING_LZ4
+    std::unique_ptr<char[]> buffer(new char[entry->original_size]);
+    int size = LZ4_decompress_safe(data, buffer.get(), entry->size, entry->original_size);
+    if (size < 0 || static_cast<std::uint64_t>(size) != entry->original_size)
+    {
+        hum::log_e("Archive entry ", name, " is corrupted");
+        return std::string_view();
+    }
+    std::string_view view(buffer.get(), entry->original_size);
+    _decompressed.emplace(entry, std::move(buffer));
+    return view;
+#else
+    hum::log_e("Archive entry ", name, " is LZ4 compressed, build with LZ4=1 to read it");
+    return std::string_view();
+#endif
+}
+
+std::size_t Archive::size() const
+{
+    return _header != nullptr ? _header->entry_count : 0;
+}
+
+void Archive::mount(Archive* archive)
+{
+    unmount(archive);
+    _mounted.push_back(archive);
+}
+
+void Archive::unmount(Archive* archive)
+{
+    _mounted.erase(std::remove(_mounted.begin(), _mounted.end(), archive), _mounted.end());
+}
+
+std::string_view Archive::findMounted(std::string_view name)
+{
+    for (auto it = _mounted.rbegin(); it != _mounted.rend(); ++it)
+    {
+        if ((*it)->contains(name))
+        {
+            return (*it)->get(name);
+        }
+    }
+    return std::string_view();
+}
+
+const archive_format::Entry* Archive::find(std::string_view name) const
+{
+    if (_header == nullptr)
+    {
+        return nullptr;
+    }
+    std::uint64_t hash = archive_format::hash(name.data(), name.size());
+    std::uint32_t mask = _header->table_size - 1;
+    for (std::uint32_t probe = 0; probe < _header->table_size; ++probe)
+    {
+        const archive_format::Entry& entry = _table[(hash + probe) & mask];
+        if (!(entry.flags & archive_format::FLAG_USED))
+        {
+            return nullptr;
+        }
+        if (entry.hash == hash && entry.name_size == name.size()
+                && std::memcmp(_names + entry.name_offset, name.data(), name.size()) == 0)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+}
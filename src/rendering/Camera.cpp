@@ -62,6 +62,26 @@ const glm::mat4& Camera::getView()
     return _view;
 }
 
+void Camera::getFrustumPlanes(glm::vec4 planes[6])
+{
+    // From the rows of the view projection matrix
+    glm::mat4 view_projection = getProjection() * getView();
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        row[i] = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        planes[2 * i] = row[3] + row[i];
+        planes[2 * i + 1] = row[3] - row[i];
+    }
+    for (int i = 0; i < 6; ++i)
+    {
+        planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+    }
+}
+
 void Camera::setPosition(const hum::Vector3f& position)
 {
     _view_changed = true;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "rendering/Drawable.hpp"
 #include "rendering/Plugin.hpp"
 
@@ -5,8 +6,17 @@ namespace rendering
 {
 Drawable::Drawable():
 _is_enabled(true),
+_is_static(false),
+_transform_changed(true),
 _origin(0.0),
-_shader_program(nullptr)
+_shader_program(nullptr),
+_parent(nullptr),
+_bounds_center(0.0),
+_bounds_radius(0.f),
+_lod_owner(nullptr),
+_lod_level(0),
+_impostor_color(255, 255, 255),
+_impostor_screen_size(0.f)
 {}
 
 Drawable::~Drawable()
@@ -14,6 +24,7 @@ Drawable::~Drawable()
 
 void Drawable::init()
 {
+    actor().game().getPlugin<Plugin>()->addNode(this);
     if (_is_enabled)
     {
         actor().game().getPlugin<Plugin>()->addDrawable(this);
@@ -33,6 +44,27 @@ void Drawable::onDeactivate()
 void Drawable::onDestroy()
 {
     disable();
+    // Orphans fall back to their own hum::Actor
+    std::vector<Drawable*> children = _children;
+    for (Drawable* child : children)
+    {
+        child->setParent(nullptr);
+    }
+    setParent(nullptr);
+    for (LevelOfDetail_t& level : _levels)
+    {
+        level.drawable->_lod_owner = nullptr;
+    }
+    _levels.clear();
+    if (_lod_owner != nullptr)
+    {
+        std::vector<LevelOfDetail_t>& levels = _lod_owner->_levels;
+        levels.erase(std::remove_if(levels.begin(), levels.end(),
+                    [this](const LevelOfDetail_t& level) { return level.drawable == this; }), levels.end());
+        _lod_owner->_lod_level = 0;
+        _lod_owner = nullptr;
+    }
+    actor().game().getPlugin<Plugin>()->removeNode(this);
 }
 
 void Drawable::enable()
@@ -58,8 +90,19 @@ bool Drawable::isEnabled() const
     return _is_enabled;
 }
 
+void Drawable::setStatic(bool is_static)
+{
+    _is_static = is_static;
+}
+
+bool Drawable::isStatic() const
+{
+    return _is_static;
+}
+
 hum::Transformation& Drawable::transform()
 {
+    _transform_changed = true;
     return _transform;
 }
 
@@ -68,6 +111,41 @@ const hum::Transformation& Drawable::transform() const
     return _transform;
 }
 
+void Drawable::setParent(Drawable* parent)
+{
+    if (parent == _parent)
+    {
+        return;
+    }
+    for (Drawable* ancestor = parent; ancestor != nullptr; ancestor = ancestor->_parent)
+    {
+        hum::assert_msg(ancestor != this, "A Drawable can't be attached to one of its descendants");
+    }
+
+    if (_parent != nullptr)
+    {
+        std::vector<Drawable*>& siblings = _parent->_children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+    }
+    _parent = parent;
+    if (_parent != nullptr)
+    {
+        _parent->_children.push_back(this);
+    }
+    _transform_changed = true;
+    actor().game().getPlugin<Plugin>()->invalidateHierarchy();
+}
+
+Drawable* Drawable::getParent() const
+{
+    return _parent;
+}
+
+const std::vector<Drawable*>& Drawable::children() const
+{
+    return _children;
+}
+
 void Drawable::setShaderProgram(ShaderProgram* shader_program)
 {
     _shader_program = shader_program;
@@ -86,6 +164,7 @@ const ShaderProgram* Drawable::shaderProgram() const
 void Drawable::setOrigin(const hum::Vector3f& origin)
 {
     _origin = origin;
+    _transform_changed = true;
 }
 
 const hum::Vector3f& Drawable::getOrigin() const
@@ -93,6 +172,64 @@ const hum::Vector3f& Drawable::getOrigin() const
     return _origin;
 }
 
+void Drawable::setBounds(const hum::Vector3f& center, float radius)
+{
+    _bounds_center = center;
+    _bounds_radius = radius;
+}
+
+const hum::Vector3f& Drawable::getBoundsCenter() const
+{
+    return _bounds_center;
+}
+
+float Drawable::getBoundsRadius() const
+{
+    return _bounds_radius;
+}
+
+void Drawable::addLevelOfDetail(Drawable* level, float screen_size)
+{
+    hum::assert_msg(level->_lod_owner == nullptr, "A Drawable can only be a level of detail of one Drawable");
+    level->setParent(this);
+    level->_lod_owner = this;
+    auto it = std::find_if(_levels.begin(), _levels.end(),
+            [screen_size](const LevelOfDetail_t& other) { return other.screen_size < screen_size; });
+    _levels.insert(it, LevelOfDetail_t{level, screen_size});
+    _lod_level = 0;
+}
+
+void Drawable::setImpostor(const Color& color, float screen_size)
+{
+    _impostor_color = color;
+    _impostor_screen_size = screen_size;
+}
+
+unsigned int Drawable::levelOfDetail() const
+{
+    return _lod_level;
+}
+
+bool Drawable::unitQuadMaterial(unsigned int& material) const
+{
+    return false;
+}
+
+bool Drawable::coversUnitQuad(bool& opaque) const
+{
+    return false;
+}
+
+Texture* Drawable::texture() const
+{
+    return nullptr;
+}
+
+bool Drawable::isHeadless() const
+{
+    return actor().game().getPlugin<Plugin>()->isHeadless();
+}
+
 const char* Drawable::behaviorName()
 {
     return "rendering::Drawable";
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include "rendering/DynamicResolution.hpp"
+
+namespace rendering
+{
+namespace
+{
+const float SMOOTHING = 0.1f;
+const float MAX_STEP_UP = 0.05f;
+}
+
+DynamicResolution::DynamicResolution():
+_target(16.f),
+_min_scale(0.5f),
+_max_scale(1.f),
+_headroom(0.1f),
+_scale(1.f),
+_smoothed(-1.f)
+{}
+
+void DynamicResolution::setTargetFrameTime(float milliseconds)
+{
+    _target = milliseconds;
+}
+
+float DynamicResolution::getTargetFrameTime() const
+{
+    return _target;
+}
+
+void DynamicResolution::setScaleBounds(float min_scale, float max_scale)
+{
+    _max_scale = std::min(std::max(max_scale, 0.01f), 1.f);
+    _min_scale = std::min(std::max(min_scale, 0.01f), _max_scale);
+    _scale = std::min(std::max(_scale, _min_scale), _max_scale);
+}
+
+float DynamicResolution::getMinScale() const
+{
+    return _min_scale;
+}
+
+float DynamicResolution::getMaxScale() const
+{
+    return _max_scale;
+}
+
+void DynamicResolution::setHeadroom(float headroom)
+{
+    _headroom = headroom;
+}
+
+float DynamicResolution::update(float gpu_milliseconds)
+{
+    if (gpu_milliseconds < 0.f)
+    {
+        return _scale;
+    }
+
+    if (_smoothed < 0.f)
+    {
+        _smoothed = gpu_milliseconds;
+    }
+    else
+    {
+        _smoothed += (gpu_milliseconds - _smoothed) * SMOOTHING;
+    }
+
+    if (_smoothed > _target * (1.f + _headroom))
+    {
+        _scale *= std::sqrt(_target / _smoothed);
+        // The next measurements still belong to the old resolution
+        _smoothed = _target;
+    }
+    else if (_smoothed < _target * (1.f - _headroom))
+    {
+        _scale += std::min(MAX_STEP_UP, _scale * (std::sqrt(_target / _smoothed) - 1.f));
+    }
+    _scale = std::min(std::max(_scale, _min_scale), _max_scale);
+    return _scale;
+}
+
+float DynamicResolution::scale() const
+{
+    return _scale;
+}
+
+float DynamicResolution::smoothedFrameTime() const
+{
+    return _smoothed;
+}
+}
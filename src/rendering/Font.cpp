@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cmath>
+#include "hummingbird/hum.hpp"
+#include "rendering/Archive.hpp"
+#include "rendering/Font.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Signed distance field of the alpha mask <alpha> (w x h), written with a
+// border of <spread> pixels into <field> ((w + 2 * spread) x (h + 2 * spread)).
+void computeDistanceField(const std::vector<unsigned char>& alpha, int w, int h, int spread,
+        std::vector<unsigned char>& field)
+{
+    int field_w = w + 2 * spread;
+    int field_h = h + 2 * spread;
+    field.assign(field_w * field_h, 0);
+    auto inside = [&](int x, int y)
+    {
+        return x >= 0 && y >= 0 && x < w && y < h && alpha[y * w + x] >= 128;
+    };
+
+    for (int fy = 0; fy < field_h; ++fy)
+    {
+        for (int fx = 0; fx < field_w; ++fx)
+        {
+            int x = fx - spread;
+            int y = fy - spread;
+            bool is_inside = inside(x, y);
+            int best = spread * spread;
+            for (int dy = -spread; dy <= spread; ++dy)
+            {
+                for (int dx = -spread; dx <= spread; ++dx)
+                {
+                    int distance = dx * dx + dy * dy;
+                    if (distance < best && inside(x + dx, y + dy) != is_inside)
+                    {
+                        best = distance;
+                    }
+                }
+            }
+            float signed_distance = std::sqrt(static_cast<float>(best)) * (is_inside ? 1.f : -1.f);
+            float value = 0.5f + 0.5f * signed_distance / spread;
+            field[fy * field_w + fx] = static_cast<unsigned char>(std::min(std::max(value, 0.f), 1.f) * 255.f);
+        }
+    }
+}
+}
+
+Font::Font():
+_font(nullptr),
+_shelf_x(0),
+_shelf_y(0),
+_shelf_height(0),
+_line_height(1.f)
+{}
+
+Font::~Font()
+{
+    if (_font != nullptr)
+    {
+        TTF_CloseFont(_font);
+    }
+    if (!_pages.empty())
+    {
+        glDeleteTextures(_pages.size(), _pages.data());
+    }
+}
+
+bool Font::loadFromFile(const std::string& filename)
+{
+    if (!TTF_WasInit() && TTF_Init() != 0)
+    {
+        hum::log_e("Unable to initialize SDL_ttf: ", TTF_GetError());
+        return false;
+    }
+    std::string_view packed = Archive::findMounted(filename);
+    if (packed.data() != nullptr)
+    {
+        // SDL_ttf reads the font while rendering glyphs, straight from the archive
+        _font = TTF_OpenFontRW(SDL_RWFromConstMem(packed.data(), packed.size()), 1, BASE_SIZE);
+    }
+    else
+    {
+        _font = TTF_OpenFont(filename.c_str(), BASE_SIZE);
+    }
+    if (_font == nullptr)
+    {
+        hum::log_e("Unable to open font ", filename, ": ", TTF_GetError());
+        return false;
+    }
+    _line_height = static_cast<float>(TTF_FontLineSkip(_font)) / BASE_SIZE;
+    return true;
+}
+
+const Font::Glyph& Font::glyph(unsigned int code_point)
+{
+    auto it = _glyphs.find(code_point);
+    if (it != _glyphs.end())
+    {
+        return it->second;
+    }
+    hum::assert_msg(_font != nullptr, "rendering::Font used before loading it");
+
+    Glyph glyph{0, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+    int min_x, max_x, min_y, max_y, advance;
+    Uint16 character = code_point > 0xFFFF || !TTF_GlyphIsProvided(_font, code_point) ? '?' : code_point;
+    TTF_GlyphMetrics(_font, character, &min_x, &max_x, &min_y, &max_y, &advance);
+    glyph.advance = static_cast<float>(advance) / BASE_SIZE;
+
+    SDL_Surface* surface = TTF_RenderGlyph_Blended(_font, character, SDL_Color{255, 255, 255, 255});
+    if (surface == nullptr || max_x <= min_x || max_y <= min_y)
+    {
+        // Nothing to draw (e.g. a space), only the advance matters
+        if (surface != nullptr)
+        {
+            SDL_FreeSurface(surface);
+        }
+        return _glyphs.emplace(code_point, glyph).first->second;
+    }
+
+    // Blended glyphs are ARGB8888 boxes of (advance x font height) with the pen at the origin
+    std::vector<unsigned char> alpha(surface->w * surface->h);
+    SDL_LockSurface(surface);
+    for (int y = 0; y < surface->h; ++y)
+    {
+        const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < surface->w; ++x)
+        {
+            alpha[y * surface->w + x] = (row[x] >> 24) & 0xFF;
+        }
+    }
+    SDL_UnlockSurface(surface);
+    int w = surface->w;
+    int h = surface->h;
+    SDL_FreeSurface(surface);
+
+    std::vector<unsigned char> field;
+    computeDistanceField(alpha, w, h, SPREAD, field);
+    int field_w = w + 2 * SPREAD;
+    int field_h = h + 2 * SPREAD;
+    hum::assert_msg(field_w <= PAGE_SIZE && field_h <= PAGE_SIZE, "Glyph does not fit in a font atlas page");
+
+    // Shelf packing: next to the previous glyph, on a new shelf or on a new page
+    if (_pages.empty())
+    {
+        addPage();
+    }
+    if (_shelf_x + field_w > PAGE_SIZE)
+    {
+        _shelf_x = 0;
+        _shelf_y += _shelf_height;
+        _shelf_height = 0;
+    }
+    if (_shelf_y + field_h > PAGE_SIZE)
+    {
+        addPage();
+    }
+
+    glBindTexture(GL_TEXTURE_2D, _pages.back());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, _shelf_x, _shelf_y, field_w, field_h, GL_RED, GL_UNSIGNED_BYTE, field.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glyph.page = _pages.size() - 1;
+    glyph.u0 = static_cast<float>(_shelf_x) / PAGE_SIZE;
+    glyph.v0 = static_cast<float>(_shelf_y) / PAGE_SIZE;
+    glyph.u1 = static_cast<float>(_shelf_x + field_w) / PAGE_SIZE;
+    glyph.v1 = static_cast<float>(_shelf_y + field_h) / PAGE_SIZE;
+    glyph.x = static_cast<float>(-SPREAD) / BASE_SIZE;
+    glyph.y = static_cast<float>(-SPREAD) / BASE_SIZE;
+    glyph.width = static_cast<float>(field_w) / BASE_SIZE;
+    glyph.height = static_cast<float>(field_h) / BASE_SIZE;
+
+    _shelf_x += field_w;
+    _shelf_height = std::max(_shelf_height, field_h);
+    return _glyphs.emplace(code_point, glyph).first->second;
+}
+
+float Font::lineHeight() const
+{
+    return _line_height;
+}
+
+GLuint Font::pageTexture(unsigned int page) const
+{
+    return _pages[page];
+}
+
+unsigned int Font::pageCount() const
+{
+    return _pages.size();
+}
+
+void Font::addPage()
+{
+    GLuint texture;
+    std::vector<unsigned char> empty(PAGE_SIZE * PAGE_SIZE, 0);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, PAGE_SIZE, PAGE_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, empty.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    _pages.push_back(texture);
+    _shelf_x = 0;
+    _shelf_y = 0;
+    _shelf_height = 0;
+}
+}
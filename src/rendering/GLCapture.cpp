@@ -0,0 +1,872 @@
+#include "rendering/GLCapture.hpp"
+#include "hummingbird/hum.hpp"
+
+#ifdef RENDERING_GL_CAPTURE
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dlfcn.h>
+#include <GL/glew.h>
+#include "rendering/GLTraceFormat.hpp"
+
+namespace
+{
+using rendering::gl_trace_format::Op;
+
+// Bytes written to the file at once
+const std::size_t FLUSH_SIZE = 1 << 20;
+
+// A glMapBufferRange() in progress: the caller writes to the shadow copy,
+// which goes to the trace and to the real mapping when unmapped.
+struct Mapping_t {
+    GLenum target;
+    GLintptr offset;
+    GLsizeiptr length;
+    GLbitfield access;
+    void* pointer;
+    std::vector<char> shadow;
+};
+
+struct Capture_t {
+    std::FILE* file = nullptr;
+    std::string filename;
+    std::vector<char> buffer;
+    std::size_t record_start = 0;
+    unsigned int first_frame = 0, frame_count = 0, frame = 0;
+    bool context_ready = false, installed = false, recording = false;
+    GLint unpack_alignment = 4;
+    std::vector<Mapping_t> mappings;
+
+    ~Capture_t()
+    {
+        rendering::GLCapture::stop();
+    }
+};
+Capture_t s_capture;
+
+bool shouldRecord(Op op)
+{
+    // The frames before the first one only rebuild the objects
+    return s_capture.recording && (s_capture.frame >= s_capture.first_frame || !rendering::gl_trace_format::isDraw(op));
+}
+
+void append(const void* data, std::size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    s_capture.buffer.insert(s_capture.buffer.end(), bytes, bytes + size);
+}
+
+void flush()
+{
+    std::fwrite(s_capture.buffer.data(), 1, s_capture.buffer.size(), s_capture.file);
+    s_capture.buffer.clear();
+}
+
+void begin(Op op)
+{
+    s_capture.record_start = s_capture.buffer.size();
+    rendering::gl_trace_format::Record record = {static_cast<std::uint16_t>(op), 0, 0};
+    append(&record, sizeof(record));
+}
+
+void end()
+{
+    std::uint32_t size = s_capture.buffer.size() - s_capture.record_start - sizeof(rendering::gl_trace_format::Record);
+    std::memcpy(&s_capture.buffer[s_capture.record_start + offsetof(rendering::gl_trace_format::Record, size)],
+            &size, sizeof(size));
+    if (s_capture.buffer.size() >= FLUSH_SIZE)
+    {
+        flush();
+    }
+}
+
+void put(std::uint32_t value)
+{
+    append(&value, sizeof(value));
+}
+
+void put(std::int32_t value)
+{
+    append(&value, sizeof(value));
+}
+
+void put(float value)
+{
+    append(&value, sizeof(value));
+}
+
+void put(GLboolean value)
+{
+    put(static_cast<std::uint32_t>(value));
+}
+
+void put64(std::uint64_t value)
+{
+    put(static_cast<std::uint32_t>(value));
+    put(static_cast<std::uint32_t>(value >> 32));
+}
+
+void blob(const void* data, std::size_t size)
+{
+    if (data == nullptr)
+    {
+        size = 0;
+    }
+    put(static_cast<std::uint32_t>(size));
+    append(data, size);
+    static const char padding[4] = {0, 0, 0, 0};
+    append(padding, (4 - size % 4) % 4);
+}
+
+template <typename... Args>
+void record(Op op, Args... args)
+{
+    if (!shouldRecord(op))
+    {
+        return;
+    }
+    begin(op);
+    (put(args), ...);
+    end();
+}
+
+void recordNames(Op op, GLsizei n, const GLuint* names)
+{
+    if (!shouldRecord(op))
+    {
+        return;
+    }
+    begin(op);
+    put(n);
+    append(names, n * sizeof(GLuint));
+    end();
+}
+
+void recordLookup(Op op, GLuint program, GLint location, const GLchar* name)
+{
+    if (!shouldRecord(op))
+    {
+        return;
+    }
+    begin(op);
+    put(program);
+    put(location);
+    blob(name, std::strlen(name) + 1);
+    end();
+}
+
+template <typename F>
+F systemFunction(const char* name)
+{
+    F function = reinterpret_cast<F>(dlsym(RTLD_NEXT, name));
+    if (function == nullptr)
+    {
+        std::fprintf(stderr, "GLCapture: %s not found\n", name);
+        std::abort();
+    }
+    return function;
+}
+
+// Functions loaded by GLEW, hooked by swapping its pointers
+#define GLCAPTURE_GLEW_FUNCTIONS(X) \
+    X(BindBuffer) X(BindBufferBase) X(GenBuffers) X(DeleteBuffers) X(BufferData) X(BufferSubData) \
+    X(MapBufferRange) X(UnmapBuffer) \
+    X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray) X(EnableVertexAttribArray) \
+    X(VertexAttribPointer) X(VertexAttribIPointer) X(VertexAttribDivisor) X(ActiveTexture) \
+    X(GenFramebuffers) X(DeleteFramebuffers) X(BindFramebuffer) X(FramebufferTexture2D) \
+    X(FramebufferRenderbuffer) X(DrawBuffers) X(BlitFramebuffer) \
+    X(GenRenderbuffers) X(DeleteRenderbuffers) X(BindRenderbuffer) X(RenderbufferStorage) \
+    X(CreateShader) X(DeleteShader) X(ShaderSource) X(CompileShader) X(CreateProgram) X(DeleteProgram) \
+    X(AttachShader) X(BindAttribLocation) X(LinkProgram) X(UseProgram) \
+    X(GetUniformLocation) X(GetAttribLocation) X(GetUniformBlockIndex) X(UniformBlockBinding) \
+    X(Uniform1i) X(Uniform1f) X(Uniform2f) X(Uniform3f) X(Uniform4f) X(UniformMatrix4fv) \
+    X(DrawArraysInstanced)
+
+#define GLCAPTURE_DECLARE_REAL(name) decltype(__glew##name) real_##name = nullptr;
+GLCAPTURE_GLEW_FUNCTIONS(GLCAPTURE_DECLARE_REAL)
+#undef GLCAPTURE_DECLARE_REAL
+
+
+void GLAPIENTRY hooked_BindBuffer(GLenum target, GLuint buffer)
+{
+    record(Op::BIND_BUFFER, target, buffer);
+    real_BindBuffer(target, buffer);
+}
+
+void GLAPIENTRY hooked_BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    record(Op::BIND_BUFFER_BASE, target, index, buffer);
+    real_BindBufferBase(target, index, buffer);
+}
+
+void GLAPIENTRY hooked_GenBuffers(GLsizei n, GLuint* buffers)
+{
+    real_GenBuffers(n, buffers);
+    recordNames(Op::GEN_BUFFERS, n, buffers);
+}
+
+void GLAPIENTRY hooked_DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    recordNames(Op::DELETE_BUFFERS, n, buffers);
+    real_DeleteBuffers(n, buffers);
+}
+
+void GLAPIENTRY hooked_BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    if (shouldRecord(Op::BUFFER_DATA))
+    {
+        begin(Op::BUFFER_DATA);
+        put(target);
+        put64(size);
+        put(usage);
+        blob(data, size);
+        end();
+    }
+    real_BufferData(target, size, data, usage);
+}
+
+void GLAPIENTRY hooked_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    if (shouldRecord(Op::BUFFER_SUB_DATA))
+    {
+        begin(Op::BUFFER_SUB_DATA);
+        put(target);
+        put64(offset);
+        put64(size);
+        blob(data, size);
+        end();
+    }
+    real_BufferSubData(target, offset, size, data);
+}
+
+void* GLAPIENTRY hooked_MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    void* pointer = real_MapBufferRange(target, offset, length, access);
+    if (pointer == nullptr || !shouldRecord(Op::MAP_WRITE))
+    {
+        return pointer;
+    }
+    s_capture.mappings.push_back({target, offset, length, access, pointer, std::vector<char>(length)});
+    Mapping_t& mapping = s_capture.mappings.back();
+    if (access & GL_MAP_READ_BIT)
+    {
+        std::memcpy(mapping.shadow.data(), pointer, length);
+    }
+    return mapping.shadow.data();
+}
+
+GLboolean GLAPIENTRY hooked_UnmapBuffer(GLenum target)
+{
+    auto it = std::find_if(s_capture.mappings.begin(), s_capture.mappings.end(),
+            [target](const Mapping_t& mapping) { return mapping.target == target; });
+    if (it != s_capture.mappings.end())
+    {
+        std::memcpy(it->pointer, it->shadow.data(), it->length);
+        if ((it->access & GL_MAP_WRITE_BIT) && shouldRecord(Op::MAP_WRITE))
+        {
+            begin(Op::MAP_WRITE);
+            put(it->target);
+            put64(it->offset);
+            put64(it->length);
+            put(it->access);
+            blob(it->shadow.data(), it->length);
+            end();
+        }
+        s_capture.mappings.erase(it);
+    }
+    return real_UnmapBuffer(target);
+}
+
+void GLAPIENTRY hooked_GenVertexArrays(GLsizei n, GLuint* arrays)
+{
+    real_GenVertexArrays(n, arrays);
+    recordNames(Op::GEN_VERTEX_ARRAYS, n, arrays);
+}
+
+void GLAPIENTRY hooked_DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    recordNames(Op::DELETE_VERTEX_ARRAYS, n, arrays);
+    real_DeleteVertexArrays(n, arrays);
+}
+
+void GLAPIENTRY hooked_BindVertexArray(GLuint array)
+{
+    record(Op::BIND_VERTEX_ARRAY, array);
+    real_BindVertexArray(array);
+}
+
+void GLAPIENTRY hooked_EnableVertexAttribArray(GLuint index)
+{
+    record(Op::ENABLE_VERTEX_ATTRIB_ARRAY, index);
+    real_EnableVertexAttribArray(index);
+}
+
+void GLAPIENTRY hooked_VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized,
+        GLsizei stride, const void* pointer)
+{
+    if (shouldRecord(Op::VERTEX_ATTRIB_POINTER))
+    {
+        begin(Op::VERTEX_ATTRIB_POINTER);
+        put(index);
+        put(size);
+        put(type);
+        put(normalized);
+        put(stride);
+        // An offset in the bound GL_ARRAY_BUFFER
+        put64(reinterpret_cast<std::uintptr_t>(pointer));
+        end();
+    }
+    real_VertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void GLAPIENTRY hooked_VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride,
+        const void* pointer)
+{
+    if (shouldRecord(Op::VERTEX_ATTRIB_I_POINTER))
+    {
+        begin(Op::VERTEX_ATTRIB_I_POINTER);
+        put(index);
+        put(size);
+        put(type);
+        put(stride);
+        put64(reinterpret_cast<std::uintptr_t>(pointer));
+        end();
+    }
+    real_VertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+void GLAPIENTRY hooked_VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    record(Op::VERTEX_ATTRIB_DIVISOR, index, divisor);
+    real_VertexAttribDivisor(index, divisor);
+}
+
+void GLAPIENTRY hooked_ActiveTexture(GLenum texture)
+{
+    record(Op::ACTIVE_TEXTURE, texture);
+    real_ActiveTexture(texture);
+}
+
+void GLAPIENTRY hooked_GenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    real_GenFramebuffers(n, framebuffers);
+    recordNames(Op::GEN_FRAMEBUFFERS, n, framebuffers);
+}
+
+void GLAPIENTRY hooked_DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    recordNames(Op::DELETE_FRAMEBUFFERS, n, framebuffers);
+    real_DeleteFramebuffers(n, framebuffers);
+}
+
+void GLAPIENTRY hooked_BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    record(Op::BIND_FRAMEBUFFER, target, framebuffer);
+    real_BindFramebuffer(target, framebuffer);
+}
+
+void GLAPIENTRY hooked_FramebufferTexture2D(GLenum target, GLenum attachment, GLenum texture_target,
+        GLuint texture, GLint level)
+{
+    record(Op::FRAMEBUFFER_TEXTURE_2D, target, attachment, texture_target, texture, level);
+    real_FramebufferTexture2D(target, attachment, texture_target, texture, level);
+}
+
+void GLAPIENTRY hooked_FramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffer_target,
+        GLuint renderbuffer)
+{
+    record(Op::FRAMEBUFFER_RENDERBUFFER, target, attachment, renderbuffer_target, renderbuffer);
+    real_FramebufferRenderbuffer(target, attachment, renderbuffer_target, renderbuffer);
+}
+
+void GLAPIENTRY hooked_DrawBuffers(GLsizei n, const GLenum* buffers)
+{
+    recordNames(Op::DRAW_BUFFERS, n, buffers);
+    real_DrawBuffers(n, buffers);
+}
+
+void GLAPIENTRY hooked_BlitFramebuffer(GLint src_x0, GLint src_y0, GLint src_x1, GLint src_y1,
+        GLint dst_x0, GLint dst_y0, GLint dst_x1, GLint dst_y1, GLbitfield mask, GLenum filter)
+{
+    record(Op::BLIT_FRAMEBUFFER, src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter);
+    real_BlitFramebuffer(src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter);
+}
+
+void GLAPIENTRY hooked_GenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+    real_GenRenderbuffers(n, renderbuffers);
+    recordNames(Op::GEN_RENDERBUFFERS, n, renderbuffers);
+}
+
+void GLAPIENTRY hooked_DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+{
+    recordNames(Op::DELETE_RENDERBUFFERS, n, renderbuffers);
+    real_DeleteRenderbuffers(n, renderbuffers);
+}
+
+void GLAPIENTRY hooked_BindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    record(Op::BIND_RENDERBUFFER, target, renderbuffer);
+    real_BindRenderbuffer(target, renderbuffer);
+}
+
+void GLAPIENTRY hooked_RenderbufferStorage(GLenum target, GLenum internal_format, GLsizei width, GLsizei height)
+{
+    record(Op::RENDERBUFFER_STORAGE, target, internal_format, width, height);
+    real_RenderbufferStorage(target, internal_format, width, height);
+}
+
+GLuint GLAPIENTRY hooked_CreateShader(GLenum type)
+{
+    GLuint shader = real_CreateShader(type);
+    record(Op::CREATE_SHADER, type, shader);
+    return shader;
+}
+
+void GLAPIENTRY hooked_DeleteShader(GLuint shader)
+{
+    record(Op::DELETE_SHADER, shader);
+    real_DeleteShader(shader);
+}
+
+void GLAPIENTRY hooked_ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+    if (shouldRecord(Op::SHADER_SOURCE))
+    {
+        std::string source;
+        for (GLsizei i = 0; i < count; ++i)
+        {
+            if (lengths == nullptr || lengths[i] < 0)
+            {
+                source += strings[i];
+            }
+            else
+            {
+                source.append(strings[i], lengths[i]);
+            }
+        }
+        begin(Op::SHADER_SOURCE);
+        put(shader);
+        blob(source.data(), source.size());
+        end();
+    }
+    real_ShaderSource(shader, count, strings, lengths);
+}
+
+void GLAPIENTRY hooked_CompileShader(GLuint shader)
+{
+    record(Op::COMPILE_SHADER, shader);
+    real_CompileShader(shader);
+}
+
+GLuint GLAPIENTRY hooked_CreateProgram()
+{
+    GLuint program = real_CreateProgram();
+    record(Op::CREATE_PROGRAM, program);
+    return program;
+}
+
+void GLAPIENTRY hooked_DeleteProgram(GLuint program)
+{
+    record(Op::DELETE_PROGRAM, program);
+    real_DeleteProgram(program);
+}
+
+void GLAPIENTRY hooked_AttachShader(GLuint program, GLuint shader)
+{
+    record(Op::ATTACH_SHADER, program, shader);
+    real_AttachShader(program, shader);
+}
+
+void GLAPIENTRY hooked_BindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+    recordLookup(Op::BIND_ATTRIB_LOCATION, program, index, name);
+    real_BindAttribLocation(program, index, name);
+}
+
+void GLAPIENTRY hooked_LinkProgram(GLuint program)
+{
+    record(Op::LINK_PROGRAM, program);
+    real_LinkProgram(program);
+}
+
+void GLAPIENTRY hooked_UseProgram(GLuint program)
+{
+    record(Op::USE_PROGRAM, program);
+    real_UseProgram(program);
+}
+
+GLint GLAPIENTRY hooked_GetUniformLocation(GLuint program, const GLchar* name)
+{
+    GLint location = real_GetUniformLocation(program, name);
+    recordLookup(Op::GET_UNIFORM_LOCATION, program, location, name);
+    return location;
+}
+
+GLint GLAPIENTRY hooked_GetAttribLocation(GLuint program, const GLchar* name)
+{
+    GLint location = real_GetAttribLocation(program, name);
+    recordLookup(Op::GET_ATTRIB_LOCATION, program, location, name);
+    return location;
+}
+
+GLuint GLAPIENTRY hooked_GetUniformBlockIndex(GLuint program, const GLchar* name)
+{
+    GLuint index = real_GetUniformBlockIndex(program, name);
+    recordLookup(Op::GET_UNIFORM_BLOCK_INDEX, program, index, name);
+    return index;
+}
+
+void GLAPIENTRY hooked_UniformBlockBinding(GLuint program, GLuint index, GLuint binding)
+{
+    record(Op::UNIFORM_BLOCK_BINDING, program, index, binding);
+    real_UniformBlockBinding(program, index, binding);
+}
+
+void GLAPIENTRY hooked_Uniform1i(GLint location, GLint v0)
+{
+    record(Op::UNIFORM_1I, location, v0);
+    real_Uniform1i(location, v0);
+}
+
+void GLAPIENTRY hooked_Uniform1f(GLint location, GLfloat v0)
+{
+    record(Op::UNIFORM_1F, location, v0);
+    real_Uniform1f(location, v0);
+}
+
+void GLAPIENTRY hooked_Uniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    record(Op::UNIFORM_2F, location, v0, v1);
+    real_Uniform2f(location, v0, v1);
+}
+
+void GLAPIENTRY hooked_Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+    record(Op::UNIFORM_3F, location, v0, v1, v2);
+    real_Uniform3f(location, v0, v1, v2);
+}
+
+void GLAPIENTRY hooked_Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    record(Op::UNIFORM_4F, location, v0, v1, v2, v3);
+    real_Uniform4f(location, v0, v1, v2, v3);
+}
+
+void GLAPIENTRY hooked_UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    if (shouldRecord(Op::UNIFORM_MATRIX_4FV))
+    {
+        begin(Op::UNIFORM_MATRIX_4FV);
+        put(location);
+        put(count);
+        put(transpose);
+        blob(value, 16 * count * sizeof(GLfloat));
+        end();
+    }
+    real_UniformMatrix4fv(location, count, transpose, value);
+}
+
+void GLAPIENTRY hooked_DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instance_count)
+{
+    record(Op::DRAW_ARRAYS_INSTANCED, mode, first, count, instance_count);
+    real_DrawArraysInstanced(mode, first, count, instance_count);
+}
+}
+
+
+// OpenGL 1.1 functions are linked directly instead of loaded by GLEW:
+// these definitions take the place of the system ones and forward to them.
+extern "C"
+{
+void GLAPIENTRY glEnable(GLenum capability)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum)>("glEnable");
+    record(Op::ENABLE, capability);
+    real(capability);
+}
+
+void GLAPIENTRY glDisable(GLenum capability)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum)>("glDisable");
+    record(Op::DISABLE, capability);
+    real(capability);
+}
+
+void GLAPIENTRY glBlendFunc(GLenum source, GLenum destination)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLenum)>("glBlendFunc");
+    record(Op::BLEND_FUNC, source, destination);
+    real(source, destination);
+}
+
+void GLAPIENTRY glDepthMask(GLboolean flag)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLboolean)>("glDepthMask");
+    record(Op::DEPTH_MASK, flag);
+    real(flag);
+}
+
+void GLAPIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLint, GLint, GLsizei, GLsizei)>("glViewport");
+    record(Op::VIEWPORT, x, y, width, height);
+    real(x, y, width, height);
+}
+
+void GLAPIENTRY glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLint, GLint, GLsizei, GLsizei)>("glScissor");
+    record(Op::SCISSOR, x, y, width, height);
+    real(x, y, width, height);
+}
+
+void GLAPIENTRY glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLfloat, GLfloat, GLfloat, GLfloat)>("glClearColor");
+    record(Op::CLEAR_COLOR, red, green, blue, alpha);
+    real(red, green, blue, alpha);
+}
+
+void GLAPIENTRY glClear(GLbitfield mask)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLbitfield)>("glClear");
+    record(Op::CLEAR, mask);
+    real(mask);
+}
+
+void GLAPIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLint, GLsizei)>("glDrawArrays");
+    record(Op::DRAW_ARRAYS, mode, first, count);
+    real(mode, first, count);
+}
+
+void GLAPIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLsizei, GLenum, const void*)>("glDrawElements");
+    if (shouldRecord(Op::DRAW_ELEMENTS))
+    {
+        begin(Op::DRAW_ELEMENTS);
+        put(mode);
+        put(count);
+        put(type);
+        // An offset in the bound GL_ELEMENT_ARRAY_BUFFER
+        put64(reinterpret_cast<std::uintptr_t>(indices));
+        end();
+    }
+    real(mode, count, type, indices);
+}
+
+void GLAPIENTRY glDrawBuffer(GLenum buffer)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum)>("glDrawBuffer");
+    record(Op::DRAW_BUFFER, buffer);
+    real(buffer);
+}
+
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint* textures)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLsizei, GLuint*)>("glGenTextures");
+    real(n, textures);
+    recordNames(Op::GEN_TEXTURES, n, textures);
+}
+
+void GLAPIENTRY glDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLsizei, const GLuint*)>("glDeleteTextures");
+    recordNames(Op::DELETE_TEXTURES, n, textures);
+    real(n, textures);
+}
+
+void GLAPIENTRY glBindTexture(GLenum target, GLuint texture)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLuint)>("glBindTexture");
+    record(Op::BIND_TEXTURE, target, texture);
+    real(target, texture);
+}
+
+void GLAPIENTRY glTexParameteri(GLenum target, GLenum name, GLint param)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLenum, GLint)>("glTexParameteri");
+    record(Op::TEX_PARAMETER_I, target, name, param);
+    real(target, name, param);
+}
+
+void GLAPIENTRY glTexImage2D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+        GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum,
+            GLenum, const void*)>("glTexImage2D");
+    if (shouldRecord(Op::TEX_IMAGE_2D))
+    {
+        begin(Op::TEX_IMAGE_2D);
+        put(target);
+        put(level);
+        put(internal_format);
+        put(width);
+        put(height);
+        put(border);
+        put(format);
+        put(type);
+        blob(pixels, rendering::gl_trace_format::imageSize(width, height, format, type, s_capture.unpack_alignment));
+        end();
+    }
+    real(target, level, internal_format, width, height, border, format, type, pixels);
+}
+
+void GLAPIENTRY glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+        GLenum format, GLenum type, const void* pixels)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum,
+            GLenum, const void*)>("glTexSubImage2D");
+    if (shouldRecord(Op::TEX_SUB_IMAGE_2D))
+    {
+        begin(Op::TEX_SUB_IMAGE_2D);
+        put(target);
+        put(level);
+        put(x);
+        put(y);
+        put(width);
+        put(height);
+        put(format);
+        put(type);
+        blob(pixels, rendering::gl_trace_format::imageSize(width, height, format, type, s_capture.unpack_alignment));
+        end();
+    }
+    real(target, level, x, y, width, height, format, type, pixels);
+}
+
+void GLAPIENTRY glPixelStorei(GLenum name, GLint param)
+{
+    static auto real = systemFunction<void (GLAPIENTRY*)(GLenum, GLint)>("glPixelStorei");
+    if (name == GL_UNPACK_ALIGNMENT)
+    {
+        s_capture.unpack_alignment = param;
+    }
+    record(Op::PIXEL_STORE_I, name, param);
+    real(name, param);
+}
+}
+
+
+namespace rendering
+{
+bool GLCapture::start(const std::string& filename, unsigned int first_frame, unsigned int frame_count)
+{
+    if (s_capture.context_ready)
+    {
+        hum::log_e("GLCapture: the capture must start before the game does.");
+        return false;
+    }
+    stop();
+    s_capture.file = std::fopen(filename.c_str(), "wb");
+    if (s_capture.file == nullptr)
+    {
+        hum::log_e("GLCapture: can't open ", filename, " for writing.");
+        return false;
+    }
+    s_capture.filename = filename;
+    s_capture.first_frame = first_frame;
+    s_capture.frame_count = frame_count;
+    s_capture.frame = 0;
+    // Rewritten with the number of frames when the capture stops
+    gl_trace_format::Header header = {gl_trace_format::MAGIC, gl_trace_format::VERSION, first_frame, 0};
+    std::fwrite(&header, sizeof(header), 1, s_capture.file);
+    return true;
+}
+
+void GLCapture::stop()
+{
+    s_capture.recording = false;
+    if (s_capture.installed)
+    {
+        // Mappings in progress get the data written so far, the real unmap finds them filled
+        for (Mapping_t& mapping : s_capture.mappings)
+        {
+            std::memcpy(mapping.pointer, mapping.shadow.data(), mapping.length);
+        }
+        s_capture.mappings.clear();
+#define GLCAPTURE_UNINSTALL(name) __glew##name = real_##name;
+        GLCAPTURE_GLEW_FUNCTIONS(GLCAPTURE_UNINSTALL)
+#undef GLCAPTURE_UNINSTALL
+        s_capture.installed = false;
+    }
+    if (s_capture.file == nullptr)
+    {
+        return;
+    }
+    flush();
+    gl_trace_format::Header header = {gl_trace_format::MAGIC, gl_trace_format::VERSION,
+            s_capture.first_frame, s_capture.frame};
+    std::fseek(s_capture.file, 0, SEEK_SET);
+    std::fwrite(&header, sizeof(header), 1, s_capture.file);
+    std::fclose(s_capture.file);
+    s_capture.file = nullptr;
+    hum::log("GLCapture: wrote ", s_capture.frame, " frames to ", s_capture.filename, ".");
+}
+
+bool GLCapture::isCapturing()
+{
+    return s_capture.recording;
+}
+
+void GLCapture::install()
+{
+    s_capture.context_ready = true;
+    if (s_capture.file == nullptr || s_capture.installed)
+    {
+        return;
+    }
+#define GLCAPTURE_INSTALL(name) real_##name = __glew##name; __glew##name = &hooked_##name;
+    GLCAPTURE_GLEW_FUNCTIONS(GLCAPTURE_INSTALL)
+#undef GLCAPTURE_INSTALL
+    s_capture.installed = true;
+    s_capture.recording = true;
+}
+
+void GLCapture::endFrame(int width, int height)
+{
+    if (!s_capture.recording)
+    {
+        return;
+    }
+    record(gl_trace_format::Op::FRAME_END, width, height);
+    ++s_capture.frame;
+    if (s_capture.frame >= s_capture.first_frame + s_capture.frame_count)
+    {
+        stop();
+    }
+}
+}
+
+#else
+
+namespace rendering
+{
+bool GLCapture::start(const std::string& filename, unsigned int first_frame, unsigned int frame_count)
+{
+    hum::log_e("GLCapture: built without capture support, rebuild with make GLCAPTURE=1.");
+    return false;
+}
+
+void GLCapture::stop()
+{}
+
+bool GLCapture::isCapturing()
+{
+    return false;
+}
+
+void GLCapture::install()
+{}
+
+void GLCapture::endFrame(int width, int height)
+{}
+}
+#endif
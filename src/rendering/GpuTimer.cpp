@@ -0,0 +1,91 @@
+#include "rendering/GpuTimer.hpp"
+
+namespace rendering
+{
+GpuTimer::GpuTimer():
+_current(0),
+_supported(false),
+_initialized(false),
+_running(false),
+_milliseconds(-1.f)
+{
+    for (unsigned int i = 0; i < QUERY_COUNT; ++i)
+    {
+        _queries[i] = 0;
+        _pending[i] = false;
+    }
+}
+
+GpuTimer::~GpuTimer()
+{
+    if (_initialized && _supported)
+    {
+        glDeleteQueries(QUERY_COUNT, _queries);
+    }
+}
+
+void GpuTimer::begin()
+{
+    if (!_initialized)
+    {
+        _initialized = true;
+        _supported = GLEW_ARB_timer_query;
+        if (_supported)
+        {
+            glGenQueries(QUERY_COUNT, _queries);
+        }
+    }
+    if (!_supported)
+    {
+        return;
+    }
+
+    // Collect every result that is ready, oldest first
+    for (unsigned int i = 1; i <= QUERY_COUNT; ++i)
+    {
+        unsigned int index = (_current + i) % QUERY_COUNT;
+        if (!_pending[index])
+        {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            continue;
+        }
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(_queries[index], GL_QUERY_RESULT, &nanoseconds);
+        _milliseconds = static_cast<float>(nanoseconds) / 1000000.f;
+        _pending[index] = false;
+    }
+
+    // Every query is still in flight: skip this measurement rather than stall
+    if (_pending[_current])
+    {
+        return;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, _queries[_current]);
+    _pending[_current] = true;
+    _running = true;
+}
+
+void GpuTimer::end()
+{
+    if (!_running)
+    {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    _running = false;
+    _current = (_current + 1) % QUERY_COUNT;
+}
+
+float GpuTimer::milliseconds()
+{
+    // Each result is only given once, so a late one isn't counted every frame
+    float milliseconds = _milliseconds;
+    _milliseconds = -1.f;
+    return milliseconds;
+}
+}
@@ -0,0 +1,110 @@
+#include "rendering/ImpostorBatch.hpp"
+#include "rendering/Plugin.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+ImpostorBatch::ImpostorBatch(Plugin* plugin):
+_plugin(plugin),
+_shader_program(nullptr),
+_VAO(0),
+_VBO(0),
+_capacity(0)
+{
+    Shader v_shader;
+    v_shader.loadFromFile(Shader::Type::VERTEX_SHADER, "shaders/impostor.vert");
+    hum::assert_msg(v_shader.isCompiled(), "Error compiling impostor.vert\n", v_shader.log());
+    Shader f_shader;
+    f_shader.loadFromFile(Shader::Type::FRAGMENT_SHADER, "shaders/impostor.frag");
+    hum::assert_msg(f_shader.isCompiled(), "Error compiling impostor.frag\n", f_shader.log());
+    _shader_program = new ShaderProgram();
+    _shader_program
+        ->addShader(v_shader)
+        ->addShader(f_shader)
+        ->link()
+        ->bindFragmentOutput("out_color");
+    if (!_shader_program->isLinked())
+    {
+        hum::log_d(_shader_program->log());
+        delete _shader_program;
+        _shader_program = nullptr;
+        return;
+    }
+
+    glGenVertexArrays(1, &_VAO);
+    glGenBuffers(1, &_VBO);
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    GLint loc = _shader_program->bindVertexAttribute("position", 3, GL_FLOAT, GL_FALSE,
+            sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, x)));
+    glEnableVertexAttribArray(loc);
+    loc = _shader_program->bindVertexAttribute("uv", 2, GL_FLOAT, GL_FALSE,
+            sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, u)));
+    glEnableVertexAttribArray(loc);
+    loc = _shader_program->bindVertexAttribute("color", 4, GL_UNSIGNED_BYTE, GL_TRUE,
+            sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, r)));
+    glEnableVertexAttribArray(loc);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+ImpostorBatch::~ImpostorBatch()
+{
+    if (_VAO != 0)
+    {
+        glDeleteBuffers(1, &_VBO);
+        glDeleteVertexArrays(1, &_VAO);
+    }
+    delete _shader_program;
+}
+
+void ImpostorBatch::add(const glm::vec3& center, float radius, const glm::vec3& right, const glm::vec3& up, const Color& color)
+{
+    glm::vec3 r = right * radius;
+    glm::vec3 u = up * radius;
+    glm::vec3 p00 = center - r - u;
+    glm::vec3 p10 = center + r - u;
+    glm::vec3 p01 = center - r + u;
+    glm::vec3 p11 = center + r + u;
+    unsigned char cr = color.r, cg = color.g, cb = color.b, ca = color.a;
+    _vertices.push_back(Vertex_t{p00.x, p00.y, p00.z, -1.f, -1.f, cr, cg, cb, ca});
+    _vertices.push_back(Vertex_t{p10.x, p10.y, p10.z, 1.f, -1.f, cr, cg, cb, ca});
+    _vertices.push_back(Vertex_t{p11.x, p11.y, p11.z, 1.f, 1.f, cr, cg, cb, ca});
+    _vertices.push_back(Vertex_t{p00.x, p00.y, p00.z, -1.f, -1.f, cr, cg, cb, ca});
+    _vertices.push_back(Vertex_t{p11.x, p11.y, p11.z, 1.f, 1.f, cr, cg, cb, ca});
+    _vertices.push_back(Vertex_t{p01.x, p01.y, p01.z, -1.f, 1.f, cr, cg, cb, ca});
+}
+
+void ImpostorBatch::flush()
+{
+    if (_vertices.empty() || _shader_program == nullptr)
+    {
+        _vertices.clear();
+        return;
+    }
+    // Not used by any Drawable, so the Plugin doesn't upload the camera to it
+    Camera& camera = _plugin->currentView().camera();
+    _shader_program->use();
+    _shader_program->setUniformMatrix4f("projection", camera.getProjection());
+    _shader_program->setUniformMatrix4f("view", camera.getView());
+    _shader_program->setUniformMatrix4f("model", glm::mat4(1.0));
+
+    std::size_t bytes = _vertices.size() * sizeof(Vertex_t);
+    glBindVertexArray(_VAO);
+    RenderStatistics::countVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    if (bytes > _capacity)
+    {
+        _capacity = bytes * 2;
+    }
+    // Orphan the previous storage so the driver does not wait for the last draw
+    glBufferData(GL_ARRAY_BUFFER, _capacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, _vertices.data());
+    RenderStatistics::countBufferUpload(bytes);
+    glDrawArrays(GL_TRIANGLES, 0, _vertices.size());
+    RenderStatistics::countInstancedBatch();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    _vertices.clear();
+}
+}
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include "hummingbird/hum.hpp"
+#include "rendering/IndirectRenderer.hpp"
+#include "rendering/Material.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Must match local_size_x in cull.comp
+const GLuint CULL_GROUP_SIZE = 64;
+// Shader storage binding points of the instances and the commands
+const GLuint INSTANCES_BINDING = 0;
+const GLuint COMMANDS_BINDING = 1;
+
+ShaderProgram* loadProgram(const std::vector<std::pair<Shader::Type, std::string>>& files)
+{
+    ShaderProgram* program = new ShaderProgram();
+    for (const auto& file : files)
+    {
+        Shader shader;
+        shader.loadFromFile(file.first, file.second);
+        hum::assert_msg(shader.isCompiled(), "Error compiling ", file.second, "\n", shader.log());
+        program->addShader(shader);
+    }
+    program->link();
+    if (!program->isLinked())
+    {
+        hum::log_d(program->log());
+        delete program;
+        return nullptr;
+    }
+    return program;
+}
+}
+
+bool IndirectRenderer::isSupported()
+{
+    return GLEW_VERSION_4_3;
+}
+
+IndirectRenderer::IndirectRenderer():
+_cull_program(nullptr),
+_draw_program(nullptr),
+_VAO(0),
+_quad_VBO(0),
+_index_VBO(0),
+_instance_SSBO(0),
+_command_buffer(0),
+_capacity(0),
+_dirty_begin(0),
+_dirty_end(0)
+{
+    _cull_program = loadProgram({{Shader::Type::COMPUTE_SHADER, "shaders/cull.comp"}});
+    _draw_program = loadProgram({{Shader::Type::VERTEX_SHADER, "shaders/indirect.vert"},
+            {Shader::Type::FRAGMENT_SHADER, "shaders/indirect.frag"}});
+    if (_draw_program != nullptr)
+    {
+        _draw_program->bindFragmentOutput("out_color");
+        Material::bindTable(_draw_program);
+    }
+
+    float vert[12] = { 0. , 0. ,
+                       1. , 0. ,
+                       1. , 1. ,
+                       0. , 0. ,
+                       1. , 1. ,
+                       0. , 1. };
+    glGenVertexArrays(1, &_VAO);
+    glGenBuffers(1, &_quad_VBO);
+    glGenBuffers(1, &_index_VBO);
+    glGenBuffers(1, &_instance_SSBO);
+    glGenBuffers(1, &_command_buffer);
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _quad_VBO);
+    glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(float), vert, GL_STATIC_DRAW);
+    if (_draw_program != nullptr)
+    {
+        GLint loc = _draw_program->bindVertexAttribute("position", 2, 0, 0);
+        glEnableVertexAttribArray(loc);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    reserve(1024);
+}
+
+IndirectRenderer::~IndirectRenderer()
+{
+    glDeleteBuffers(1, &_command_buffer);
+    glDeleteBuffers(1, &_instance_SSBO);
+    glDeleteBuffers(1, &_index_VBO);
+    glDeleteBuffers(1, &_quad_VBO);
+    glDeleteVertexArrays(1, &_VAO);
+    delete _draw_program;
+    delete _cull_program;
+}
+
+unsigned int IndirectRenderer::acquire()
+{
+    unsigned int slot;
+    if (_free_slots.empty())
+    {
+        slot = _instances.size();
+        _instances.push_back(Instance_t());
+    }
+    else
+    {
+        slot = _free_slots.back();
+        _free_slots.pop_back();
+    }
+    _instances[slot].enabled = 0;
+    return slot;
+}
+
+void IndirectRenderer::release(unsigned int slot)
+{
+    _instances[slot].enabled = 0;
+    _free_slots.push_back(slot);
+    markDirty(slot);
+}
+
+void IndirectRenderer::set(unsigned int slot, const glm::mat4& model, unsigned int material)
+{
+    Instance_t& instance = _instances[slot];
+    instance.model = model;
+    instance.material = material;
+    instance.enabled = 1;
+    markDirty(slot);
+}
+
+unsigned int IndirectRenderer::material(unsigned int slot) const
+{
+    return _instances[slot].material;
+}
+
+std::size_t IndirectRenderer::size() const
+{
+    return _instances.size() - _free_slots.size();
+}
+
+void IndirectRenderer::markDirty(std::size_t slot)
+{
+    if (_dirty_begin == _dirty_end)
+    {
+        _dirty_begin = slot;
+        _dirty_end = slot + 1;
+    }
+    else
+    {
+        _dirty_begin = std::min(_dirty_begin, slot);
+        _dirty_end = std::max(_dirty_end, slot + 1);
+    }
+}
+
+void IndirectRenderer::reserve(std::size_t capacity)
+{
+    _capacity = capacity;
+    std::vector<GLuint> indices(_capacity);
+    for (std::size_t i = 0; i < _capacity; ++i)
+    {
+        indices[i] = i;
+    }
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _index_VBO);
+    glBufferData(GL_ARRAY_BUFFER, _capacity * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    GLint loc = _draw_program != nullptr ? _draw_program->bindVertexAttributeI("instance", 1, GL_UNSIGNED_INT, 0, 0) : -1;
+    if (loc >= 0)
+    {
+        glVertexAttribDivisor(loc, 1);
+        glEnableVertexAttribArray(loc);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _instance_SSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, _capacity * sizeof(Instance_t), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _command_buffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, _capacity * sizeof(DrawArraysIndirectCommand_t), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    RenderStatistics::countBufferUpload(_capacity * sizeof(GLuint));
+
+    // The new storage is empty
+    _dirty_begin = 0;
+    _dirty_end = _instances.size();
+}
+
+void IndirectRenderer::upload()
+{
+    if (_instances.size() > _capacity)
+    {
+        reserve(std::max(_instances.size(), _capacity * 2));
+    }
+    if (_dirty_begin == _dirty_end)
+    {
+        return;
+    }
+    std::size_t bytes = (_dirty_end - _dirty_begin) * sizeof(Instance_t);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _instance_SSBO);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, _dirty_begin * sizeof(Instance_t), bytes, _instances.data() + _dirty_begin);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    RenderStatistics::countBufferUpload(bytes);
+    _dirty_begin = _dirty_end = 0;
+}
+
+void IndirectRenderer::draw(Camera& camera)
+{
+    if (_instances.empty() || _cull_program == nullptr || _draw_program == nullptr)
+    {
+        return;
+    }
+    upload();
+
+    glm::vec4 planes[6];
+    camera.getFrustumPlanes(planes);
+    _cull_program->use();
+    for (int i = 0; i < 6; ++i)
+    {
+        _cull_program->setUniform4f("planes[" + std::to_string(i) + "]", planes[i].x, planes[i].y, planes[i].z, planes[i].w);
+    }
+    _cull_program->setUniform1i("instance_count", _instances.size());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCES_BINDING, _instance_SSBO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, _command_buffer);
+    glDispatchCompute((_instances.size() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+    // The commands are read by the draw, the instances stay bound for the vertex shader
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+    _draw_program->use();
+    _draw_program->setUniformMatrix4f("projection", camera.getProjection());
+    _draw_program->setUniformMatrix4f("view", camera.getView());
+    glBindVertexArray(_VAO);
+    RenderStatistics::countVertexArray(_VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _command_buffer);
+    glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, _instances.size(), 0);
+    RenderStatistics::countInstancedBatch();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+}
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include "hummingbird/hum.hpp"
+#include "rendering/Material.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+std::vector<Material::Entry_t> Material::_entries;
+std::vector<unsigned int> Material::_free_slots;
+unsigned int Material::_dirty_begin = 0;
+unsigned int Material::_dirty_end = 0;
+GLuint Material::_UBO = 0;
+std::unordered_map<std::uint32_t, std::weak_ptr<Material>> Material::_shared;
+
+Material::Material(const Color& color):
+_color(color),
+_parameters(0.f)
+{
+    if (_free_slots.empty())
+    {
+        hum::assert_msg(_entries.size() < MAX_MATERIALS, "Too many rendering::Material");
+        _index = _entries.size();
+        _entries.push_back(Entry_t());
+    }
+    else
+    {
+        _index = _free_slots.back();
+        _free_slots.pop_back();
+    }
+    setColor(color);
+    setParameters(_parameters);
+}
+
+Material::~Material()
+{
+    _free_slots.push_back(_index);
+}
+
+std::shared_ptr<Material> Material::shared(const Color& color)
+{
+    std::uint32_t key = (std::min(color.r, 255u) << 24) | (std::min(color.g, 255u) << 16)
+        | (std::min(color.b, 255u) << 8) | std::min(color.a, 255u);
+    std::weak_ptr<Material>& entry = _shared[key];
+    std::shared_ptr<Material> material = entry.lock();
+    if (!material)
+    {
+        material.reset(new Material(color));
+        entry = material;
+    }
+    return material;
+}
+
+void Material::setColor(const Color& color)
+{
+    _color = color;
+    _entries[_index].color = glm::vec4(color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f);
+    markDirty();
+}
+
+const Color& Material::getColor() const
+{
+    return _color;
+}
+
+void Material::setParameters(const glm::vec4& parameters)
+{
+    _parameters = parameters;
+    _entries[_index].parameters = parameters;
+    markDirty();
+}
+
+const glm::vec4& Material::getParameters() const
+{
+    return _parameters;
+}
+
+unsigned int Material::index() const
+{
+    return _index;
+}
+
+void Material::upload()
+{
+    if (_UBO == 0)
+    {
+        glGenBuffers(1, &_UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, _UBO);
+        glBufferData(GL_UNIFORM_BUFFER, MAX_MATERIALS * sizeof(Entry_t), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        _dirty_begin = 0;
+        _dirty_end = _entries.size();
+    }
+    if (_dirty_begin < _dirty_end)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, _UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, _dirty_begin * sizeof(Entry_t),
+                (_dirty_end - _dirty_begin) * sizeof(Entry_t), &_entries[_dirty_begin]);
+        RenderStatistics::countBufferUpload((_dirty_end - _dirty_begin) * sizeof(Entry_t));
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        _dirty_begin = _dirty_end = 0;
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, _UBO);
+}
+
+void Material::bindTable(ShaderProgram* shader_program)
+{
+    shader_program->bindUniformBlock("Materials", BINDING);
+}
+
+void Material::markDirty()
+{
+    if (_dirty_begin == _dirty_end)
+    {
+        _dirty_begin = _index;
+        _dirty_end = _index + 1;
+    }
+    else
+    {
+        _dirty_begin = std::min(_dirty_begin, _index);
+        _dirty_end = std::max(_dirty_end, _index + 1);
+    }
+}
+}
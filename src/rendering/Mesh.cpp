@@ -0,0 +1,137 @@
+#include <cmath>
+#include <cstdint>
+#include "rendering/Mesh.hpp"
+#include "rendering/Plugin.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+ShaderPermutations* Mesh::_permutations = nullptr;
+
+Mesh::Mesh(MeshData* data, const Color& color):
+_data(data),
+_VAO(0),
+_has_normal(false),
+_color_material(Material::shared(color)),
+_material(_color_material.get())
+{}
+
+Mesh::Mesh(MeshData* data, Material* material):
+_data(data),
+_VAO(0),
+_has_normal(false),
+_material(material)
+{}
+
+Mesh::~Mesh()
+{
+    if (_VAO != 0)
+    {
+        glDeleteVertexArrays(1, &_VAO);
+    }
+}
+
+void Mesh::init()
+{
+    if (isHeadless())
+    {
+        Drawable::init();
+        return;
+    }
+    if (_permutations == nullptr)
+    {
+        _permutations = new ShaderPermutations("shaders/mesh.vert", "shaders/mesh.frag", {"HAS_NORMAL"});
+        _permutations->setLinkCallback(&Material::bindTable);
+        // Both variants are cheap, have them ready before the first Mesh without normals shows up
+        _permutations->require(0);
+        _permutations->require(_permutations->mask({"HAS_NORMAL"}));
+    }
+
+    _data->upload();
+    const float* bounds_min = _data->boundsMin();
+    const float* bounds_max = _data->boundsMax();
+    hum::Vector3f extent((bounds_max[0] - bounds_min[0]) * 0.5f, (bounds_max[1] - bounds_min[1]) * 0.5f, (bounds_max[2] - bounds_min[2]) * 0.5f);
+    setBounds(hum::Vector3f(bounds_min[0] + extent.x, bounds_min[1] + extent.y, bounds_min[2] + extent.z),
+            std::sqrt(extent.x * extent.x + extent.y * extent.y + extent.z * extent.z));
+    for (const VertexAttribute& attribute : _data->layout().attributes)
+    {
+        _has_normal = _has_normal || attribute.name == "normal";
+    }
+    glGenVertexArrays(1, &_VAO);
+    setShaderProgram(_permutations->get(_has_normal ? _permutations->mask({"HAS_NORMAL"}) : 0));
+    Drawable::init();
+}
+
+void Mesh::onDestroy()
+{
+    Drawable::onDestroy();
+}
+
+void Mesh::setShaderProgram(ShaderProgram* shader_program)
+{
+    Drawable::setShaderProgram(shader_program);
+    if (_VAO == 0)
+    {
+        // Not initialized yet, or headless: init() binds the attributes
+        return;
+    }
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _data->vertexBuffer());
+    for (const VertexAttribute& attribute : _data->layout().attributes)
+    {
+        GLint loc = shaderProgram()->bindVertexAttribute(attribute.name, attribute.size, attribute.type,
+                attribute.normalized, _data->layout().stride, reinterpret_cast<GLvoid*>(static_cast<std::uintptr_t>(attribute.offset)));
+        // Attributes the shader doesn't use are left out
+        if (loc >= 0)
+        {
+            glEnableVertexAttribArray(loc);
+        }
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _data->indexBuffer());
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void Mesh::setColor(const Color& color)
+{
+    // Never changes the color of a Material others may use
+    _color_material = Material::shared(color);
+    _material = _color_material.get();
+}
+
+const Color& Mesh::getColor() const
+{
+    return _material->getColor();
+}
+
+void Mesh::setMaterial(Material* material)
+{
+    _material = material;
+    _color_material.reset();
+}
+
+Material* Mesh::getMaterial() const
+{
+    return _material;
+}
+
+MeshData* Mesh::getData() const
+{
+    return _data;
+}
+
+void Mesh::draw()
+{
+    glBindVertexArray(_VAO);
+    RenderStatistics::countVertexArray(_VAO);
+    shaderProgram()->setUniform1i("material_index", _material->index());
+    glDrawElements(GL_TRIANGLES, _data->indexCount(), _data->indexType(), nullptr);
+    RenderStatistics::countDrawCall();
+}
+
+const char* Mesh::behaviorName()
+{
+    return "rendering::Mesh";
+}
+}
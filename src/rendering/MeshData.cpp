@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hummingbird/hum.hpp"
+#include "rendering/Archive.hpp"
+#include "rendering/MeshData.hpp"
+#include "rendering/MeshFormat.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Bytes of one component of <type>, 0 if it isn't a mesh_format type
+std::size_t componentSize(std::uint32_t type)
+{
+    switch (type)
+    {
+        case mesh_format::TYPE_UNSIGNED_BYTE:
+            return 1;
+        case mesh_format::TYPE_UNSIGNED_SHORT:
+            return 2;
+        case mesh_format::TYPE_UNSIGNED_INT:
+        case mesh_format::TYPE_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+}
+
+MeshData::MeshData():
+_VBO(0),
+_EBO(0),
+_vertex_count(0),
+_index_count(0),
+_index_type(GL_UNSIGNED_INT),
+_bounds_min{0.f, 0.f, 0.f},
+_bounds_max{0.f, 0.f, 0.f},
+_mapping(nullptr),
+_mapping_size(0),
+_vertex_data(nullptr),
+_index_data(nullptr)
+{}
+
+MeshData::~MeshData()
+{
+    unmap();
+    if (_VBO != 0)
+    {
+        glDeleteBuffers(1, &_VBO);
+        glDeleteBuffers(1, &_EBO);
+    }
+}
+
+bool MeshData::loadFromFile(const std::string& filename)
+{
+    unmap();
+    std::string_view packed = Archive::findMounted(filename);
+    if (packed.data() != nullptr)
+    {
+        // The archive keeps the data mapped, nothing to unmap after the upload
+        if (!parse(packed.data(), packed.size()))
+        {
+            hum::log_e("Mesh ", filename, " is not a valid mesh file");
+            return false;
+        }
+        return true;
+    }
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        hum::log_e("Unable to open mesh ", filename);
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < sizeof(mesh_format::Header))
+    {
+        hum::log_e("Mesh ", filename, " is too small");
+        close(fd);
+        return false;
+    }
+    _mapping_size = file_stat.st_size;
+    _mapping = mmap(nullptr, _mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (_mapping == MAP_FAILED)
+    {
+        hum::log_e("Unable to map mesh ", filename);
+        _mapping = nullptr;
+        _mapping_size = 0;
+        return false;
+    }
+    if (!parse(_mapping, _mapping_size))
+    {
+        hum::log_e("Mesh ", filename, " is not a valid mesh file");
+        unmap();
+        return false;
+    }
+    // The data is read once, front to back, by upload()
+    madvise(_mapping, _mapping_size, MADV_SEQUENTIAL);
+    return true;
+}
+
+bool MeshData::loadFromBuffer(const void* data, std::size_t size)
+{
+    unmap();
+    return parse(data, size);
+}
+
+bool MeshData::parse(const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const mesh_format::Header* header = reinterpret_cast<const mesh_format::Header*>(bytes);
+    if (size < sizeof(mesh_format::Header))
+    {
+        return false;
+    }
+    std::size_t index_size = header->index_type == mesh_format::TYPE_UNSIGNED_SHORT ? 2 : 4;
+    if (header->magic != mesh_format::MAGIC || header->version != mesh_format::VERSION
+            || (header->index_type != mesh_format::TYPE_UNSIGNED_SHORT && header->index_type != mesh_format::TYPE_UNSIGNED_INT)
+            || sizeof(mesh_format::Header) + static_cast<std::size_t>(header->attribute_count) * sizeof(mesh_format::Attribute) > size
+            || header->vertex_offset + static_cast<std::size_t>(header->vertex_count) * header->vertex_stride > size
+            || header->index_offset + static_cast<std::size_t>(header->index_count) * index_size > size)
+    {
+        return false;
+    }
+
+    const mesh_format::Attribute* attributes = reinterpret_cast<const mesh_format::Attribute*>(bytes + sizeof(mesh_format::Header));
+    // Every attribute within a vertex, the bounds and the GPU read them
+    for (unsigned int i = 0; i < header->attribute_count; ++i)
+    {
+        const mesh_format::Attribute& attribute = attributes[i];
+        std::size_t component_size = componentSize(attribute.type);
+        if (component_size == 0 || attribute.size == 0 || attribute.size > 4
+                || static_cast<std::size_t>(attribute.offset) + attribute.size * component_size > header->vertex_stride)
+        {
+            return false;
+        }
+    }
+    _layout.attributes.clear();
+    for (unsigned int i = 0; i < header->attribute_count; ++i)
+    {
+        const mesh_format::Attribute& attribute = attributes[i];
+        _layout.attributes.push_back(VertexAttribute{
+                std::string(attribute.name, strnlen(attribute.name, mesh_format::MAX_ATTRIBUTE_NAME)),
+                static_cast<GLint>(attribute.size),
+                static_cast<GLenum>(attribute.type),
+                static_cast<GLboolean>(attribute.normalized ? GL_TRUE : GL_FALSE),
+                attribute.offset});
+    }
+    _layout.stride = header->vertex_stride;
+    _vertex_count = header->vertex_count;
+    _index_count = header->index_count;
+    _index_type = header->index_type;
+    std::memcpy(_bounds_min, header->bounds_min, sizeof(_bounds_min));
+    std::memcpy(_bounds_max, header->bounds_max, sizeof(_bounds_max));
+    _vertex_data = bytes + header->vertex_offset;
+    _index_data = bytes + header->index_offset;
+    return true;
+}
+
+void MeshData::loadFromMemory(const VertexLayout& layout, const void* vertices, std::size_t vertex_count,
+        const std::vector<std::uint32_t>& indices)
+{
+    unmap();
+    _layout = layout;
+    _vertex_count = vertex_count;
+    _index_count = indices.size();
+    _index_type = GL_UNSIGNED_INT;
+    const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+    _vertex_copy.assign(bytes, bytes + vertex_count * layout.stride);
+    _index_copy = indices;
+    _vertex_data = _vertex_copy.data();
+    _index_data = _index_copy.data();
+
+    // Bounds from the position attribute, if it is made of floats
+    for (const VertexAttribute& attribute : _layout.attributes)
+    {
+        if (attribute.name != "position" || attribute.type != GL_FLOAT || attribute.size < 1 || attribute.size > 4
+                || attribute.offset + attribute.size * sizeof(float) > layout.stride)
+        {
+            continue;
+        }
+        for (std::size_t i = 0; i < vertex_count; ++i)
+        {
+            const float* position = reinterpret_cast<const float*>(bytes + i * layout.stride + attribute.offset);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                float value = axis < attribute.size ? position[axis] : 0.f;
+                _bounds_min[axis] = i == 0 ? value : std::min(_bounds_min[axis], value);
+                _bounds_max[axis] = i == 0 ? value : std::max(_bounds_max[axis], value);
+            }
+        }
+    }
+}
+
+void MeshData::upload()
+{
+    if (_VBO != 0 || _vertex_data == nullptr)
+    {
+        return;
+    }
+    std::size_t index_size = _index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+    glGenBuffers(1, &_VBO);
+    glGenBuffers(1, &_EBO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    glBufferData(GL_ARRAY_BUFFER, _vertex_count * _layout.stride, _vertex_data, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // The element array binding is VAO state, keep the current VAO's one intact
+    GLint previous_vao;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _index_count * index_size, _index_data, GL_STATIC_DRAW);
+    RenderStatistics::countBufferUpload(_vertex_count * _layout.stride + _index_count * index_size);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindVertexArray(previous_vao);
+    unmap();
+}
+
+const VertexLayout& MeshData::layout() const
+{
+    return _layout;
+}
+
+GLuint MeshData::vertexBuffer() const
+{
+    return _VBO;
+}
+
+GLuint MeshData::indexBuffer() const
+{
+    return _EBO;
+}
+
+std::size_t MeshData::indexCount() const
+{
+    return _index_count;
+}
+
+GLenum MeshData::indexType() const
+{
+    return _index_type;
+}
+
+const float* MeshData::boundsMin() const
+{
+    return _bounds_min;
+}
+
+const float* MeshData::boundsMax() const
+{
+    return _bounds_max;
+}
+
+void MeshData::unmap()
+{
+    if (_mapping != nullptr)
+    {
+        munmap(_mapping, _mapping_size);
+        _mapping = nullptr;
+        _mapping_size = 0;
+    }
+    _vertex_copy.clear();
+    _vertex_copy.shrink_to_fit();
+    _index_copy.clear();
+    _index_copy.shrink_to_fit();
+    _vertex_data = nullptr;
+    _index_data = nullptr;
+}
+}
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <cmath>
+#include "rendering/OcclusionCuller.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Clip w under which a point is taken as behind the camera
+const float MIN_W = 1e-6f;
+
+// Twice the signed area of the triangle (a, b, c)
+float cross(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+}
+
+OcclusionCuller::OcclusionCuller():
+_width(128),
+_height(72),
+_max_occluders(64),
+_occluder_count(0),
+_view_projection(1.0)
+{}
+
+void OcclusionCuller::setResolution(unsigned int width, unsigned int height)
+{
+    _width = std::max(width, 1u);
+    _height = std::max(height, 1u);
+    _levels.clear();
+    _level_widths.clear();
+    _level_heights.clear();
+    _occluder_count = 0;
+}
+
+unsigned int OcclusionCuller::getWidth() const
+{
+    return _width;
+}
+
+unsigned int OcclusionCuller::getHeight() const
+{
+    return _height;
+}
+
+void OcclusionCuller::setMaxOccluders(unsigned int max_occluders)
+{
+    _max_occluders = max_occluders;
+}
+
+unsigned int OcclusionCuller::getMaxOccluders() const
+{
+    return _max_occluders;
+}
+
+void OcclusionCuller::begin(const glm::mat4& view_projection)
+{
+    _view_projection = view_projection;
+    _candidates.clear();
+    _occluder_count = 0;
+}
+
+void OcclusionCuller::addOccluder(const glm::mat4& model)
+{
+    static const glm::vec4 corners[4] = { glm::vec4(0.f, 0.f, 0.f, 1.f), glm::vec4(1.f, 0.f, 0.f, 1.f),
+                                          glm::vec4(1.f, 1.f, 0.f, 1.f), glm::vec4(0.f, 1.f, 0.f, 1.f) };
+    Occluder_t occluder;
+    occluder.depth = 0.f;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        glm::vec3 screen;
+        // Clipped by the near plane, the part drawn would be a smaller quad
+        if (!project(glm::vec3(model * corners[i]), screen) || screen.z < 0.f)
+        {
+            return;
+        }
+        occluder.corners[i] = glm::vec2(screen.x, screen.y);
+        // Depth is affine over a flat quad on screen: the farthest point is a corner
+        occluder.depth = std::max(occluder.depth, screen.z);
+    }
+    occluder.area = 0.5f * std::abs(cross(occluder.corners[0], occluder.corners[1], occluder.corners[2])
+            + cross(occluder.corners[0], occluder.corners[2], occluder.corners[3]));
+    // Smaller than a texel it can't cover one
+    if (occluder.area >= 1.f && occluder.depth < 1.f)
+    {
+        _candidates.push_back(occluder);
+    }
+}
+
+void OcclusionCuller::build()
+{
+    _occluder_count = std::min<std::size_t>(_candidates.size(), _max_occluders);
+    if (_occluder_count == 0)
+    {
+        return;
+    }
+    std::partial_sort(_candidates.begin(), _candidates.begin() + _occluder_count, _candidates.end(),
+            [](const Occluder_t& left, const Occluder_t& right) { return left.area > right.area; });
+
+    if (_levels.empty())
+    {
+        unsigned int width = _width, height = _height;
+        while (true)
+        {
+            _levels.push_back(std::vector<float>(width * height));
+            _level_widths.push_back(width);
+            _level_heights.push_back(height);
+            if (width == 1 && height == 1)
+            {
+                break;
+            }
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+        }
+    }
+    std::fill(_levels[0].begin(), _levels[0].end(), 1.f);
+    for (unsigned int i = 0; i < _occluder_count; ++i)
+    {
+        rasterize(_candidates[i]);
+    }
+
+    for (unsigned int level = 1; level < _levels.size(); ++level)
+    {
+        const std::vector<float>& below = _levels[level - 1];
+        unsigned int below_width = _level_widths[level - 1], below_height = _level_heights[level - 1];
+        std::vector<float>& texels = _levels[level];
+        for (unsigned int y = 0; y < _level_heights[level]; ++y)
+        {
+            unsigned int y0 = 2 * y, y1 = std::min(2 * y + 1, below_height - 1);
+            for (unsigned int x = 0; x < _level_widths[level]; ++x)
+            {
+                unsigned int x0 = 2 * x, x1 = std::min(2 * x + 1, below_width - 1);
+                texels[y * _level_widths[level] + x] = std::max(
+                        std::max(below[y0 * below_width + x0], below[y0 * below_width + x1]),
+                        std::max(below[y1 * below_width + x0], below[y1 * below_width + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isQuadOccluded(const glm::mat4& model) const
+{
+    if (_occluder_count == 0)
+    {
+        return false;
+    }
+    glm::vec3 corners[4] = { glm::vec3(model * glm::vec4(0.f, 0.f, 0.f, 1.f)), glm::vec3(model * glm::vec4(1.f, 0.f, 0.f, 1.f)),
+                             glm::vec3(model * glm::vec4(1.f, 1.f, 0.f, 1.f)), glm::vec3(model * glm::vec4(0.f, 1.f, 0.f, 1.f)) };
+    Rect_t rect;
+    return projectPoints(corners, 4, rect) && isRectOccluded(rect);
+}
+
+bool OcclusionCuller::isSphereOccluded(const glm::vec3& center, float radius) const
+{
+    if (_occluder_count == 0)
+    {
+        return false;
+    }
+    // The corners of the box around the sphere
+    glm::vec3 corners[8];
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        corners[i] = center + radius * glm::vec3(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f);
+    }
+    Rect_t rect;
+    return projectPoints(corners, 8, rect) && isRectOccluded(rect);
+}
+
+unsigned int OcclusionCuller::occluderCount() const
+{
+    return _occluder_count;
+}
+
+bool OcclusionCuller::project(const glm::vec3& point, glm::vec3& screen) const
+{
+    glm::vec4 clip = _view_projection * glm::vec4(point, 1.f);
+    if (clip.w < MIN_W)
+    {
+        return false;
+    }
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    screen = glm::vec3((ndc.x * 0.5f + 0.5f) * _width, (ndc.y * 0.5f + 0.5f) * _height, ndc.z * 0.5f + 0.5f);
+    return true;
+}
+
+bool OcclusionCuller::projectPoints(const glm::vec3* points, unsigned int count, Rect_t& rect) const
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        glm::vec3 screen;
+        if (!project(points[i], screen))
+        {
+            // Crosses the camera plane, can't be behind anything
+            return false;
+        }
+        if (i == 0)
+        {
+            rect = Rect_t{screen.x, screen.y, screen.x, screen.y, screen.z};
+            continue;
+        }
+        rect.x0 = std::min(rect.x0, screen.x);
+        rect.y0 = std::min(rect.y0, screen.y);
+        rect.x1 = std::max(rect.x1, screen.x);
+        rect.y1 = std::max(rect.y1, screen.y);
+        rect.depth = std::min(rect.depth, screen.z);
+    }
+    return true;
+}
+
+bool OcclusionCuller::isRectOccluded(const Rect_t& rect) const
+{
+    float x0 = std::max(rect.x0, 0.f), y0 = std::max(rect.y0, 0.f);
+    float x1 = std::min(rect.x1, static_cast<float>(_width)), y1 = std::min(rect.y1, static_cast<float>(_height));
+    if (x0 >= x1 || y0 >= y1)
+    {
+        // Off screen, left to the frustum culling
+        return false;
+    }
+    // First level where the rectangle spans 4 texels or less: coarser levels
+    // read less but mix in more of the texels around it
+    float size = std::max(x1 - x0, y1 - y0);
+    unsigned int level = 0;
+    while (level + 1 < _levels.size() && size > static_cast<float>(4u << level))
+    {
+        ++level;
+    }
+    float texel_size = static_cast<float>(1u << level);
+    unsigned int level_width = _level_widths[level], level_height = _level_heights[level];
+    unsigned int tx0 = static_cast<unsigned int>(x0 / texel_size);
+    unsigned int ty0 = static_cast<unsigned int>(y0 / texel_size);
+    unsigned int tx1 = std::min(static_cast<unsigned int>(std::ceil(x1 / texel_size)), level_width);
+    unsigned int ty1 = std::min(static_cast<unsigned int>(std::ceil(y1 / texel_size)), level_height);
+    const std::vector<float>& texels = _levels[level];
+    for (unsigned int y = ty0; y < ty1; ++y)
+    {
+        for (unsigned int x = tx0; x < tx1; ++x)
+        {
+            if (rect.depth <= texels[y * level_width + x])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void OcclusionCuller::rasterize(const Occluder_t& occluder)
+{
+    const glm::vec2* corners = occluder.corners;
+    float min_x = corners[0].x, min_y = corners[0].y, max_x = corners[0].x, max_y = corners[0].y;
+    for (unsigned int i = 1; i < 4; ++i)
+    {
+        min_x = std::min(min_x, corners[i].x);
+        min_y = std::min(min_y, corners[i].y);
+        max_x = std::max(max_x, corners[i].x);
+        max_y = std::max(max_y, corners[i].y);
+    }
+    int x_begin = std::max(static_cast<int>(std::ceil(min_x)), 0);
+    int y_begin = std::max(static_cast<int>(std::ceil(min_y)), 0);
+    int x_end = std::min(static_cast<int>(std::floor(max_x)), static_cast<int>(_width));
+    int y_end = std::min(static_cast<int>(std::floor(max_y)), static_cast<int>(_height));
+    // The quad is convex: a texel is covered when its 4 corners are inside every edge
+    float winding = cross(corners[0], corners[1], corners[2]) + cross(corners[0], corners[2], corners[3]) > 0.f ? 1.f : -1.f;
+    auto inside = [corners, winding](float x, float y)
+    {
+        glm::vec2 point(x, y);
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            if (winding * cross(corners[i], corners[(i + 1) % 4], point) < 0.f)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    std::vector<float>& depths = _levels[0];
+    for (int y = y_begin; y < y_end; ++y)
+    {
+        for (int x = x_begin; x < x_end; ++x)
+        {
+            if (inside(x, y) && inside(x + 1, y) && inside(x, y + 1) && inside(x + 1, y + 1))
+            {
+                float& depth = depths[y * _width + x];
+                depth = std::min(depth, occluder.depth);
+            }
+        }
+    }
+}
+}
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "JobSystem.hpp"
+#include "rendering/ParticleSystem.hpp"
+#include "rendering/Plugin.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+namespace
+{
+const std::size_t PARALLEL_GRAIN = 16384;
+}
+
+ParticleSystem::Emitter::Emitter():
+rate(100.f),
+min_lifetime(1.f),
+max_lifetime(2.f),
+min_speed(5.f),
+max_speed(10.f),
+min_angle(0.f),
+max_angle(360.f),
+acceleration_x(0.f),
+acceleration_y(0.f),
+color(255, 255, 255)
+{}
+
+ShaderProgram* ParticleSystem::_shader_program = nullptr;
+
+ParticleSystem::ParticleSystem(std::size_t capacity):
+_VAO(0),
+_VBO(0),
+_particle_loc(0),
+_color_loc(0),
+_x(capacity),
+_y(capacity),
+_vx(capacity),
+_vy(capacity),
+_age(capacity),
+_lifetime(capacity),
+_color(capacity),
+_count(0),
+_capacity(capacity),
+_particle_size(1.f),
+_emit_accumulator(0.f),
+_random_state(0x9E3779B9u),
+_multithreaded(false),
+_uploaded(false),
+_job_system(nullptr)
+{}
+
+ParticleSystem::~ParticleSystem()
+{
+    if (_VAO != 0)
+    {
+        glDeleteBuffers(1, &_VBO);
+        glDeleteVertexArrays(1, &_VAO);
+    }
+}
+
+void ParticleSystem::init()
+{
+    try
+    {
+        _job_system = actor().game().getPlugin<JobSystem>();
+    }
+    catch (hum::exception::PluginNotFound e)
+    {
+        _job_system = nullptr;
+    }
+    // The particles are still simulated headless, only not uploaded
+    if (isHeadless())
+    {
+        Drawable::init();
+        return;
+    }
+    if (_shader_program == nullptr)
+    {
+        Shader v_shader;
+        v_shader.loadFromFile(Shader::Type::VERTEX_SHADER, "shaders/particle.vert");
+        hum::assert_msg(v_shader.isCompiled(), "Error compiling particle.vert\n", v_shader.log());
+        Shader f_shader;
+        f_shader.loadFromFile(Shader::Type::FRAGMENT_SHADER, "shaders/particle.frag");
+        hum::assert_msg(f_shader.isCompiled(), "Error compiling particle.frag\n", f_shader.log());
+        _shader_program = new ShaderProgram();
+        _shader_program
+            ->addShader(v_shader)
+            ->addShader(f_shader)
+            ->link()
+            ->bindFragmentOutput("out_color");
+        if (!_shader_program->isLinked())
+        {
+            hum::log_d(_shader_program->log());
+            delete _shader_program;
+            _shader_program = nullptr;
+        }
+    }
+
+    glGenVertexArrays(1, &_VAO);
+    glGenBuffers(1, &_VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    glBufferData(GL_ARRAY_BUFFER, _capacity * sizeof(Instance_t), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    setShaderProgram(_shader_program);
+    Drawable::init();
+}
+
+void ParticleSystem::update()
+{
+    float dt = actor().game().deltaTime().asSeconds();
+
+    _emit_accumulator += _emitter.rate * dt;
+    std::size_t spawn = static_cast<std::size_t>(_emit_accumulator);
+    _emit_accumulator -= spawn;
+    emit(spawn);
+
+    if (_multithreaded && _job_system != nullptr)
+    {
+        _job_system->parallelFor(_count, PARALLEL_GRAIN,
+                [this, dt](std::size_t begin, std::size_t end) { integrate(begin, end, dt); });
+    }
+    else
+    {
+        integrate(0, _count, dt);
+    }
+
+    // Kill: move the last live particle into the slot of the dead one
+    for (std::size_t i = 0; i < _count;)
+    {
+        if (_age[i] < _lifetime[i])
+        {
+            ++i;
+            continue;
+        }
+        std::size_t last = --_count;
+        _x[i] = _x[last];
+        _y[i] = _y[last];
+        _vx[i] = _vx[last];
+        _vy[i] = _vy[last];
+        _age[i] = _age[last];
+        _lifetime[i] = _lifetime[last];
+        _color[i] = _color[last];
+    }
+    _uploaded = false;
+}
+
+void ParticleSystem::onDestroy()
+{
+    Drawable::onDestroy();
+}
+
+void ParticleSystem::setShaderProgram(ShaderProgram* shader_program)
+{
+    Drawable::setShaderProgram(shader_program);
+    if (_VAO == 0)
+    {
+        // Not initialized yet, or headless: init() binds the attributes
+        return;
+    }
+    glBindVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    _particle_loc = shaderProgram()->bindVertexAttribute("particle", 3, GL_FLOAT, GL_FALSE,
+            sizeof(Instance_t), reinterpret_cast<GLvoid*>(offsetof(Instance_t, x)));
+    _color_loc = shaderProgram()->bindVertexAttribute("color", 4, GL_UNSIGNED_BYTE, GL_TRUE,
+            sizeof(Instance_t), reinterpret_cast<GLvoid*>(offsetof(Instance_t, color)));
+    glVertexAttribDivisor(_particle_loc, 1);
+    glVertexAttribDivisor(_color_loc, 1);
+    glEnableVertexAttribArray(_particle_loc);
+    glEnableVertexAttribArray(_color_loc);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+ParticleSystem::Emitter& ParticleSystem::emitter()
+{
+    return _emitter;
+}
+
+const ParticleSystem::Emitter& ParticleSystem::emitter() const
+{
+    return _emitter;
+}
+
+void ParticleSystem::emit(std::size_t count)
+{
+    count = std::min(count, _capacity - _count);
+    std::uint32_t color = _emitter.color.r | (_emitter.color.g << 8) | (_emitter.color.b << 16) | (_emitter.color.a << 24);
+    for (std::size_t i = _count; i < _count + count; ++i)
+    {
+        float angle = glm::radians(random(_emitter.min_angle, _emitter.max_angle));
+        float speed = random(_emitter.min_speed, _emitter.max_speed);
+        _x[i] = 0.f;
+        _y[i] = 0.f;
+        _vx[i] = std::cos(angle) * speed;
+        _vy[i] = std::sin(angle) * speed;
+        _age[i] = 0.f;
+        _lifetime[i] = random(_emitter.min_lifetime, _emitter.max_lifetime);
+        _color[i] = color;
+    }
+    _count += count;
+}
+
+void ParticleSystem::setParticleSize(float size)
+{
+    _particle_size = size;
+}
+
+float ParticleSystem::getParticleSize() const
+{
+    return _particle_size;
+}
+
+void ParticleSystem::setMultithreaded(bool multithreaded)
+{
+    _multithreaded = multithreaded;
+}
+
+std::size_t ParticleSystem::count() const
+{
+    return _count;
+}
+
+std::size_t ParticleSystem::capacity() const
+{
+    return _capacity;
+}
+
+void ParticleSystem::draw()
+{
+    glBindVertexArray(_VAO);
+    RenderStatistics::countVertexArray(_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    if (!_uploaded && _count > 0)
+    {
+        // Invalidating the whole buffer lets the driver hand out fresh memory
+        // instead of waiting for the previous frame's draw.
+        Instance_t* instances = static_cast<Instance_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0,
+                    _count * sizeof(Instance_t), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (instances != nullptr)
+        {
+            if (_multithreaded && _job_system != nullptr)
+            {
+                _job_system->parallelFor(_count, PARALLEL_GRAIN,
+                        [this, instances](std::size_t begin, std::size_t end) { writeInstances(instances, begin, end); });
+            }
+            else
+            {
+                writeInstances(instances, 0, _count);
+            }
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            RenderStatistics::countBufferUpload(_count * sizeof(Instance_t));
+        }
+        _uploaded = true;
+    }
+    shaderProgram()->setUniform1f("particle_size", _particle_size);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, _count);
+    RenderStatistics::countInstancedBatch();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+const char* ParticleSystem::behaviorName()
+{
+    return "rendering::ParticleSystem";
+}
+
+void ParticleSystem::integrate(std::size_t begin, std::size_t end, float dt)
+{
+    float dvx = _emitter.acceleration_x * dt;
+    float dvy = _emitter.acceleration_y * dt;
+    std::size_t i = begin;
+#ifdef __SSE2__
+    __m128 v_dt = _mm_set1_ps(dt);
+    __m128 v_dvx = _mm_set1_ps(dvx);
+    __m128 v_dvy = _mm_set1_ps(dvy);
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(&_vx[i]);
+        __m128 vy = _mm_loadu_ps(&_vy[i]);
+        _mm_storeu_ps(&_x[i], _mm_add_ps(_mm_loadu_ps(&_x[i]), _mm_mul_ps(vx, v_dt)));
+        _mm_storeu_ps(&_y[i], _mm_add_ps(_mm_loadu_ps(&_y[i]), _mm_mul_ps(vy, v_dt)));
+        _mm_storeu_ps(&_vx[i], _mm_add_ps(vx, v_dvx));
+        _mm_storeu_ps(&_vy[i], _mm_add_ps(vy, v_dvy));
+        _mm_storeu_ps(&_age[i], _mm_add_ps(_mm_loadu_ps(&_age[i]), v_dt));
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        _x[i] += _vx[i] * dt;
+        _y[i] += _vy[i] * dt;
+        _vx[i] += dvx;
+        _vy[i] += dvy;
+        _age[i] += dt;
+    }
+}
+
+void ParticleSystem::writeInstances(Instance_t* instances, std::size_t begin, std::size_t end) const
+{
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        instances[i].x = _x[i];
+        instances[i].y = _y[i];
+        instances[i].t = _age[i] / _lifetime[i];
+        instances[i].color = _color[i];
+    }
+}
+
+float ParticleSystem::random(float min, float max)
+{
+    // xorshift32
+    _random_state ^= _random_state << 13;
+    _random_state ^= _random_state >> 17;
+    _random_state ^= _random_state << 5;
+    return min + (max - min) * (_random_state >> 8) * (1.f / 16777216.f);
+}
+}
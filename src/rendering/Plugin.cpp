@@ -1,29 +1,90 @@
+#include <cmath>
+#include "rendering/GLCapture.hpp"
+#include "rendering/Material.hpp"
 #include "rendering/Plugin.hpp"
+#include "rendering/ShaderPermutations.hpp"
 
 namespace rendering
 {
 void defaultSpaceTransform(const hum::Game& game, hum::Transformation& r)
 {}
 
+namespace
+{
+// Transformations per range when the space transformation runs in parallel
+const std::size_t SPACE_TRANSFORM_GRAIN = 1024;
+
+bool sameTransformation(const hum::Transformation& a, const hum::Transformation& b)
+{
+    return a.position == b.position && a.rotation == b.rotation && a.scale == b.scale;
+}
 
-Plugin::Plugin():
+// Milliseconds since the last lap
+float lap(hum::Clock& clock)
+{
+    float milliseconds = clock.getTime().asMicroseconds() / 1000.f;
+    clock.reset();
+    return milliseconds;
+}
+}
+
+
+Plugin::Plugin(bool headless):
+_sdl_plugin(nullptr),
 _clear_color(0,0,0,1),
+_headless(headless),
 _game_started(false),
-_space_transform(defaultSpaceTransform)
-{}
+_uploaded_camera(nullptr),
+_current_view(nullptr),
+_current_model(nullptr),
+_space_transform_identity(true),
+_parallel_space_transform(false),
+_job_system(nullptr),
+_kinematic_system(nullptr),
+_fixed_tick(0),
+_hierarchy_dirty(false),
+_lod_hysteresis(0.1f),
+_shader_warm_up(1),
+_gpu_driven(false),
+_static_cell_size(256.f),
+_occlusion_culling(false),
+_dynamic_resolution_enabled(false)
+{
+    _views.emplace_back(new View());
+}
 
 
 void Plugin::gameStart()
 {
+    if (!_headless)
+    {
+        try {
+            _sdl_plugin = game().getPlugin<SDLPlugin>();
+        } catch(hum::exception::PluginNotFound exception) {
+            hum::log_e("Plugin SDLPlugin not found. Required for rendering::Plugin unless headless.");
+            throw exception;
+        }
+    }
+    try {
+        _job_system = game().getPlugin<JobSystem>();
+    } catch(hum::exception::PluginNotFound exception) {
+        _job_system = nullptr;
+    }
     try {
-        _sdl_plugin = game().getPlugin<SDLPlugin>();
+        _kinematic_system = game().getPlugin<KinematicSystem>();
     } catch(hum::exception::PluginNotFound exception) {
-        hum::log_e("Plugin SDLPlugin not found. Required for rendering::Plugin.");
-        throw exception;
+        _kinematic_system = nullptr;
     }
     _game_started = true;
+    if (_headless)
+    {
+        return;
+    }
     glewExperimental = GL_TRUE;
     glewInit();
+    GLCapture::install();
+    _impostor_batch.reset(new ImpostorBatch(this));
+    addBatch(_impostor_batch.get());
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_TEXTURE_2D);
     glEnable(GL_BLEND);
@@ -32,89 +93,684 @@ void Plugin::gameStart()
 }
 
 
+void Plugin::postFixedUpdate()
+{
+    ++_fixed_tick;
+}
+
+
 void Plugin::postUpdate()
+{
+    if (_headless)
+    {
+        RenderStatistics::current().drawables_registered = _nodes.size();
+        _statistics.endFrame();
+        return;
+    }
+    int window_width, window_height;
+    SDL_GL_GetDrawableSize(_sdl_plugin->window(), &window_width, &window_height);
+    FrameStatistics_t& statistics = RenderStatistics::current();
+    _stage_clock.reset();
+
+    if (_gpu_driven && _indirect_renderer == nullptr)
+    {
+        if (IndirectRenderer::isSupported())
+        {
+            _indirect_renderer.reset(new IndirectRenderer());
+        }
+        else
+        {
+            hum::log_w("The GPU-driven path of rendering::Plugin needs OpenGL 4.3, disabled");
+            _gpu_driven = false;
+        }
+    }
+    prepareDrawables();
+    Material::upload();
+    _texture_manager.update();
+    if (_indirect_renderer != nullptr)
+    {
+        _indirect_renderer->upload();
+    }
+    statistics.drawables_registered = _nodes.size();
+    statistics.prepare_ms = lap(_stage_clock);
+
+    // Views are grouped by target: one pass per RenderTarget plus one for the window
+    std::vector<View*> window_views;
+    std::vector<std::pair<RenderTarget*, std::vector<View*>>> target_views;
+    for (auto& view : _views)
+    {
+        if (!view->isEnabled())
+        {
+            continue;
+        }
+        RenderTarget* target = view->getTarget();
+        if (target == nullptr)
+        {
+            window_views.push_back(view.get());
+            continue;
+        }
+        auto it = std::find_if(target_views.begin(), target_views.end(),
+                [target](const std::pair<RenderTarget*, std::vector<View*>>& value) { return value.first == target; });
+        if (it == target_views.end())
+        {
+            target_views.push_back(std::make_pair(target, std::vector<View*>()));
+            it = target_views.end() - 1;
+        }
+        it->second.push_back(view.get());
+    }
+
+    _render_graph.reset();
+    for (auto& value : target_views)
+    {
+        RenderTarget* target = value.first;
+        std::vector<View*> views = value.second;
+        std::string name = "target_" + std::to_string(target->framebuffer());
+        RenderGraph::Resource resource = _render_graph.importFramebuffer(name, target->framebuffer(),
+                target->width(), target->height());
+        _render_graph.addPass(name, {}, {resource},
+                [this, views, target](RenderGraph&) { drawViews(views, target->width(), target->height()); });
+    }
+
+    RenderGraph::Resource backbuffer = _render_graph.importBackbuffer("backbuffer", window_width, window_height);
+    if (_dynamic_resolution_enabled)
+    {
+        // The targets are declared at the biggest scale and only the viewport
+        // changes, so changing the scale never reallocates them.
+        int target_width = std::max(1, static_cast<int>(window_width * _dynamic_resolution.getMaxScale()));
+        int target_height = std::max(1, static_cast<int>(window_height * _dynamic_resolution.getMaxScale()));
+        int render_width = std::max(1, std::min(target_width, static_cast<int>(window_width * _dynamic_resolution.scale())));
+        int render_height = std::max(1, std::min(target_height, static_cast<int>(window_height * _dynamic_resolution.scale())));
+        RenderGraph::Resource color = _render_graph.createTexture("scene_color", {target_width, target_height, GL_RGBA8});
+        RenderGraph::Resource depth = _render_graph.createTexture("scene_depth", {target_width, target_height, GL_DEPTH_COMPONENT24});
+
+        _render_graph.addPass("scene", {}, {color, depth},
+                [this, window_views, render_width, render_height](RenderGraph&)
+                {
+                    _gpu_timer.begin();
+                    drawViews(window_views, render_width, render_height);
+                    _gpu_timer.end();
+                });
+        _render_graph.addPass("upscale", {color}, {backbuffer},
+                [=](RenderGraph& graph)
+                {
+                    glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.framebuffer({color}));
+                    GLenum filter = (render_width == window_width && render_height == window_height) ? GL_NEAREST : GL_LINEAR;
+                    glBlitFramebuffer(0, 0, render_width, render_height, 0, 0, window_width, window_height,
+                            GL_COLOR_BUFFER_BIT, filter);
+                });
+    }
+    else
+    {
+        _render_graph.addPass("scene", {}, {backbuffer},
+                [this, window_views, window_width, window_height](RenderGraph&)
+                {
+                    drawViews(window_views, window_width, window_height);
+                });
+    }
+    _render_graph.compile();
+    _render_graph.execute();
+    glBindVertexArray(0);
+    statistics.draw_ms = lap(_stage_clock);
+
+    if (_dynamic_resolution_enabled)
+    {
+        _dynamic_resolution.update(_gpu_timer.milliseconds());
+    }
+    SDL_GL_SwapWindow(_sdl_plugin->window());
+    GLCapture::endFrame(window_width, window_height);
+    statistics.present_ms = lap(_stage_clock);
+    // Right after the swap the GPU is busy with this frame, a good time to compile ahead
+    ShaderPermutations::warmUpAll(_shader_warm_up);
+    statistics.frame_ms = statistics.prepare_ms + statistics.draw_ms + statistics.present_ms + lap(_stage_clock);
+    _statistics.endFrame();
+}
+
+
+void Plugin::prepareDrawables()
+{
+    // Interpolate every actor once, no matter how many drawables it has.
+    // Kinematic results stay valid until the next fixed update or lag change.
+    long long lag = game().fixedUpdateLag().asMicroseconds();
+    if (_kinematic_system != nullptr)
+    {
+        // Interpolates every KinematicBody in one batch
+        _kinematic_system->simulate(game().fixedUpdateLag());
+    }
+    for (ActorTransform_t& actor_transform : _actor_transforms)
+    {
+        if (actor_transform.actor == nullptr)
+        {
+            continue;
+        }
+        actor_transform.changed = false;
+        if (actor_transform.kinematic == nullptr && actor_transform.body == nullptr)
+        {
+            const hum::Transformation& transform = actor_transform.actor->transform();
+            if (!actor_transform.valid || !sameTransformation(transform, actor_transform.transform))
+            {
+                actor_transform.transform = transform;
+                actor_transform.valid = true;
+                actor_transform.changed = true;
+            }
+        }
+        else if (!actor_transform.valid || actor_transform.tick != _fixed_tick || actor_transform.lag != lag)
+        {
+            actor_transform.transform = actor_transform.body != nullptr ? actor_transform.body->simulated() :
+                actor_transform.kinematic->simulate(game().fixedUpdateLag());
+            actor_transform.valid = true;
+            actor_transform.changed = true;
+            actor_transform.tick = _fixed_tick;
+            actor_transform.lag = lag;
+        }
+    }
+
+    if (_hierarchy_dirty)
+    {
+        buildHierarchy();
+    }
+
+    // Parents come before their children, so one pass propagates the changes
+    _prepared.clear();
+    _transforms.clear();
+    for (unsigned int i = 0; i < _nodes.size(); ++i)
+    {
+        Node_t& node = _nodes[i];
+        Drawable* drawable = node.drawable;
+        const ActorTransform_t& actor_transform = _actor_transforms[node.actor_slot];
+        bool parent_changed = node.parent == -1 ? actor_transform.changed : _nodes[node.parent].changed;
+        node.changed = node.dirty || drawable->_transform_changed || parent_changed;
+        if (node.changed)
+        {
+            const hum::Transformation& parent_world = node.parent == -1 ? actor_transform.transform : _nodes[node.parent].world;
+            node.world = static_cast<const Drawable*>(drawable)->transform().transform(parent_world);
+            node.dirty = false;
+            drawable->_transform_changed = false;
+        }
+        node.prepared = -1;
+        if (drawable->isEnabled())
+        {
+            node.prepared = _prepared.size();
+            _transforms.push_back(node.world);
+            _prepared.push_back(Prepared_t{drawable, i, glm::mat4()});
+        }
+        else
+        {
+            // node.model is only refreshed for the drawn nodes, so the one
+            // of a moved node is rebuilt when it is enabled again
+            if (node.changed)
+            {
+                node.dirty = true;
+            }
+            if (node.indirect_slot >= 0)
+            {
+                _indirect_renderer->release(node.indirect_slot);
+                node.indirect_slot = -1;
+            }
+            if (node.static_slot >= 0)
+            {
+                _static_batcher->release(node.static_slot);
+                node.static_slot = -1;
+            }
+        }
+    }
+
+    if (!_space_transform_identity && !_transforms.empty())
+    {
+        if (_parallel_space_transform && _job_system != nullptr)
+        {
+            _job_system->parallelFor(_transforms.size(), SPACE_TRANSFORM_GRAIN,
+                    [this](std::size_t begin, std::size_t end)
+                    {
+                        _space_transform(game(), _transforms.data() + begin, end - begin);
+                    });
+        }
+        else
+        {
+            _space_transform(game(), _transforms.data(), _transforms.size());
+        }
+    }
+
+    for (unsigned int i = 0; i < _prepared.size(); ++i)
+    {
+        Node_t& node = _nodes[_prepared[i].node];
+        if (_space_transform_identity && !node.changed)
+        {
+            _prepared[i].model = node.model;
+            continue;
+        }
+        const hum::Transformation& transform = _transforms[i];
+        Drawable* drawable = _prepared[i].drawable;
+        glm::mat4 model(1.0);
+        model = glm::translate(model, glm::vec3(transform.position.x, transform.position.y, transform.position.z));
+        model = glm::rotate(model, glm::radians(static_cast<float>(transform.rotation.x)), glm::vec3(1., 0., 0.));
+        model = glm::rotate(model, glm::radians(static_cast<float>(transform.rotation.y)), glm::vec3(0., 1., 0.));
+        model = glm::rotate(model, glm::radians(static_cast<float>(transform.rotation.z)), glm::vec3(0., 0., 1.));
+        model = glm::scale(model, glm::vec3(transform.scale.x, transform.scale.y, transform.scale.z));
+        glm::vec3 origin(drawable->getOrigin().x, drawable->getOrigin().y, drawable->getOrigin().z);
+        model = glm::translate(model, -origin);
+        _prepared[i].model = model;
+        node.model = model;
+    }
+
+    prepareBatched();
+}
+
+
+void Plugin::prepareBatched()
+{
+    _cpu_drawn.clear();
+    for (unsigned int i = 0; i < _prepared.size(); ++i)
+    {
+        Node_t& node = _nodes[_prepared[i].node];
+        Drawable* drawable = _prepared[i].drawable;
+        unsigned int material;
+        bool opaque = false;
+        bool batchable = drawable->_lod_owner == nullptr && drawable->_levels.empty()
+            && drawable->_impostor_screen_size <= 0.f && drawable->unitQuadMaterial(material)
+            && drawable->coversUnitQuad(opaque);
+        // Both are drawn unsorted before the others: translucent quads would
+        // hide what they blend over
+        bool baked = batchable && opaque && drawable->isStatic();
+        bool indirect = batchable && opaque && !baked && _indirect_renderer != nullptr;
+        if (!baked && node.static_slot >= 0)
+        {
+            _static_batcher->release(node.static_slot);
+            node.static_slot = -1;
+        }
+        if (!indirect && node.indirect_slot >= 0)
+        {
+            _indirect_renderer->release(node.indirect_slot);
+            node.indirect_slot = -1;
+        }
+        if (baked)
+        {
+            if (_static_batcher == nullptr)
+            {
+                _static_batcher.reset(new StaticBatcher(_static_cell_size));
+            }
+            // A cell is only re-baked when one of its members changed
+            if (node.static_slot < 0)
+            {
+                node.static_slot = _static_batcher->acquire();
+                _static_batcher->set(node.static_slot, _prepared[i].model, material);
+            }
+            else if (node.changed || !_space_transform_identity || _static_batcher->material(node.static_slot) != material)
+            {
+                _static_batcher->set(node.static_slot, _prepared[i].model, material);
+            }
+        }
+        else if (indirect)
+        {
+            // Only what changed is uploaded
+            if (node.indirect_slot < 0)
+            {
+                node.indirect_slot = _indirect_renderer->acquire();
+                _indirect_renderer->set(node.indirect_slot, _prepared[i].model, material);
+            }
+            else if (node.changed || !_space_transform_identity || _indirect_renderer->material(node.indirect_slot) != material)
+            {
+                _indirect_renderer->set(node.indirect_slot, _prepared[i].model, material);
+            }
+        }
+        else
+        {
+            _cpu_drawn.push_back(i);
+        }
+    }
+}
+
+
+void Plugin::buildHierarchy()
+{
+    // Breadth first: roots, then every level right after the previous one
+    std::vector<Node_t> nodes;
+    nodes.reserve(_nodes.size());
+    for (const Node_t& node : _nodes)
+    {
+        Drawable* parent = node.drawable->getParent();
+        if (parent == nullptr || _node_index.find(parent) == _node_index.end())
+        {
+            nodes.push_back(node);
+            nodes.back().parent = -1;
+        }
+    }
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+    {
+        for (Drawable* child : nodes[i].drawable->children())
+        {
+            auto it = _node_index.find(child);
+            if (it != _node_index.end())
+            {
+                nodes.push_back(_nodes[it->second]);
+                nodes.back().parent = i;
+            }
+        }
+    }
+
+    _nodes.swap(nodes);
+    for (unsigned int i = 0; i < _nodes.size(); ++i)
+    {
+        _nodes[i].dirty = true;
+        _node_index[_nodes[i].drawable] = i;
+    }
+    _hierarchy_dirty = false;
+}
+
+
+void Plugin::drawViews(const std::vector<View*>& views, int width, int height)
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    if (_camera.projectionChanged())
+    for (unsigned int i = 0; i < views.size(); ++i)
+    {
+        const glm::vec4& viewport = views[i]->getViewport();
+        GLint x = static_cast<GLint>(viewport.x * width);
+        GLint y = static_cast<GLint>((1.f - viewport.y - viewport.w) * height);
+        GLsizei w = static_cast<GLsizei>(viewport.z * width);
+        GLsizei h = static_cast<GLsizei>(viewport.w * height);
+        glViewport(x, y, w, h);
+        if (i > 0)
+        {
+            // Views drawn on top of others only get their own depth
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(x, y, w, h);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            glDisable(GL_SCISSOR_TEST);
+        }
+        drawView(*views[i], h);
+    }
+}
+
+
+void Plugin::drawView(View& view, int height)
+{
+    Camera& camera = view.camera();
+    bool camera_switched = &camera != _uploaded_camera;
+    if (camera_switched || camera.projectionChanged())
     {
         for (auto it : _shader_program_usage)
         {
             it.first->use();
-            it.first->setUniformMatrix4f("projection", _camera.getProjection());
+            it.first->setUniformMatrix4f("projection", camera.getProjection());
         }
     }
-    if (_camera.viewChanged())
+    if (camera_switched || camera.viewChanged())
     {
         for (auto it : _shader_program_usage)
         {
             it.first->use();
-            it.first->setUniformMatrix4f("view", _camera.getView());
+            it.first->setUniformMatrix4f("view", camera.getView());
         }
     }
+    _uploaded_camera = &camera;
+    _current_view = &view;
 
-    glm::vec3 camera_position = humToGlm(_camera.getPosition());
-    glm::vec3 camera_normal = humToGlm(_camera.getCenter()) - camera_position;
+    glm::vec3 camera_position = humToGlm(camera.getPosition());
+    glm::vec3 camera_normal = humToGlm(camera.getCenter()) - camera_position;
     glm::vec4 camera_plane(camera_normal, -(glm::dot(camera_normal, camera_position)));
 
-    std::vector<DrawOrder_t> draw_order;
-    for (Drawable* drawable : _drawable_set)
+    if (_static_batcher != nullptr)
     {
-        hum::Transformation drawable_transform = drawable->transform();
-        const hum::Kinematic* kinematic = _drawable_kinematic[drawable];
-        hum::Transformation actor_transform;
-        if (kinematic != nullptr)
-        {
-            actor_transform = kinematic->simulate(game().fixedUpdateLag());
-        }
-        else
+        _static_batcher->draw(camera);
+    }
+    if (_indirect_renderer != nullptr)
+    {
+        _indirect_renderer->draw(camera);
+    }
+
+    _draw_order.clear();
+    unsigned int candidates = 0;
+    for (unsigned int i : _cpu_drawn)
+    {
+        if (_prepared[i].drawable->_lod_owner != nullptr)
         {
-            actor_transform = drawable->actor().transform();
+            // Levels of detail are only drawn in place of their owner
+            continue;
         }
-        drawable_transform = drawable_transform.transform(actor_transform);
-
-        _space_transform(game(), drawable_transform);
-
+        ++candidates;
+        const hum::Transformation& transform = _transforms[i];
         double distance_from_camera = glm::dot(
                 camera_plane,
                 glm::vec4(
-                    drawable_transform.position.x,
-                    drawable_transform.position.y,
-                    drawable_transform.position.z,
+                    transform.position.x,
+                    transform.position.y,
+                    transform.position.z,
                     1.f)
                 );
-        if (distance_from_camera <= _camera.getZFar() && distance_from_camera >= _camera.getZNear())
+        if (distance_from_camera <= camera.getZFar() && distance_from_camera >= camera.getZNear())
         {
-            draw_order.push_back(DrawOrder_t{distance_from_camera, drawable_transform, drawable});
+            _draw_order.push_back(DrawOrder_t{distance_from_camera, i});
         }
     }
 
-    std::sort(draw_order.begin(), draw_order.end(), [](const DrawOrder_t& left, const DrawOrder_t& right) { return left.order > right.order; });
+    RenderStatistics::current().drawables_culled += candidates - _draw_order.size();
+    if (_occlusion_culling)
+    {
+        cullOccluded(camera);
+    }
+
+    std::sort(_draw_order.begin(), _draw_order.end(), [](const DrawOrder_t& left, const DrawOrder_t& right) { return left.order > right.order; });
+    RenderStatistics::current().drawables_visible += _draw_order.size();
 
-    for (DrawOrder_t& value : draw_order)
+    const glm::mat4& projection = camera.getProjection();
+    const glm::mat4& view_matrix = camera.getView();
+    glm::vec3 camera_right(view_matrix[0][0], view_matrix[1][0], view_matrix[2][0]);
+    glm::vec3 camera_up(view_matrix[0][1], view_matrix[1][1], view_matrix[2][1]);
+    for (DrawOrder_t& value : _draw_order)
     {
-        Drawable* drawable = value.drawable;
+        Prepared_t* prepared = &_prepared[value.index];
+        Drawable* drawable = prepared->drawable;
         hum::assert_msg(drawable != nullptr, "Found a drawable nullptr");
-        hum::Transformation& transform = value.transform;
+
+        if (drawable->_bounds_radius > 0.f && (!drawable->_levels.empty() || drawable->_impostor_screen_size > 0.f))
+        {
+            const hum::Transformation& transform = _transforms[value.index];
+            float scale = std::max(std::abs(transform.scale.x), std::max(std::abs(transform.scale.y), std::abs(transform.scale.z)));
+            float radius = drawable->_bounds_radius * scale;
+            glm::vec3 center(prepared->model * glm::vec4(humToGlm(drawable->_bounds_center), 1.f));
+            // Clip w is the depth in perspective and 1 in orthogonal projections
+            float w = (projection * view_matrix * glm::vec4(center, 1.f)).w;
+            float screen_size = w > 0.f ? radius * projection[1][1] / w : 0.f;
+            unsigned int level = selectLevelOfDetail(*drawable, screen_size);
+            if (level > drawable->_levels.size())
+            {
+                _impostor_batch->add(center, radius, camera_right, camera_up, drawable->_impostor_color);
+                continue;
+            }
+            if (level > 0)
+            {
+                Drawable* level_drawable = drawable->_levels[level - 1].drawable;
+                auto node_it = _node_index.find(level_drawable);
+                if (node_it != _node_index.end() && _nodes[node_it->second].prepared >= 0)
+                {
+                    prepared = &_prepared[_nodes[node_it->second].prepared];
+                    drawable = level_drawable;
+                }
+            }
+        }
         hum::assert_msg(drawable->shaderProgram() != nullptr, "Found a drawable without a shader program");
 
-        glm::mat4 model(1.0);
-        model = glm::translate(model, glm::vec3(transform.position.x, transform.position.y, transform.position.z));
-        model = glm::rotate(model, glm::radians(static_cast<float>(transform.rotation.x)), glm::vec3(1., 0., 0.));
-        model = glm::rotate(model, glm::radians(static_cast<float>(transform.rotation.y)), glm::vec3(0., 1., 0.));
-        model = glm::rotate(model, glm::radians(static_cast<float>(transform.rotation.z)), glm::vec3(0., 0., 1.));
-        model = glm::scale(model, glm::vec3(transform.scale.x, transform.scale.y, transform.scale.z));
-        glm::vec3 origin(drawable->getOrigin().x, drawable->getOrigin().y, drawable->getOrigin().z);
-        model = glm::translate(model, -origin);
+        if (Texture* texture = drawable->texture())
+        {
+            // Pixels covered by the longest side of the unit quad
+            const glm::mat4& model = prepared->model;
+            float side = std::max(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])));
+            float w = (projection * view_matrix * model * glm::vec4(0.5f, 0.5f, 0.f, 1.f)).w;
+            _texture_manager.touch(texture, w > 0.f ? side * projection[1][1] / w * height * 0.5f : 0.f);
+        }
+
         drawable->shaderProgram()->use();
-        drawable->shaderProgram()->setUniformMatrix4f("model", model);
+        drawable->shaderProgram()->setUniformMatrix4f("model", prepared->model);
+        _current_model = &prepared->model;
         drawable->draw();
     }
-    glBindVertexArray(0);
-    SDL_GL_SwapWindow(_sdl_plugin->window());
+    _current_model = nullptr;
+    for (Batch* batch : _batches)
+    {
+        batch->flush();
+    }
+    _current_view = nullptr;
 }
 
 
 
+void Plugin::cullOccluded(Camera& camera)
+{
+    _occlusion_culler.begin(camera.getProjection() * camera.getView());
+    for (unsigned int i = 0; i < _prepared.size(); ++i)
+    {
+        bool opaque = false;
+        const Drawable* drawable = _prepared[i].drawable;
+        if (drawable->_lod_owner == nullptr && drawable->coversUnitQuad(opaque) && opaque)
+        {
+            _occlusion_culler.addOccluder(_prepared[i].model);
+        }
+    }
+    _occlusion_culler.build();
+    if (_occlusion_culler.occluderCount() == 0)
+    {
+        return;
+    }
+
+    std::size_t in_range = _draw_order.size();
+    _draw_order.erase(std::remove_if(_draw_order.begin(), _draw_order.end(),
+                [this](const DrawOrder_t& value)
+                {
+                    const Prepared_t& prepared = _prepared[value.index];
+                    const Drawable* drawable = prepared.drawable;
+                    bool opaque;
+                    if (drawable->_bounds_radius > 0.f)
+                    {
+                        const hum::Transformation& transform = _transforms[value.index];
+                        float scale = std::max(std::abs(transform.scale.x), std::max(std::abs(transform.scale.y), std::abs(transform.scale.z)));
+                        glm::vec3 center(prepared.model * glm::vec4(humToGlm(drawable->_bounds_center), 1.f));
+                        return _occlusion_culler.isSphereOccluded(center, drawable->_bounds_radius * scale);
+                    }
+                    return drawable->coversUnitQuad(opaque) && _occlusion_culler.isQuadOccluded(prepared.model);
+                }),
+            _draw_order.end());
+    RenderStatistics::current().drawables_occluded += in_range - _draw_order.size();
+}
+
+
+unsigned int Plugin::selectLevelOfDetail(Drawable& drawable, float screen_size)
+{
+    std::size_t level_count = drawable._levels.size() + (drawable._impostor_screen_size > 0.f ? 1 : 0);
+    auto threshold = [&drawable](std::size_t level)
+    {
+        return level <= drawable._levels.size() ? drawable._levels[level - 1].screen_size : drawable._impostor_screen_size;
+    };
+    // A level is only left once the size is past its threshold by the
+    // hysteresis, so objects around a threshold don't pop every frame
+    unsigned int level = std::min<std::size_t>(drawable._lod_level, level_count);
+    while (level < level_count && screen_size < threshold(level + 1) * (1.f - _lod_hysteresis))
+    {
+        ++level;
+    }
+    while (level > 0 && screen_size > threshold(level) * (1.f + _lod_hysteresis))
+    {
+        --level;
+    }
+    drawable._lod_level = level;
+    return level;
+}
+
+
+void Plugin::setLODHysteresis(float hysteresis)
+{
+    _lod_hysteresis = hysteresis;
+}
+
+
+float Plugin::getLODHysteresis() const
+{
+    return _lod_hysteresis;
+}
+
+
+void Plugin::setGpuDriven(bool enabled)
+{
+    _gpu_driven = enabled;
+    if (!enabled && _indirect_renderer != nullptr)
+    {
+        for (Node_t& node : _nodes)
+        {
+            node.indirect_slot = -1;
+        }
+        _indirect_renderer.reset();
+    }
+}
+
+
+bool Plugin::isGpuDriven() const
+{
+    return _gpu_driven;
+}
+
+
+void Plugin::setStaticCellSize(float cell_size)
+{
+    _static_cell_size = cell_size;
+    if (_static_batcher != nullptr)
+    {
+        _static_batcher->setCellSize(cell_size);
+    }
+}
+
+
+float Plugin::getStaticCellSize() const
+{
+    return _static_cell_size;
+}
+
+
+void Plugin::setOcclusionCulling(bool enabled)
+{
+    _occlusion_culling = enabled;
+}
+
+
+bool Plugin::isOcclusionCullingEnabled() const
+{
+    return _occlusion_culling;
+}
+
+
+OcclusionCuller& Plugin::occlusionCuller()
+{
+    return _occlusion_culler;
+}
+
+
+const OcclusionCuller& Plugin::occlusionCuller() const
+{
+    return _occlusion_culler;
+}
+
+
+TextureManager& Plugin::textureManager()
+{
+    return _texture_manager;
+}
+
+
+const TextureManager& Plugin::textureManager() const
+{
+    return _texture_manager;
+}
+
+
+void Plugin::setShaderWarmUp(unsigned int variants_per_frame)
+{
+    _shader_warm_up = variants_per_frame;
+}
+
+
+unsigned int Plugin::getShaderWarmUp() const
+{
+    return _shader_warm_up;
+}
+
+
 void Plugin::setClearColor(const Color& color)
 {
     _clear_color = color;
@@ -131,42 +787,69 @@ void Plugin::setClearColor(const Color& color)
 
 void Plugin::setCamera(const Camera& camera)
 {
-    _camera = camera;
+    _views.front()->camera() = camera;
+    _uploaded_camera = nullptr;
 }
 
 
 const Camera& Plugin::getCamera() const
 {
-    return _camera;
+    return _views.front()->camera();
 }
 
 
 Camera& Plugin::getCamera()
 {
-    return _camera;
+    return _views.front()->camera();
 }
 
 
-void Plugin::addDrawable(Drawable* drawable)
+View* Plugin::addView()
 {
-    _drawable_set.insert(drawable);
-    try
-    {
-        _drawable_kinematic[drawable] = drawable->actor().getBehavior<hum::Kinematic>();
-    }
-    catch (hum::exception::BehaviorNotFound e)
-    {
-        _drawable_kinematic[drawable] = nullptr;
-    }
+    _views.emplace_back(new View());
+    return _views.back().get();
+}
+
+
+void Plugin::removeView(View* view)
+{
+    hum::assert_msg(view != _views.front().get(), "The main view of rendering::Plugin can't be removed");
+    _views.erase(std::remove_if(_views.begin(), _views.end(),
+                [view](const std::unique_ptr<View>& value) { return value.get() == view; }),
+            _views.end());
+    _uploaded_camera = nullptr;
+}
+
+
+View& Plugin::mainView()
+{
+    return *_views.front();
+}
 
+
+View& Plugin::currentView()
+{
+    hum::assert_msg(_current_view != nullptr, "rendering::Plugin::currentView() called outside of a draw");
+    return *_current_view;
+}
+
+
+const glm::mat4& Plugin::currentModelMatrix() const
+{
+    hum::assert_msg(_current_model != nullptr, "rendering::Plugin::currentModelMatrix() called outside of a draw");
+    return *_current_model;
+}
+
+
+void Plugin::addDrawable(Drawable* drawable)
+{
     if (drawable->shaderProgram())
     {
         if (_shader_program_usage.find(drawable->shaderProgram()) == _shader_program_usage.end())
         {
             _shader_program_usage.insert(std::make_pair(drawable->shaderProgram(), 0));
-            drawable->shaderProgram()->use();
-            drawable->shaderProgram()->setUniformMatrix4f("projection", _camera.getProjection());
-            drawable->shaderProgram()->setUniformMatrix4f("view", _camera.getView());
+            // The new program needs the camera matrices on the next frame
+            _uploaded_camera = nullptr;
         }
 
         _shader_program_usage[drawable->shaderProgram()] += 1;
@@ -176,9 +859,6 @@ void Plugin::addDrawable(Drawable* drawable)
 
 void Plugin::removeDrawable(Drawable* drawable)
 {
-    _drawable_set.erase(drawable);
-    _drawable_kinematic.erase(drawable);
-
     if (drawable->shaderProgram())
     {
         _shader_program_usage[drawable->shaderProgram()] -= 1;
@@ -191,8 +871,198 @@ void Plugin::removeDrawable(Drawable* drawable)
 }
 
 
+void Plugin::addNode(Drawable* drawable)
+{
+    if (_node_index.find(drawable) != _node_index.end())
+    {
+        return;
+    }
+
+    const hum::Actor* actor = &drawable->actor();
+    auto slot_it = _actor_slots.find(actor);
+    unsigned int slot;
+    if (slot_it != _actor_slots.end())
+    {
+        slot = slot_it->second;
+    }
+    else
+    {
+        const hum::Kinematic* kinematic;
+        try
+        {
+            kinematic = drawable->actor().getBehavior<hum::Kinematic>();
+        }
+        catch (hum::exception::BehaviorNotFound e)
+        {
+            kinematic = nullptr;
+        }
+        const KinematicBody* body;
+        try
+        {
+            body = drawable->actor().getBehavior<KinematicBody>();
+        }
+        catch (hum::exception::BehaviorNotFound e)
+        {
+            body = nullptr;
+        }
+        if (_free_actor_slots.empty())
+        {
+            slot = _actor_transforms.size();
+            _actor_transforms.push_back(ActorTransform_t());
+        }
+        else
+        {
+            slot = _free_actor_slots.back();
+            _free_actor_slots.pop_back();
+        }
+        _actor_transforms[slot] = ActorTransform_t{actor, kinematic, body, 0, false, false, 0, 0, hum::Transformation()};
+        _actor_slots[actor] = slot;
+    }
+    _actor_transforms[slot].drawables += 1;
+
+    _node_index[drawable] = _nodes.size();
+    _nodes.push_back(Node_t{drawable, -1, slot, true, false, -1, -1, -1, hum::Transformation(), glm::mat4(1.0)});
+    _hierarchy_dirty = true;
+}
+
+
+void Plugin::removeNode(Drawable* drawable)
+{
+    auto index_it = _node_index.find(drawable);
+    if (index_it == _node_index.end())
+    {
+        return;
+    }
+    unsigned int index = index_it->second;
+    unsigned int slot = _nodes[index].actor_slot;
+    if (_nodes[index].indirect_slot >= 0)
+    {
+        _indirect_renderer->release(_nodes[index].indirect_slot);
+    }
+    if (_nodes[index].static_slot >= 0)
+    {
+        _static_batcher->release(_nodes[index].static_slot);
+    }
+    _node_index.erase(index_it);
+    if (index != _nodes.size() - 1)
+    {
+        _nodes[index] = _nodes.back();
+        _node_index[_nodes[index].drawable] = index;
+    }
+    _nodes.pop_back();
+    _hierarchy_dirty = true;
+
+    ActorTransform_t& actor_transform = _actor_transforms[slot];
+    actor_transform.drawables -= 1;
+    if (actor_transform.drawables == 0)
+    {
+        _actor_slots.erase(actor_transform.actor);
+        actor_transform.actor = nullptr;
+        actor_transform.kinematic = nullptr;
+        actor_transform.body = nullptr;
+        _free_actor_slots.push_back(slot);
+    }
+}
+
+
+void Plugin::invalidateHierarchy()
+{
+    _hierarchy_dirty = true;
+}
+
+
+void Plugin::addBatch(Batch* batch)
+{
+    _batches.push_back(batch);
+}
+
+
+void Plugin::removeBatch(Batch* batch)
+{
+    _batches.erase(std::remove(_batches.begin(), _batches.end(), batch), _batches.end());
+}
+
+
 void Plugin::setDrawSpaceTransform(const SpaceTransformation& space_transform)
 {
+    typedef void (*SpaceTransformationFunction)(const hum::Game&, hum::Transformation&);
+    const SpaceTransformationFunction* function = space_transform.target<SpaceTransformationFunction>();
+    // Cached model matrices were computed with the previous transformation
+    invalidateHierarchy();
+    if (!space_transform || (function != nullptr && *function == defaultSpaceTransform))
+    {
+        _space_transform = nullptr;
+        _space_transform_identity = true;
+        return;
+    }
+    _space_transform = [space_transform](const hum::Game& game, hum::Transformation* transforms, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            space_transform(game, transforms[i]);
+        }
+    };
+    _space_transform_identity = false;
+}
+
+
+void Plugin::setBatchDrawSpaceTransform(const BatchSpaceTransformation& space_transform)
+{
+    invalidateHierarchy();
     _space_transform = space_transform;
+    _space_transform_identity = !space_transform;
+}
+
+
+void Plugin::setParallelSpaceTransform(bool parallel)
+{
+    _parallel_space_transform = parallel;
+}
+
+
+void Plugin::setDynamicResolution(bool enabled)
+{
+    _dynamic_resolution_enabled = enabled;
+}
+
+
+bool Plugin::isDynamicResolutionEnabled() const
+{
+    return _dynamic_resolution_enabled;
+}
+
+
+DynamicResolution& Plugin::dynamicResolution()
+{
+    return _dynamic_resolution;
+}
+
+
+const DynamicResolution& Plugin::dynamicResolution() const
+{
+    return _dynamic_resolution;
+}
+
+
+bool Plugin::isHeadless() const
+{
+    return _headless;
+}
+
+const RenderGraph& Plugin::renderGraph() const
+{
+    return _render_graph;
+}
+
+
+const RenderStatistics& Plugin::statistics() const
+{
+    return _statistics;
+}
+
+
+RenderStatistics& Plugin::statistics()
+{
+    return _statistics;
 }
 } /* rendering */
@@ -1,38 +1,40 @@
 #include "rendering/Rectangle.hpp"
 #include "rendering/Plugin.hpp"
+#include "rendering/RenderStatistics.hpp"
 
 namespace rendering
 {
+ShaderPermutations* Rectangle::_permutations = nullptr;
 ShaderProgram* Rectangle::_shader_program = nullptr;
+ShaderProgram* Rectangle::_textured_program = nullptr;
 GLuint Rectangle::_VAO = 0;
 GLuint Rectangle::_VBO = 0;
+int Rectangle::_bound_material = -1;
 
 Rectangle::Rectangle (const Color& color):
-_color(color)
+_color_material(Material::shared(color)),
+_material(_color_material.get()),
+_texture(nullptr)
+{}
+
+Rectangle::Rectangle (Material* material):
+_material(material),
+_texture(nullptr)
 {}
 
 void Rectangle::init()
 {
-    if (_shader_program == nullptr)
+    if (isHeadless())
     {
-        Shader v_shader;
-        v_shader.loadFromFile(Shader::Type::VERTEX_SHADER, "shaders/plain.vert");
-        hum::assert_msg(v_shader.isCompiled(), "Error compiling plain.vert\n", v_shader.log());
-        Shader f_shader;
-        f_shader.loadFromFile(Shader::Type::FRAGMENT_SHADER, "shaders/plain.frag");
-        hum::assert_msg(f_shader.isCompiled(), "Error compiling plain.frag\n", f_shader.log());
-        _shader_program = new ShaderProgram();
-        _shader_program
-            ->addShader(v_shader)
-            ->addShader(f_shader)
-            ->link()
-            ->bindFragmentOutput("out_color");
-        if (!_shader_program->isLinked())
-        {
-            hum::log_d(_shader_program->log());
-            delete _shader_program;
-            _shader_program = nullptr;
-        }
+        Drawable::init();
+        return;
+    }
+    if (_permutations == nullptr)
+    {
+        _permutations = new ShaderPermutations("shaders/plain.vert", "shaders/plain.frag", {"TEXTURED"});
+        _permutations->setLinkCallback(&Material::bindTable);
+        _shader_program = _permutations->get(0);
+        _textured_program = _permutations->get(_permutations->mask({"TEXTURED"}));
     }
 
     if (_VAO == 0)
@@ -52,7 +54,7 @@ void Rectangle::init()
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
     }
-    setShaderProgram(_shader_program);
+    setShaderProgram(_texture != nullptr ? _textured_program : _shader_program);
     Drawable::init();
 }
 void Rectangle::onDestroy()
@@ -63,6 +65,11 @@ void Rectangle::onDestroy()
 void Rectangle::setShaderProgram(ShaderProgram* shader_program)
 {
     Drawable::setShaderProgram(shader_program);
+    if (_VAO == 0)
+    {
+        // Not initialized yet, or headless: init() binds the attributes
+        return;
+    }
     glBindVertexArray(_VAO);
     glBindBuffer(GL_ARRAY_BUFFER, _VBO);
     _position_loc = shaderProgram()->bindVertexAttribute("position", 2, 0, 0);
@@ -72,24 +79,94 @@ void Rectangle::setShaderProgram(ShaderProgram* shader_program)
 
 void Rectangle::setColor(const Color& color)
 {
-    _color = color;
+    // Never changes the color of a Material others may use
+    _color_material = Material::shared(color);
+    _material = _color_material.get();
 }
 
 const Color& Rectangle::getColor() const
 {
-    return _color;
+    return _material->getColor();
+}
+
+void Rectangle::setMaterial(Material* material)
+{
+    _material = material;
+    _color_material.reset();
+}
+
+Material* Rectangle::getMaterial() const
+{
+    return _material;
+}
+
+void Rectangle::setTexture(Texture* texture)
+{
+    _texture = texture;
+    // Switches between the default programs, a custom one is kept
+    if (shaderProgram() != nullptr && (shaderProgram() == _shader_program || shaderProgram() == _textured_program))
+    {
+        setShaderProgram(_texture != nullptr ? _textured_program : _shader_program);
+    }
+}
+
+Texture* Rectangle::getTexture() const
+{
+    return _texture;
 }
 
 void Rectangle::draw()
 {
+    // Texture 0 would sample black: nothing is drawn until the Texture is loaded
+    if (_texture != nullptr && !_texture->isLoaded())
+    {
+        return;
+    }
     glBindVertexArray(_VAO);
-    shaderProgram()->setUniform4f("color",
-            static_cast<float>(_color.r)/255.0f,
-            static_cast<float>(_color.g)/255.0f,
-            static_cast<float>(_color.b)/255.0f,
-            static_cast<float>(_color.a)/255.0f);
+    RenderStatistics::countVertexArray(_VAO);
+    int material = _material->index();
+    if (shaderProgram() != _shader_program || material != _bound_material)
+    {
+        shaderProgram()->setUniform1i("material_index", material);
+        if (shaderProgram() == _shader_program)
+        {
+            _bound_material = material;
+        }
+    }
+    if (_texture != nullptr)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _texture->getId());
+    }
     glEnableVertexAttribArray(_position_loc);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStatistics::countDrawCall();
+}
+
+bool Rectangle::unitQuadMaterial(unsigned int& material) const
+{
+    if (shaderProgram() == nullptr || shaderProgram() != _shader_program)
+    {
+        return false;
+    }
+    material = _material->index();
+    return true;
+}
+
+bool Rectangle::coversUnitQuad(bool& opaque) const
+{
+    // A custom shader could move or discard the vertices
+    if (shaderProgram() == nullptr || shaderProgram() != _shader_program)
+    {
+        return false;
+    }
+    opaque = _material->getColor().a == 255;
+    return true;
+}
+
+Texture* Rectangle::texture() const
+{
+    return _texture;
 }
 
 const char* Rectangle::behaviorName()
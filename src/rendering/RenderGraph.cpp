@@ -0,0 +1,507 @@
+#include <algorithm>
+#include <sstream>
+#include "hummingbird/hum.hpp"
+#include "rendering/RenderGraph.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Pooled textures not used for this many frames are released
+const unsigned long long POOL_FRAMES = 3;
+
+bool isDepthFormat(GLenum internal_format)
+{
+    return internal_format == GL_DEPTH_COMPONENT16
+        || internal_format == GL_DEPTH_COMPONENT24
+        || internal_format == GL_DEPTH_COMPONENT32F
+        || internal_format == GL_DEPTH24_STENCIL8;
+}
+
+std::size_t bytesPerPixel(GLenum internal_format)
+{
+    switch (internal_format)
+    {
+        case GL_R8: return 1;
+        case GL_RG8: case GL_DEPTH_COMPONENT16: return 2;
+        case GL_RGBA16F: case GL_RG32F: return 8;
+        case GL_RGBA32F: return 16;
+        default: return 4;
+    }
+}
+
+std::size_t textureBytes(const RenderGraph::TextureDesc& desc)
+{
+    return static_cast<std::size_t>(desc.width) * desc.height * bytesPerPixel(desc.internal_format);
+}
+}
+
+bool RenderGraph::TextureDesc::operator==(const TextureDesc& other) const
+{
+    return width == other.width && height == other.height && internal_format == other.internal_format;
+}
+
+bool RenderGraph::TextureDesc::operator<(const TextureDesc& other) const
+{
+    if (width != other.width) return width < other.width;
+    if (height != other.height) return height < other.height;
+    return internal_format < other.internal_format;
+}
+
+RenderGraph::RenderGraph():
+_frame(0),
+_memory_footprint(0),
+_unaliased_memory(0)
+{}
+
+RenderGraph::~RenderGraph()
+{
+    for (auto& it : _framebuffers)
+    {
+        glDeleteFramebuffers(1, &it.second);
+    }
+    for (PhysicalTexture_t& texture : _pool)
+    {
+        glDeleteTextures(1, &texture.id);
+    }
+}
+
+void RenderGraph::reset()
+{
+    _passes.clear();
+    _functions.clear();
+    _resources.clear();
+    _order.clear();
+    _memory_footprint = 0;
+    _unaliased_memory = 0;
+}
+
+RenderGraph::Resource RenderGraph::createTexture(const std::string& name, const TextureDesc& desc)
+{
+    _resources.push_back(CompiledResource{name, desc, false, 0, 0, 0, -1});
+    return _resources.size() - 1;
+}
+
+RenderGraph::Resource RenderGraph::importBackbuffer(const std::string& name, int width, int height)
+{
+    return importFramebuffer(name, 0, width, height);
+}
+
+RenderGraph::Resource RenderGraph::importFramebuffer(const std::string& name, GLuint framebuffer, int width, int height)
+{
+    _resources.push_back(CompiledResource{name, TextureDesc{width, height, GL_RGBA8}, true, framebuffer, 0, 0, -1});
+    return _resources.size() - 1;
+}
+
+void RenderGraph::addPass(const std::string& name, const std::vector<Resource>& reads,
+        const std::vector<Resource>& writes, const PassFunction& execute)
+{
+    hum::assert_msg(!writes.empty(), "Render pass ", name, " does not write any resource");
+    // An imported resource is its own framebuffer, transient textures are attached to one
+    bool writes_imported = std::any_of(writes.begin(), writes.end(),
+            [this](Resource resource) { return _resources[resource].imported; });
+    hum::assert_msg(!writes_imported || writes.size() == 1,
+            "Render pass ", name, " writes an imported resource along with other resources");
+    _passes.push_back(CompiledPass{name, reads, writes, true});
+    _functions.push_back(execute);
+}
+
+void RenderGraph::compile()
+{
+    ++_frame;
+    unsigned int pass_count = _passes.size();
+
+    // Writers of every resource, in declaration order
+    std::vector<std::vector<unsigned int>> writers(_resources.size());
+    for (unsigned int i = 0; i < pass_count; ++i)
+    {
+        for (Resource resource : _passes[i].writes)
+        {
+            writers[resource].push_back(i);
+        }
+    }
+
+    // A pass depends on every writer of what it reads and on the previous
+    // writer of what it writes.
+    std::vector<std::vector<unsigned int>> dependencies(pass_count);
+    for (unsigned int i = 0; i < pass_count; ++i)
+    {
+        for (Resource resource : _passes[i].reads)
+        {
+            for (unsigned int writer : writers[resource])
+            {
+                if (writer != i)
+                {
+                    dependencies[i].push_back(writer);
+                }
+            }
+        }
+        for (Resource resource : _passes[i].writes)
+        {
+            auto it = std::find(writers[resource].begin(), writers[resource].end(), i);
+            if (it != writers[resource].begin())
+            {
+                dependencies[i].push_back(*(it - 1));
+            }
+        }
+    }
+
+    // Cull: only passes reachable from the writers of imported resources survive
+    std::vector<unsigned int> stack;
+    for (unsigned int i = 0; i < pass_count; ++i)
+    {
+        _passes[i].culled = true;
+        for (Resource resource : _passes[i].writes)
+        {
+            if (_resources[resource].imported)
+            {
+                stack.push_back(i);
+            }
+        }
+    }
+    while (!stack.empty())
+    {
+        unsigned int pass = stack.back();
+        stack.pop_back();
+        if (!_passes[pass].culled)
+        {
+            continue;
+        }
+        _passes[pass].culled = false;
+        for (unsigned int dependency : dependencies[pass])
+        {
+            stack.push_back(dependency);
+        }
+    }
+
+    // Topological order (Kahn), ties broken by declaration order
+    std::vector<unsigned int> pending(pass_count, 0);
+    std::vector<std::vector<unsigned int>> dependents(pass_count);
+    for (unsigned int i = 0; i < pass_count; ++i)
+    {
+        if (_passes[i].culled)
+        {
+            continue;
+        }
+        std::sort(dependencies[i].begin(), dependencies[i].end());
+        dependencies[i].erase(std::unique(dependencies[i].begin(), dependencies[i].end()), dependencies[i].end());
+        pending[i] = dependencies[i].size();
+        for (unsigned int dependency : dependencies[i])
+        {
+            dependents[dependency].push_back(i);
+        }
+    }
+    _order.clear();
+    std::vector<unsigned int> ready;
+    for (unsigned int i = 0; i < pass_count; ++i)
+    {
+        if (!_passes[i].culled && pending[i] == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+    while (!ready.empty())
+    {
+        auto first = std::min_element(ready.begin(), ready.end());
+        unsigned int pass = *first;
+        ready.erase(first);
+        _order.push_back(pass);
+        for (unsigned int dependent : dependents[pass])
+        {
+            if (--pending[dependent] == 0)
+            {
+                ready.push_back(dependent);
+            }
+        }
+    }
+    unsigned int alive_count = std::count_if(_passes.begin(), _passes.end(),
+            [](const CompiledPass& pass) { return !pass.culled; });
+    hum::assert_msg(_order.size() == alive_count, "Render graph has a cycle");
+
+    // Lifetimes, as indices into _order
+    std::vector<bool> used(_resources.size(), false);
+    for (unsigned int position = 0; position < _order.size(); ++position)
+    {
+        const CompiledPass& pass = _passes[_order[position]];
+        for (const std::vector<Resource>* list : {&pass.reads, &pass.writes})
+        {
+            for (Resource resource : *list)
+            {
+                if (!used[resource])
+                {
+                    used[resource] = true;
+                    _resources[resource].first_use = position;
+                }
+                _resources[resource].last_use = position;
+            }
+        }
+    }
+
+    // Aliasing: walk the passes and hand out pooled textures, returning them to
+    // the free list right after the last pass using them.
+    std::vector<bool> taken(_pool.size(), false);
+    std::vector<bool> counted(_pool.size(), false);
+    for (CompiledResource& resource : _resources)
+    {
+        resource.physical = -1;
+    }
+    _memory_footprint = 0;
+    _unaliased_memory = 0;
+    for (unsigned int position = 0; position < _order.size(); ++position)
+    {
+        for (Resource i = 0; i < _resources.size(); ++i)
+        {
+            CompiledResource& resource = _resources[i];
+            if (!used[i] || resource.imported || resource.first_use != position)
+            {
+                continue;
+            }
+            _unaliased_memory += textureBytes(resource.desc);
+            for (unsigned int p = 0; p < _pool.size(); ++p)
+            {
+                if (!taken[p] && _pool[p].desc == resource.desc)
+                {
+                    resource.physical = p;
+                    break;
+                }
+            }
+            if (resource.physical == -1)
+            {
+                PhysicalTexture_t texture{0, resource.desc, _frame};
+                bool depth = isDepthFormat(resource.desc.internal_format);
+                glGenTextures(1, &texture.id);
+                glBindTexture(GL_TEXTURE_2D, texture.id);
+                glTexImage2D(GL_TEXTURE_2D, 0, resource.desc.internal_format,
+                        resource.desc.width, resource.desc.height, 0,
+                        depth ? GL_DEPTH_COMPONENT : GL_RGBA,
+                        depth ? GL_UNSIGNED_INT : GL_UNSIGNED_BYTE, nullptr);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glBindTexture(GL_TEXTURE_2D, 0);
+                _pool.push_back(texture);
+                taken.push_back(false);
+                counted.push_back(false);
+                resource.physical = _pool.size() - 1;
+            }
+            taken[resource.physical] = true;
+            if (!counted[resource.physical])
+            {
+                counted[resource.physical] = true;
+                _memory_footprint += textureBytes(resource.desc);
+            }
+            _pool[resource.physical].last_frame = _frame;
+        }
+        for (Resource i = 0; i < _resources.size(); ++i)
+        {
+            if (used[i] && _resources[i].physical != -1 && _resources[i].last_use == position)
+            {
+                taken[_resources[i].physical] = false;
+            }
+        }
+    }
+    releaseUnusedTextures();
+}
+
+void RenderGraph::execute()
+{
+    for (unsigned int index : _order)
+    {
+        bindFramebuffer(_passes[index]);
+        _functions[index](*this);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+GLuint RenderGraph::texture(Resource resource) const
+{
+    int physical = _resources[resource].physical;
+    return physical == -1 ? 0 : _pool[physical].id;
+}
+
+GLuint RenderGraph::framebuffer(const std::vector<Resource>& attachments)
+{
+    std::vector<GLuint> textures;
+    for (Resource resource : attachments)
+    {
+        textures.push_back(texture(resource));
+    }
+
+    auto it = _framebuffers.find(textures);
+    if (it != _framebuffers.end())
+    {
+        return it->second;
+    }
+
+    // Creating the framebuffer must not disturb the bindings of the running pass
+    GLint draw_binding, read_binding;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw_binding);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_binding);
+
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    std::vector<GLenum> draw_buffers;
+    for (Resource resource : attachments)
+    {
+        if (isDepthFormat(_resources[resource].desc.internal_format))
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture(resource), 0);
+        }
+        else
+        {
+            GLenum attachment = GL_COLOR_ATTACHMENT0 + draw_buffers.size();
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture(resource), 0);
+            draw_buffers.push_back(attachment);
+        }
+    }
+    if (draw_buffers.empty())
+    {
+        glDrawBuffer(GL_NONE);
+    }
+    else
+    {
+        glDrawBuffers(draw_buffers.size(), draw_buffers.data());
+    }
+    hum::assert_msg(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE,
+            "Render graph framebuffer is incomplete");
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_binding);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_binding);
+    _framebuffers[textures] = framebuffer;
+    return framebuffer;
+}
+
+const std::vector<RenderGraph::CompiledPass>& RenderGraph::passes() const
+{
+    return _passes;
+}
+
+const std::vector<RenderGraph::CompiledResource>& RenderGraph::resources() const
+{
+    return _resources;
+}
+
+const std::vector<unsigned int>& RenderGraph::executionOrder() const
+{
+    return _order;
+}
+
+std::size_t RenderGraph::memoryFootprint() const
+{
+    return _memory_footprint;
+}
+
+std::size_t RenderGraph::unaliasedMemory() const
+{
+    return _unaliased_memory;
+}
+
+std::size_t RenderGraph::pooledMemory() const
+{
+    std::size_t bytes = 0;
+    for (const PhysicalTexture_t& texture : _pool)
+    {
+        bytes += textureBytes(texture.desc);
+    }
+    return bytes;
+}
+
+std::string RenderGraph::describe() const
+{
+    std::ostringstream out;
+    out << "passes:\n";
+    for (unsigned int index : _order)
+    {
+        const CompiledPass& pass = _passes[index];
+        out << "  " << pass.name << " reads {";
+        for (Resource resource : pass.reads)
+        {
+            out << " " << _resources[resource].name;
+        }
+        out << " } writes {";
+        for (Resource resource : pass.writes)
+        {
+            out << " " << _resources[resource].name;
+        }
+        out << " }\n";
+    }
+    for (const CompiledPass& pass : _passes)
+    {
+        if (pass.culled)
+        {
+            out << "  " << pass.name << " (culled)\n";
+        }
+    }
+    out << "resources:\n";
+    for (const CompiledResource& resource : _resources)
+    {
+        out << "  " << resource.name << " " << resource.desc.width << "x" << resource.desc.height;
+        if (resource.imported)
+        {
+            out << " imported\n";
+        }
+        else if (resource.physical == -1)
+        {
+            out << " unused\n";
+        }
+        else
+        {
+            out << " passes [" << resource.first_use << ", " << resource.last_use
+                << "] texture #" << resource.physical << "\n";
+        }
+    }
+    out << "memory: " << _memory_footprint << " bytes (" << _unaliased_memory << " without aliasing)\n";
+    return out.str();
+}
+
+void RenderGraph::bindFramebuffer(const CompiledPass& pass)
+{
+    const CompiledResource& first = _resources[pass.writes.front()];
+    if (first.imported)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, first.imported_framebuffer);
+    }
+    else
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer(pass.writes));
+    }
+    glViewport(0, 0, first.desc.width, first.desc.height);
+}
+
+void RenderGraph::releaseUnusedTextures()
+{
+    std::vector<PhysicalTexture_t> kept;
+    std::vector<int> remap(_pool.size(), -1);
+    for (unsigned int i = 0; i < _pool.size(); ++i)
+    {
+        if (_frame - _pool[i].last_frame < POOL_FRAMES)
+        {
+            remap[i] = kept.size();
+            kept.push_back(_pool[i]);
+            continue;
+        }
+        for (auto it = _framebuffers.begin(); it != _framebuffers.end();)
+        {
+            if (std::find(it->first.begin(), it->first.end(), _pool[i].id) != it->first.end())
+            {
+                glDeleteFramebuffers(1, &it->second);
+                it = _framebuffers.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        glDeleteTextures(1, &_pool[i].id);
+    }
+    _pool.swap(kept);
+    for (CompiledResource& resource : _resources)
+    {
+        if (resource.physical != -1)
+        {
+            resource.physical = remap[resource.physical];
+        }
+    }
+}
+}
@@ -0,0 +1,54 @@
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+FrameStatistics_t RenderStatistics::_current = FrameStatistics_t();
+GLuint RenderStatistics::_current_vao = 0;
+
+RenderStatistics::RenderStatistics(std::size_t history):
+_capacity(std::max<std::size_t>(history, 1)),
+_next(0),
+_last()
+{}
+
+void RenderStatistics::endFrame()
+{
+    _last = _current;
+    if (_history.size() < _capacity)
+    {
+        _history.push_back(_current);
+    }
+    else
+    {
+        _history[_next] = _current;
+    }
+    _next = (_next + 1) % _capacity;
+    _current = FrameStatistics_t();
+    // The first bind of the next frame counts as a switch
+    _current_vao = 0;
+}
+
+void RenderStatistics::setHistorySize(std::size_t history)
+{
+    _capacity = std::max<std::size_t>(history, 1);
+    _history.clear();
+    _next = 0;
+}
+
+std::size_t RenderStatistics::size() const
+{
+    return _history.size();
+}
+
+const FrameStatistics_t& RenderStatistics::frame(std::size_t i) const
+{
+    // Until the history is full the oldest frame is the first one
+    std::size_t oldest = _history.size() < _capacity ? 0 : _next;
+    return _history[(oldest + i) % _history.size()];
+}
+
+const FrameStatistics_t& RenderStatistics::last() const
+{
+    return _last;
+}
+}
@@ -0,0 +1,81 @@
+#include "rendering/RenderTarget.hpp"
+
+namespace rendering
+{
+RenderTarget::RenderTarget():
+_framebuffer(0),
+_color_texture(0),
+_depth_renderbuffer(0),
+_width(0),
+_height(0)
+{}
+
+RenderTarget::~RenderTarget()
+{
+    destroy();
+}
+
+bool RenderTarget::create(int width, int height)
+{
+    destroy();
+    _width = width;
+    _height = height;
+
+    glGenTextures(1, &_color_texture);
+    glBindTexture(GL_TEXTURE_2D, _color_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &_depth_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _depth_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _color_texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth_renderbuffer);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+void RenderTarget::destroy()
+{
+    if (_framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &_framebuffer);
+        glDeleteRenderbuffers(1, &_depth_renderbuffer);
+        glDeleteTextures(1, &_color_texture);
+    }
+    _framebuffer = 0;
+    _color_texture = 0;
+    _depth_renderbuffer = 0;
+    _width = 0;
+    _height = 0;
+}
+
+GLuint RenderTarget::framebuffer() const
+{
+    return _framebuffer;
+}
+
+GLuint RenderTarget::colorTexture() const
+{
+    return _color_texture;
+}
+
+int RenderTarget::width() const
+{
+    return _width;
+}
+
+int RenderTarget::height() const
+{
+    return _height;
+}
+}
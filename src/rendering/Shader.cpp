@@ -1,8 +1,19 @@
+#include <algorithm>
 #include <fstream>
+#include "rendering/Archive.hpp"
+#include "rendering/EmbeddedShaders.hpp"
 #include "rendering/Shader.hpp"
 
 namespace rendering
 {
+// The default shading, without it no Rectangle can be drawn
+static_assert(!embedded_shaders::ENABLED || embedded_shaders::find("shaders/plain.vert").size() > 0,
+        "shaders/plain.vert is not embedded");
+static_assert(!embedded_shaders::ENABLED || embedded_shaders::find("shaders/plain.frag").size() > 0,
+        "shaders/plain.frag is not embedded");
+
+bool Shader::_disk_override = false;
+
 Shader::Shader():
 _shader_id(0),
 _compiled(false)
@@ -13,13 +24,34 @@ Shader::~Shader()
     glDeleteShader(_shader_id);
 }
 
-void Shader::loadFromSource(const Shader::Type type, const std::string& source)
+void Shader::loadFromSource(const Shader::Type type, std::string_view source, const std::vector<std::string>& defines)
 {
     if(_shader_id != 0)
     {
         glDeleteShader(_shader_id);
     }
-    const char *source_ptr = source.c_str();
+    // The source is passed in three pieces: up to the #version line, the
+    // defines and the rest. #version must come before anything else.
+    std::string_view head;
+    std::string_view body = source;
+    std::string prelude;
+    if(!defines.empty())
+    {
+        std::size_t version = source.find("#version");
+        if(version != std::string_view::npos)
+        {
+            std::size_t end_of_line = source.find('\n', version);
+            head = source.substr(0, end_of_line == std::string_view::npos ? source.size() : end_of_line + 1);
+            body = source.substr(head.size());
+        }
+        for(const std::string& define : defines)
+        {
+            prelude += "#define " + define + "\n";
+        }
+        prelude += "#line " + std::to_string(std::count(head.begin(), head.end(), '\n') + 1) + "\n";
+    }
+    const char* source_ptrs[3] = { source.data(), prelude.data(), body.data() };
+    GLint source_lengths[3] = { static_cast<GLint>(head.size()), static_cast<GLint>(prelude.size()), static_cast<GLint>(body.size()) };
     GLint status;
     char buffer[512];
 
@@ -27,6 +59,10 @@ void Shader::loadFromSource(const Shader::Type type, const std::string& source)
     {
         _shader_id = glCreateShader(GL_VERTEX_SHADER);
     }
+    else if (type == Type::COMPUTE_SHADER)
+    {
+        _shader_id = glCreateShader(GL_COMPUTE_SHADER);
+    }
     else
     {
         _shader_id = glCreateShader(GL_FRAGMENT_SHADER);
@@ -36,7 +72,7 @@ void Shader::loadFromSource(const Shader::Type type, const std::string& source)
     {
         return;
     }
-    glShaderSource(_shader_id, 1, &source_ptr, nullptr);
+    glShaderSource(_shader_id, 3, source_ptrs, source_lengths);
     glCompileShader(_shader_id);
     glGetShaderiv(_shader_id, GL_COMPILE_STATUS, &status);
     _compiled = (status == GL_TRUE);
@@ -44,21 +80,44 @@ void Shader::loadFromSource(const Shader::Type type, const std::string& source)
     _error_log.assign(buffer);
 }
 
-bool Shader::loadFromFile(const Shader::Type type, const std::string& filename)
+bool Shader::loadFromFile(const Shader::Type type, const std::string& filename, const std::vector<std::string>& defines)
 {
-    if(_shader_id != 0)
+    std::string shader_source;
+    if(_disk_override && loadShaderSource(filename, shader_source))
     {
-        glDeleteShader(_shader_id);
+        loadFromSource(type, shader_source, defines);
+        return true;
     }
-    std::string shader_source;
-    if(!loadShaderSource(filename, shader_source))
+    // The embedded copy matches the engine, an archive may have been packed
+    // by another build
+    std::string_view packed_source = embedded_shaders::find(filename);
+    if(packed_source.data() == nullptr)
+    {
+        packed_source = Archive::findMounted(filename);
+    }
+    if(packed_source.data() != nullptr)
+    {
+        loadFromSource(type, packed_source, defines);
+        return true;
+    }
+    if(_disk_override || !loadShaderSource(filename, shader_source))
     {
         return false;
     }
-    loadFromSource(type, shader_source);
+    loadFromSource(type, shader_source, defines);
     return true;
 }
 
+void Shader::setDiskOverride(bool enabled)
+{
+    _disk_override = enabled;
+}
+
+bool Shader::hasDiskOverride()
+{
+    return _disk_override;
+}
+
 GLuint Shader::getId() const
 {
     return _shader_id;
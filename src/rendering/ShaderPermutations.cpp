@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <fstream>
+#include "hummingbird/hum.hpp"
+#include "rendering/ShaderPermutations.hpp"
+
+namespace rendering
+{
+std::vector<ShaderPermutations*> ShaderPermutations::_instances;
+std::multimap<std::string, ShaderPermutations::Mask> ShaderPermutations::_manifest;
+
+ShaderPermutations::ShaderPermutations(const std::string& vertex_file, const std::string& fragment_file,
+        const std::vector<std::string>& keywords):
+_vertex_file(vertex_file),
+_fragment_file(fragment_file),
+_keywords(keywords)
+{
+    hum::assert_msg(keywords.size() <= 32, "A ShaderPermutations supports up to 32 keywords");
+    _instances.push_back(this);
+    auto range = _manifest.equal_range(key());
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        require(it->second);
+    }
+    _manifest.erase(range.first, range.second);
+}
+
+ShaderPermutations::~ShaderPermutations()
+{
+    _instances.erase(std::remove(_instances.begin(), _instances.end(), this), _instances.end());
+}
+
+void ShaderPermutations::setLinkCallback(const std::function<void(ShaderProgram*)>& callback)
+{
+    _link_callback = callback;
+}
+
+ShaderPermutations::Mask ShaderPermutations::mask(const std::vector<std::string>& keywords) const
+{
+    Mask result = 0;
+    for (const std::string& keyword : keywords)
+    {
+        auto it = std::find(_keywords.begin(), _keywords.end(), keyword);
+        if (it != _keywords.end())
+        {
+            result |= Mask(1) << (it - _keywords.begin());
+        }
+    }
+    return result;
+}
+
+ShaderProgram* ShaderPermutations::get(Mask mask)
+{
+    auto it = _variants.find(mask);
+    if (it != _variants.end() && it->second)
+    {
+        return it->second.get();
+    }
+    if (std::find(_failed.begin(), _failed.end(), mask) != _failed.end())
+    {
+        return nullptr;
+    }
+    if (it == _variants.end())
+    {
+        hum::log_w("Shader variant ", mask, " of ", _vertex_file, " was not required, compiled on first use");
+    }
+    return compile(mask);
+}
+
+void ShaderPermutations::require(Mask mask)
+{
+    // Creates an empty entry if there is none
+    _variants[mask];
+}
+
+bool ShaderPermutations::isCompiled(Mask mask) const
+{
+    auto it = _variants.find(mask);
+    return it != _variants.end() && it->second;
+}
+
+std::vector<ShaderPermutations::Mask> ShaderPermutations::used() const
+{
+    std::vector<Mask> masks;
+    for (const auto& variant : _variants)
+    {
+        masks.push_back(variant.first);
+    }
+    return masks;
+}
+
+void ShaderPermutations::precompile()
+{
+    while (!warmUp(32))
+    {}
+}
+
+bool ShaderPermutations::warmUp(unsigned int max_variants, unsigned int* compiled)
+{
+    unsigned int count = 0;
+    bool done = true;
+    for (auto& variant : _variants)
+    {
+        if (variant.second || std::find(_failed.begin(), _failed.end(), variant.first) != _failed.end())
+        {
+            continue;
+        }
+        if (count == max_variants)
+        {
+            done = false;
+            break;
+        }
+        compile(variant.first);
+        ++count;
+    }
+    if (compiled != nullptr)
+    {
+        *compiled = count;
+    }
+    return done;
+}
+
+bool ShaderPermutations::warmUpAll(unsigned int max_variants)
+{
+    bool done = true;
+    for (ShaderPermutations* permutations : _instances)
+    {
+        unsigned int compiled;
+        done = permutations->warmUp(max_variants, &compiled) && done;
+        max_variants -= compiled;
+    }
+    return done;
+}
+
+void ShaderPermutations::precompileAll()
+{
+    for (ShaderPermutations* permutations : _instances)
+    {
+        permutations->precompile();
+    }
+}
+
+bool ShaderPermutations::saveManifest(const std::string& filename)
+{
+    std::ofstream file(filename.c_str());
+    if (!file.is_open())
+    {
+        return false;
+    }
+    for (const ShaderPermutations* permutations : _instances)
+    {
+        for (Mask mask : permutations->used())
+        {
+            file << permutations->key() << ' ' << mask << '\n';
+        }
+    }
+    // Keep the entries of permutations not created in this run
+    for (const auto& entry : _manifest)
+    {
+        file << entry.first << ' ' << entry.second << '\n';
+    }
+    return true;
+}
+
+bool ShaderPermutations::loadManifest(const std::string& filename)
+{
+    std::ifstream file(filename.c_str());
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::string vertex_file, fragment_file;
+    Mask mask;
+    while (file >> vertex_file >> fragment_file >> mask)
+    {
+        std::string key = vertex_file + ' ' + fragment_file;
+        auto it = std::find_if(_instances.begin(), _instances.end(),
+                [&key](const ShaderPermutations* permutations) { return permutations->key() == key; });
+        if (it != _instances.end())
+        {
+            (*it)->require(mask);
+        }
+        else
+        {
+            _manifest.emplace(key, mask);
+        }
+    }
+    return true;
+}
+
+ShaderProgram* ShaderPermutations::compile(Mask mask)
+{
+    std::vector<std::string> defines;
+    for (std::size_t i = 0; i < _keywords.size(); ++i)
+    {
+        if (mask & (Mask(1) << i))
+        {
+            defines.push_back(_keywords[i]);
+        }
+    }
+
+    Shader v_shader;
+    v_shader.loadFromFile(Shader::Type::VERTEX_SHADER, _vertex_file, defines);
+    Shader f_shader;
+    f_shader.loadFromFile(Shader::Type::FRAGMENT_SHADER, _fragment_file, defines);
+    if (!v_shader.isCompiled() || !f_shader.isCompiled())
+    {
+        hum::log_e("Error compiling variant ", mask, " of ", _vertex_file, "/", _fragment_file, "\n",
+                v_shader.log(), f_shader.log());
+        _failed.push_back(mask);
+        return nullptr;
+    }
+    std::unique_ptr<ShaderProgram> program(new ShaderProgram());
+    program
+        ->addShader(v_shader)
+        ->addShader(f_shader)
+        ->link()
+        ->bindFragmentOutput("out_color");
+    if (!program->isLinked())
+    {
+        hum::log_e("Error linking variant ", mask, " of ", _vertex_file, "/", _fragment_file, "\n", program->log());
+        _failed.push_back(mask);
+        return nullptr;
+    }
+    if (_link_callback)
+    {
+        _link_callback(program.get());
+    }
+    ShaderProgram* result = program.get();
+    _variants[mask] = std::move(program);
+    return result;
+}
+
+std::string ShaderPermutations::key() const
+{
+    return _vertex_file + ' ' + _fragment_file;
+}
+}
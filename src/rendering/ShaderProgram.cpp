@@ -1,8 +1,11 @@
 #include <glm/gtc/type_ptr.hpp>
+#include "rendering/RenderStatistics.hpp"
 #include "rendering/ShaderProgram.hpp"
 
 namespace rendering
 {
+GLuint ShaderProgram::_current_program = 0;
+
 ShaderProgram::ShaderProgram():
 _program_id(glCreateProgram()),
 _linked(false)
@@ -10,6 +13,10 @@ _linked(false)
 
 ShaderProgram::~ShaderProgram()
 {
+    if (_current_program == _program_id)
+    {
+        _current_program = 0;
+    }
     glDeleteProgram(_program_id);
 }
 
@@ -30,7 +37,36 @@ GLint ShaderProgram::bindVertexAttribute(const std::string& attrib_name, GLint s
     GLint attrib_pos;
 
     attrib_pos = glGetAttribLocation(_program_id, attrib_name.c_str());
-    glVertexAttribPointer(attrib_pos, size, GL_FLOAT, GL_FALSE, stride, first_pointer);
+    if(attrib_pos != -1)
+    {
+        glVertexAttribPointer(attrib_pos, size, GL_FLOAT, GL_FALSE, stride, first_pointer);
+    }
+
+    return attrib_pos;
+}
+
+GLint ShaderProgram::bindVertexAttribute(const std::string& attrib_name, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLvoid* first_pointer)
+{
+    GLint attrib_pos;
+
+    attrib_pos = glGetAttribLocation(_program_id, attrib_name.c_str());
+    if(attrib_pos != -1)
+    {
+        glVertexAttribPointer(attrib_pos, size, type, normalized, stride, first_pointer);
+    }
+
+    return attrib_pos;
+}
+
+GLint ShaderProgram::bindVertexAttributeI(const std::string& attrib_name, GLint size, GLenum type, GLsizei stride, GLvoid* first_pointer)
+{
+    GLint attrib_pos;
+
+    attrib_pos = glGetAttribLocation(_program_id, attrib_name.c_str());
+    if(attrib_pos != -1)
+    {
+        glVertexAttribIPointer(attrib_pos, size, type, stride, first_pointer);
+    }
 
     return attrib_pos;
 }
@@ -50,7 +86,23 @@ ShaderProgram* ShaderProgram::link()
 
 ShaderProgram* ShaderProgram::use()
 {
-    glUseProgram(_program_id);
+    if (_current_program != _program_id)
+    {
+        glUseProgram(_program_id);
+        _current_program = _program_id;
+        RenderStatistics::countProgramSwitch();
+    }
+    return this;
+}
+
+ShaderProgram* ShaderProgram::bindUniformBlock(const std::string& block_name, GLuint binding)
+{
+    GLuint index = glGetUniformBlockIndex(_program_id, block_name.c_str());
+
+    if(index != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(_program_id, index, binding);
+    }
     return this;
 }
 
@@ -64,6 +116,30 @@ const std::string& ShaderProgram::log() const
     return _error_log;
 }
 
+ShaderProgram* ShaderProgram::setUniform1i(const std::string& uniform_name, int v0)
+{
+    GLint location = glGetUniformLocation(_program_id, uniform_name.c_str());
+
+    if(location != -1)
+    {
+        glUniform1i(location, v0);
+        RenderStatistics::countUniformUpload();
+    }
+    return this;
+}
+
+ShaderProgram* ShaderProgram::setUniform1f(const std::string& uniform_name, float v0)
+{
+    GLint location = glGetUniformLocation(_program_id, uniform_name.c_str());
+
+    if(location != -1)
+    {
+        glUniform1f(location, v0);
+        RenderStatistics::countUniformUpload();
+    }
+    return this;
+}
+
 ShaderProgram* ShaderProgram::setUniform2f(const std::string& uniform_name, float v0, float v1)
 {
     GLint location = glGetUniformLocation(_program_id, uniform_name.c_str());
@@ -71,6 +147,7 @@ ShaderProgram* ShaderProgram::setUniform2f(const std::string& uniform_name, floa
     if(location != -1)
     {
         glUniform2f(location, v0, v1);
+        RenderStatistics::countUniformUpload();
     }
     return this;
 }
@@ -82,6 +159,7 @@ ShaderProgram* ShaderProgram::setUniform3f(const std::string& uniform_name, floa
     if(location != -1)
     {
         glUniform3f(location, v0, v1, v2);
+        RenderStatistics::countUniformUpload();
     }
     return this;
 }
@@ -93,6 +171,7 @@ ShaderProgram* ShaderProgram::setUniform4f(const std::string& uniform_name, floa
     if(location != -1)
     {
         glUniform4f(location, v0, v1, v2, v3);
+        RenderStatistics::countUniformUpload();
     }
     return this;
 }
@@ -104,6 +183,7 @@ ShaderProgram* ShaderProgram::setUniformMatrix4f(const std::string& uniform_name
     if(location != -1)
     {
         glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+        RenderStatistics::countUniformUpload();
     }
     return this;
 }
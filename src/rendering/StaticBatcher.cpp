@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cmath>
+#include "hummingbird/hum.hpp"
+#include "rendering/Material.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/StaticBatcher.hpp"
+
+namespace rendering
+{
+StaticBatcher::StaticBatcher(float cell_size):
+_shader_program(nullptr),
+_cell_size(cell_size)
+{
+    Shader v_shader;
+    v_shader.loadFromFile(Shader::Type::VERTEX_SHADER, "shaders/static.vert");
+    hum::assert_msg(v_shader.isCompiled(), "Error compiling static.vert\n", v_shader.log());
+    Shader f_shader;
+    f_shader.loadFromFile(Shader::Type::FRAGMENT_SHADER, "shaders/static.frag");
+    hum::assert_msg(f_shader.isCompiled(), "Error compiling static.frag\n", f_shader.log());
+    _shader_program = new ShaderProgram();
+    _shader_program
+        ->addShader(v_shader)
+        ->addShader(f_shader)
+        ->link()
+        ->bindFragmentOutput("out_color");
+    if (!_shader_program->isLinked())
+    {
+        hum::log_d(_shader_program->log());
+        delete _shader_program;
+        _shader_program = nullptr;
+        return;
+    }
+    Material::bindTable(_shader_program);
+}
+
+StaticBatcher::~StaticBatcher()
+{
+    for (auto& value : _cells)
+    {
+        if (value.second.VAO != 0)
+        {
+            glDeleteBuffers(1, &value.second.VBO);
+            glDeleteVertexArrays(1, &value.second.VAO);
+        }
+    }
+    delete _shader_program;
+}
+
+unsigned int StaticBatcher::acquire()
+{
+    unsigned int slot;
+    if (_free_slots.empty())
+    {
+        slot = _members.size();
+        _members.push_back(Member_t());
+    }
+    else
+    {
+        slot = _free_slots.back();
+        _free_slots.pop_back();
+    }
+    _members[slot].index = -1;
+    return slot;
+}
+
+void StaticBatcher::release(unsigned int slot)
+{
+    if (_members[slot].index >= 0)
+    {
+        leave(slot);
+    }
+    _free_slots.push_back(slot);
+}
+
+void StaticBatcher::set(unsigned int slot, const glm::mat4& model, unsigned int material)
+{
+    Member_t& member = _members[slot];
+    member.corners[0] = glm::vec3(model * glm::vec4(0.f, 0.f, 0.f, 1.f));
+    member.corners[1] = glm::vec3(model * glm::vec4(1.f, 0.f, 0.f, 1.f));
+    member.corners[2] = glm::vec3(model * glm::vec4(1.f, 1.f, 0.f, 1.f));
+    member.corners[3] = glm::vec3(model * glm::vec4(0.f, 1.f, 0.f, 1.f));
+    member.material = material;
+    long long cell = cellKey(glm::vec3(model * glm::vec4(0.5f, 0.5f, 0.f, 1.f)));
+    if (member.index >= 0 && member.cell == cell)
+    {
+        _cells[cell].dirty = true;
+        return;
+    }
+    if (member.index >= 0)
+    {
+        leave(slot);
+    }
+    member.cell = cell;
+    join(slot);
+}
+
+unsigned int StaticBatcher::material(unsigned int slot) const
+{
+    return _members[slot].material;
+}
+
+void StaticBatcher::setCellSize(float cell_size)
+{
+    _cell_size = cell_size;
+    std::vector<unsigned int> slots;
+    for (unsigned int slot = 0; slot < _members.size(); ++slot)
+    {
+        if (_members[slot].index >= 0)
+        {
+            leave(slot);
+            slots.push_back(slot);
+        }
+    }
+    for (unsigned int slot : slots)
+    {
+        const glm::vec3* corners = _members[slot].corners;
+        _members[slot].cell = cellKey((corners[0] + corners[2]) * 0.5f);
+        join(slot);
+    }
+}
+
+float StaticBatcher::getCellSize() const
+{
+    return _cell_size;
+}
+
+std::size_t StaticBatcher::cellCount() const
+{
+    return _cells.size();
+}
+
+void StaticBatcher::draw(Camera& camera)
+{
+    if (_cells.empty() || _shader_program == nullptr)
+    {
+        return;
+    }
+    glm::vec4 planes[6];
+    camera.getFrustumPlanes(planes);
+    _shader_program->use();
+    _shader_program->setUniformMatrix4f("projection", camera.getProjection());
+    _shader_program->setUniformMatrix4f("view", camera.getView());
+
+    for (auto it = _cells.begin(); it != _cells.end();)
+    {
+        Cell_t& cell = it->second;
+        if (cell.members.empty())
+        {
+            if (cell.VAO != 0)
+            {
+                glDeleteBuffers(1, &cell.VBO);
+                glDeleteVertexArrays(1, &cell.VAO);
+            }
+            it = _cells.erase(it);
+            continue;
+        }
+        ++it;
+        if (cell.dirty)
+        {
+            bake(cell);
+        }
+        // Out of the frustum when the corner of the box farthest along a plane is behind it
+        bool visible = true;
+        for (unsigned int i = 0; i < 6 && visible; ++i)
+        {
+            glm::vec3 corner(planes[i].x >= 0.f ? cell.max.x : cell.min.x,
+                             planes[i].y >= 0.f ? cell.max.y : cell.min.y,
+                             planes[i].z >= 0.f ? cell.max.z : cell.min.z);
+            visible = glm::dot(glm::vec3(planes[i]), corner) + planes[i].w >= 0.f;
+        }
+        if (!visible)
+        {
+            continue;
+        }
+        glBindVertexArray(cell.VAO);
+        RenderStatistics::countVertexArray(cell.VAO);
+        glDrawArrays(GL_TRIANGLES, 0, cell.vertex_count);
+        RenderStatistics::countInstancedBatch();
+    }
+    glBindVertexArray(0);
+}
+
+long long StaticBatcher::cellKey(const glm::vec3& position) const
+{
+    long long x = static_cast<long long>(std::floor(position.x / _cell_size));
+    long long y = static_cast<long long>(std::floor(position.y / _cell_size));
+    return (x << 32) ^ (y & 0xffffffff);
+}
+
+void StaticBatcher::join(unsigned int slot)
+{
+    Member_t& member = _members[slot];
+    auto it = _cells.find(member.cell);
+    if (it == _cells.end())
+    {
+        it = _cells.emplace(member.cell, Cell_t{{}, 0, 0, 0, 0, true, glm::vec3(0.f), glm::vec3(0.f)}).first;
+    }
+    member.index = it->second.members.size();
+    it->second.members.push_back(slot);
+    it->second.dirty = true;
+}
+
+void StaticBatcher::leave(unsigned int slot)
+{
+    Member_t& member = _members[slot];
+    Cell_t& cell = _cells[member.cell];
+    unsigned int moved = cell.members.back();
+    cell.members[member.index] = moved;
+    _members[moved].index = member.index;
+    cell.members.pop_back();
+    cell.dirty = true;
+    member.index = -1;
+}
+
+void StaticBatcher::bake(Cell_t& cell)
+{
+    std::vector<Vertex_t> vertices;
+    vertices.reserve(cell.members.size() * 6);
+    const Member_t& first = _members[cell.members.front()];
+    cell.min = cell.max = first.corners[0];
+    for (unsigned int slot : cell.members)
+    {
+        const Member_t& member = _members[slot];
+        GLint material = member.material;
+        for (unsigned int corner : {0, 1, 2, 0, 2, 3})
+        {
+            const glm::vec3& position = member.corners[corner];
+            vertices.push_back(Vertex_t{position.x, position.y, position.z, material});
+        }
+        for (const glm::vec3& position : member.corners)
+        {
+            cell.min = glm::vec3(std::min(cell.min.x, position.x), std::min(cell.min.y, position.y), std::min(cell.min.z, position.z));
+            cell.max = glm::vec3(std::max(cell.max.x, position.x), std::max(cell.max.y, position.y), std::max(cell.max.z, position.z));
+        }
+    }
+
+    if (cell.VAO == 0)
+    {
+        glGenVertexArrays(1, &cell.VAO);
+        glGenBuffers(1, &cell.VBO);
+        glBindVertexArray(cell.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, cell.VBO);
+        GLint loc = _shader_program->bindVertexAttribute("position", 3, GL_FLOAT, GL_FALSE,
+                sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, x)));
+        glEnableVertexAttribArray(loc);
+        loc = _shader_program->bindVertexAttributeI("material", 1, GL_INT,
+                sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, material)));
+        glEnableVertexAttribArray(loc);
+    }
+    else
+    {
+        glBindVertexArray(cell.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, cell.VBO);
+    }
+    std::size_t bytes = vertices.size() * sizeof(Vertex_t);
+    if (bytes > cell.capacity)
+    {
+        cell.capacity = bytes;
+        glBufferData(GL_ARRAY_BUFFER, bytes, vertices.data(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+    }
+    RenderStatistics::countBufferUpload(bytes);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    cell.vertex_count = vertices.size();
+    cell.dirty = false;
+}
+}
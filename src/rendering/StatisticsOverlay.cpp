@@ -0,0 +1,70 @@
+#include <cstdio>
+#include "rendering/Plugin.hpp"
+#include "rendering/StatisticsOverlay.hpp"
+
+namespace rendering
+{
+StatisticsOverlay::StatisticsOverlay(Font* font, float size, const Color& color):
+Text(font, "", size, color),
+_statistics_plugin(nullptr),
+_refresh_interval(0.25f),
+_elapsed(0.f)
+{}
+
+void StatisticsOverlay::init()
+{
+    _statistics_plugin = actor().game().getPlugin<Plugin>();
+    Text::init();
+}
+
+void StatisticsOverlay::update()
+{
+    _elapsed += actor().game().deltaTime().asSeconds();
+    if (_elapsed >= _refresh_interval || getString().empty())
+    {
+        _elapsed = 0.f;
+        refresh();
+    }
+}
+
+void StatisticsOverlay::setRefreshInterval(float seconds)
+{
+    _refresh_interval = seconds;
+}
+
+float StatisticsOverlay::getRefreshInterval() const
+{
+    return _refresh_interval;
+}
+
+const char* StatisticsOverlay::behaviorName()
+{
+    return "rendering::StatisticsOverlay";
+}
+
+void StatisticsOverlay::refresh()
+{
+    const RenderStatistics& statistics = _statistics_plugin->statistics();
+    const FrameStatistics_t& last = statistics.last();
+    char text[512];
+    std::snprintf(text, sizeof(text),
+            "frame %.2f ms (p50 %.2f, p95 %.2f)\n"
+            "prepare %.2f  draw %.2f  present %.2f\n"
+            "drawables %u  visible %u  culled %u  occluded %u\n"
+            "draw calls %u  batches %u\n"
+            "programs %u  vaos %u  uniforms %u\n"
+            "uploaded %.1f KB\n"
+            "textures %.1f / %.1f MB  evicted %.1f KB  streamed %.1f KB",
+            last.frame_ms,
+            statistics.percentile(&FrameStatistics_t::frame_ms, 0.5f),
+            statistics.percentile(&FrameStatistics_t::frame_ms, 0.95f),
+            last.prepare_ms, last.draw_ms, last.present_ms,
+            last.drawables_registered, last.drawables_visible, last.drawables_culled, last.drawables_occluded,
+            last.draw_calls, last.instanced_batches,
+            last.program_switches, last.vao_switches, last.uniform_uploads,
+            last.buffer_bytes / 1024.0,
+            last.texture_resident_bytes / (1024.0 * 1024.0), last.texture_budget_bytes / (1024.0 * 1024.0),
+            last.texture_evicted_bytes / 1024.0, last.texture_streamed_bytes / 1024.0);
+    setString(text);
+}
+}
@@ -0,0 +1,289 @@
+#include <cstddef>
+#include <map>
+#include "rendering/Text.hpp"
+#include "rendering/Batch.hpp"
+#include "rendering/Plugin.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+class TextBatch : public Batch
+{
+public:
+    struct Vertex_t {
+        float x, y, z;
+        float u, v;
+        unsigned char r, g, b, a;
+    };
+
+    TextBatch(ShaderProgram* shader_program):
+    _shader_program(shader_program)
+    {}
+
+    std::vector<Vertex_t>& vertices(Font* font, unsigned int page)
+    {
+        auto it = _pages.find(std::make_pair(font, page));
+        if (it == _pages.end())
+        {
+            Page_t new_page{std::vector<Vertex_t>(), 0, 0, 0};
+            glGenVertexArrays(1, &new_page.VAO);
+            glGenBuffers(1, &new_page.VBO);
+            glBindVertexArray(new_page.VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, new_page.VBO);
+            GLint loc = _shader_program->bindVertexAttribute("position", 3, GL_FLOAT, GL_FALSE,
+                    sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, x)));
+            glEnableVertexAttribArray(loc);
+            loc = _shader_program->bindVertexAttribute("uv", 2, GL_FLOAT, GL_FALSE,
+                    sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, u)));
+            glEnableVertexAttribArray(loc);
+            loc = _shader_program->bindVertexAttribute("color", 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                    sizeof(Vertex_t), reinterpret_cast<GLvoid*>(offsetof(Vertex_t, r)));
+            glEnableVertexAttribArray(loc);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindVertexArray(0);
+            it = _pages.emplace(std::make_pair(font, page), new_page).first;
+        }
+        return it->second.vertices;
+    }
+
+    void flush() override
+    {
+        bool used = false;
+        for (auto& it : _pages)
+        {
+            Page_t& page = it.second;
+            if (page.vertices.empty())
+            {
+                continue;
+            }
+            if (!used)
+            {
+                used = true;
+                _shader_program->use();
+                _shader_program->setUniformMatrix4f("model", glm::mat4(1.0));
+                _shader_program->setUniform1i("atlas", 0);
+                glActiveTexture(GL_TEXTURE0);
+                // Glyph quads overlap, their edges must blend rather than depth test each other out
+                glDepthMask(GL_FALSE);
+            }
+
+            std::size_t bytes = page.vertices.size() * sizeof(Vertex_t);
+            glBindVertexArray(page.VAO);
+            RenderStatistics::countVertexArray(page.VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, page.VBO);
+            if (bytes > page.capacity)
+            {
+                page.capacity = bytes * 2;
+            }
+            // Orphan the previous storage so the driver does not wait for the last draw
+            glBufferData(GL_ARRAY_BUFFER, page.capacity, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, page.vertices.data());
+            RenderStatistics::countBufferUpload(bytes);
+            glBindTexture(GL_TEXTURE_2D, it.first.first->pageTexture(it.first.second));
+            glDrawArrays(GL_TRIANGLES, 0, page.vertices.size());
+            RenderStatistics::countInstancedBatch();
+            page.vertices.clear();
+        }
+        if (used)
+        {
+            glDepthMask(GL_TRUE);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindVertexArray(0);
+        }
+    }
+
+private:
+    struct Page_t {
+        std::vector<Vertex_t> vertices;
+        GLuint VAO, VBO;
+        std::size_t capacity;
+    };
+
+    ShaderProgram* _shader_program;
+    std::map<std::pair<Font*, unsigned int>, Page_t> _pages;
+};
+
+ShaderProgram* Text::_shader_program = nullptr;
+TextBatch* Text::_batch = nullptr;
+
+Text::Text(Font* font, const std::string& string, float size, const Color& color):
+_font(font),
+_string(string),
+_size(size),
+_color(color),
+_layout_dirty(true),
+_plugin(nullptr)
+{}
+
+void Text::init()
+{
+    _plugin = actor().game().getPlugin<Plugin>();
+    if (isHeadless())
+    {
+        Drawable::init();
+        return;
+    }
+    if (_shader_program == nullptr)
+    {
+        Shader v_shader;
+        v_shader.loadFromFile(Shader::Type::VERTEX_SHADER, "shaders/text.vert");
+        hum::assert_msg(v_shader.isCompiled(), "Error compiling text.vert\n", v_shader.log());
+        Shader f_shader;
+        f_shader.loadFromFile(Shader::Type::FRAGMENT_SHADER, "shaders/text.frag");
+        hum::assert_msg(f_shader.isCompiled(), "Error compiling text.frag\n", f_shader.log());
+        _shader_program = new ShaderProgram();
+        _shader_program
+            ->addShader(v_shader)
+            ->addShader(f_shader)
+            ->link()
+            ->bindFragmentOutput("out_color");
+        if (!_shader_program->isLinked())
+        {
+            hum::log_d(_shader_program->log());
+            delete _shader_program;
+            _shader_program = nullptr;
+        }
+    }
+
+    if (_batch == nullptr)
+    {
+        _batch = new TextBatch(_shader_program);
+        _plugin->addBatch(_batch);
+    }
+    setShaderProgram(_shader_program);
+    Drawable::init();
+}
+
+void Text::onDestroy()
+{
+    Drawable::onDestroy();
+}
+
+void Text::setString(const std::string& string)
+{
+    if (string != _string)
+    {
+        _string = string;
+        _layout_dirty = true;
+    }
+}
+
+const std::string& Text::getString() const
+{
+    return _string;
+}
+
+void Text::setSize(float size)
+{
+    if (size != _size)
+    {
+        _size = size;
+        _layout_dirty = true;
+    }
+}
+
+float Text::getSize() const
+{
+    return _size;
+}
+
+void Text::setColor(const Color& color)
+{
+    _color = color;
+}
+
+const Color& Text::getColor() const
+{
+    return _color;
+}
+
+void Text::setFont(Font* font)
+{
+    if (font != _font)
+    {
+        _font = font;
+        _layout_dirty = true;
+    }
+}
+
+Font* Text::getFont() const
+{
+    return _font;
+}
+
+void Text::draw()
+{
+    if (_layout_dirty)
+    {
+        layout();
+    }
+
+    const glm::mat4& model = _plugin->currentModelMatrix();
+    unsigned char r = _color.r, g = _color.g, b = _color.b, a = _color.a;
+    for (const Quad_t& quad : _layout)
+    {
+        glm::vec4 p00 = model * glm::vec4(quad.x0, quad.y0, 0.f, 1.f);
+        glm::vec4 p10 = model * glm::vec4(quad.x1, quad.y0, 0.f, 1.f);
+        glm::vec4 p01 = model * glm::vec4(quad.x0, quad.y1, 0.f, 1.f);
+        glm::vec4 p11 = model * glm::vec4(quad.x1, quad.y1, 0.f, 1.f);
+        std::vector<TextBatch::Vertex_t>& vertices = _batch->vertices(_font, quad.page);
+        vertices.push_back(TextBatch::Vertex_t{p00.x, p00.y, p00.z, quad.u0, quad.v0, r, g, b, a});
+        vertices.push_back(TextBatch::Vertex_t{p10.x, p10.y, p10.z, quad.u1, quad.v0, r, g, b, a});
+        vertices.push_back(TextBatch::Vertex_t{p11.x, p11.y, p11.z, quad.u1, quad.v1, r, g, b, a});
+        vertices.push_back(TextBatch::Vertex_t{p00.x, p00.y, p00.z, quad.u0, quad.v0, r, g, b, a});
+        vertices.push_back(TextBatch::Vertex_t{p11.x, p11.y, p11.z, quad.u1, quad.v1, r, g, b, a});
+        vertices.push_back(TextBatch::Vertex_t{p01.x, p01.y, p01.z, quad.u0, quad.v1, r, g, b, a});
+    }
+}
+
+const char* Text::behaviorName()
+{
+    return "rendering::Text";
+}
+
+void Text::layout()
+{
+    _layout.clear();
+    _layout_dirty = false;
+    if (_font == nullptr)
+    {
+        return;
+    }
+
+    float pen_x = 0.f, pen_y = 0.f;
+    for (std::size_t i = 0; i < _string.size();)
+    {
+        // Decode one UTF-8 code point
+        unsigned char c = _string[i];
+        unsigned int code_point = c;
+        unsigned int length = 1;
+        if (c >= 0xF0) { code_point = c & 0x07; length = 4; }
+        else if (c >= 0xE0) { code_point = c & 0x0F; length = 3; }
+        else if (c >= 0xC0) { code_point = c & 0x1F; length = 2; }
+        for (unsigned int j = 1; j < length && i + j < _string.size(); ++j)
+        {
+            code_point = (code_point << 6) | (static_cast<unsigned char>(_string[i + j]) & 0x3F);
+        }
+        i += length;
+
+        if (code_point == '\n')
+        {
+            pen_x = 0.f;
+            pen_y += _font->lineHeight() * _size;
+            continue;
+        }
+
+        const Font::Glyph& glyph = _font->glyph(code_point);
+        if (glyph.width > 0.f)
+        {
+            float x0 = pen_x + glyph.x * _size;
+            float y0 = pen_y + glyph.y * _size;
+            _layout.push_back(Quad_t{
+                    x0, y0, x0 + glyph.width * _size, y0 + glyph.height * _size,
+                    glyph.u0, glyph.v0, glyph.u1, glyph.v1,
+                    glyph.page});
+        }
+        pen_x += glyph.advance * _size;
+    }
+}
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include "rendering/Texture.hpp"
+
+namespace rendering
+{
+Texture::Texture():
+_id(0),
+_width(0),
+_height(0),
+_resident_level(0),
+_wanted_level(0),
+_last_used(0),
+_target_level(0)
+{}
+
+Texture::~Texture()
+{
+    if (_id != 0)
+    {
+        glDeleteTextures(1, &_id);
+    }
+}
+
+GLuint Texture::getId() const
+{
+    return _id;
+}
+
+bool Texture::isLoaded() const
+{
+    return !_levels.empty();
+}
+
+unsigned int Texture::getWidth() const
+{
+    return _width;
+}
+
+unsigned int Texture::getHeight() const
+{
+    return _height;
+}
+
+unsigned int Texture::levelCount() const
+{
+    return _levels.size();
+}
+
+std::size_t Texture::levelBytes(unsigned int level) const
+{
+    return _levels[level].size();
+}
+
+unsigned int Texture::residentLevel() const
+{
+    return _resident_level;
+}
+
+std::size_t Texture::residentBytes() const
+{
+    return chainBytes(_resident_level);
+}
+
+unsigned int Texture::levelWidth(unsigned int level) const
+{
+    return std::max(_width >> level, 1u);
+}
+
+unsigned int Texture::levelHeight(unsigned int level) const
+{
+    return std::max(_height >> level, 1u);
+}
+
+std::size_t Texture::chainBytes(unsigned int level) const
+{
+    std::size_t bytes = 0;
+    for (; level < _levels.size(); ++level)
+    {
+        bytes += _levels[level].size();
+    }
+    return bytes;
+}
+
+void Texture::makeResident(unsigned int level)
+{
+    if (level == _resident_level)
+    {
+        return;
+    }
+    // A new texture with only the kept levels: changing the base level of
+    // the old one would still keep the memory of the levels above it
+    GLuint id = 0;
+    if (level < _levels.size())
+    {
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        for (unsigned int i = level; i < _levels.size(); ++i)
+        {
+            glTexImage2D(GL_TEXTURE_2D, i - level, GL_RGBA8, levelWidth(i), levelHeight(i), 0,
+                    GL_RGBA, GL_UNSIGNED_BYTE, _levels[i].data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _levels.size() - 1 - level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (_id != 0)
+    {
+        glDeleteTextures(1, &_id);
+    }
+    _id = id;
+    _resident_level = level;
+}
+}
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cstring>
+#include <SDL2/SDL.h>
+#include "hummingbird/hum.hpp"
+#include "rendering/Archive.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/TextureManager.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Levels this size or smaller are never evicted
+const unsigned int TAIL_SIZE = 32;
+}
+
+TextureManager::TextureManager():
+_budget(256 * 1024 * 1024),
+_upload_budget(4 * 1024 * 1024),
+_resident_bytes(0),
+_evicted_bytes(0),
+_streamed_bytes(0),
+_frame(1),
+_next_id(0),
+_stop(false)
+{}
+
+TextureManager::~TextureManager()
+{
+    if (_loader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_one();
+        _loader.join();
+    }
+}
+
+Texture* TextureManager::load(const std::string& filename)
+{
+    unsigned int id = _next_id++;
+    Texture* texture = new Texture();
+    _textures[id].reset(texture);
+    _ids[texture] = id;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // The archives are looked up here, they are only mounted from this thread
+        _requests.push_back(Request_t{id, filename, Archive::findMounted(filename)});
+    }
+    if (!_loader.joinable())
+    {
+        _loader = std::thread(&TextureManager::loaderLoop, this);
+    }
+    _wake.notify_one();
+    return texture;
+}
+
+Texture* TextureManager::create(unsigned int width, unsigned int height, const unsigned char* pixels)
+{
+    unsigned int id = _next_id++;
+    Texture* texture = new Texture();
+    _textures[id].reset(texture);
+    _ids[texture] = id;
+    Loaded_t loaded{id, std::string(), width, height, {}};
+    loaded.levels.emplace_back(pixels, pixels + width * height * 4);
+    buildLevels(loaded);
+    {
+        // Received by update(), the only place with a current OpenGL context
+        std::lock_guard<std::mutex> lock(_mutex);
+        _loaded.push_back(std::move(loaded));
+    }
+    return texture;
+}
+
+void TextureManager::release(Texture* texture)
+{
+    auto it = _ids.find(texture);
+    if (it == _ids.end())
+    {
+        return;
+    }
+    _resident_bytes -= texture->residentBytes();
+    _order.erase(std::remove(_order.begin(), _order.end(), texture), _order.end());
+    // A load in flight finds no Texture and is dropped
+    _textures.erase(it->second);
+    _ids.erase(it);
+}
+
+void TextureManager::touch(Texture* texture, float screen_size)
+{
+    if (!texture->isLoaded())
+    {
+        return;
+    }
+    // Level whose texels are about the size of a pixel
+    float texels = std::max(texture->getWidth(), texture->getHeight());
+    unsigned int level = 0;
+    while (level + 1 < texture->levelCount() && texels * 0.5f >= screen_size)
+    {
+        texels *= 0.5f;
+        ++level;
+    }
+    texture->_wanted_level = std::min(texture->_wanted_level, level);
+    texture->_last_used = _frame;
+}
+
+void TextureManager::update()
+{
+    std::vector<Loaded_t> loaded;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        loaded.swap(_loaded);
+    }
+    for (Loaded_t& value : loaded)
+    {
+        receive(value);
+    }
+
+    // Levels wanted: the finer ones the last frame drew, and what is resident
+    std::size_t total = 0;
+    for (Texture* texture : _order)
+    {
+        texture->_target_level = std::min(neededLevel(*texture), texture->_resident_level);
+        total += texture->chainBytes(texture->_target_level);
+    }
+    if (total > _budget)
+    {
+        // Least recently drawn first, then the ones wanting the coarsest levels
+        std::sort(_order.begin(), _order.end(), [](const Texture* left, const Texture* right)
+                {
+                    return left->_last_used != right->_last_used ? left->_last_used < right->_last_used
+                        : left->_target_level > right->_target_level;
+                });
+        // Levels finer than the draws need go first, then the needed ones
+        for (unsigned int pass = 0; pass < 2 && total > _budget; ++pass)
+        {
+            for (unsigned int i = 0; i < _order.size() && total > _budget; ++i)
+            {
+                Texture* texture = _order[i];
+                unsigned int limit = pass == 0 ? neededLevel(*texture) : tailLevel(*texture);
+                while (texture->_target_level < limit && total > _budget)
+                {
+                    total -= texture->levelBytes(texture->_target_level);
+                    ++texture->_target_level;
+                }
+            }
+        }
+    }
+
+    FrameStatistics_t& statistics = RenderStatistics::current();
+    for (Texture* texture : _order)
+    {
+        if (texture->_target_level > texture->_resident_level)
+        {
+            std::size_t evicted = texture->residentBytes() - texture->chainBytes(texture->_target_level);
+            texture->makeResident(texture->_target_level);
+            _resident_bytes -= evicted;
+            _evicted_bytes += evicted;
+            statistics.texture_evicted_bytes += evicted;
+        }
+    }
+
+    // Most recently drawn first, then the ones wanting the finest levels
+    std::sort(_order.begin(), _order.end(), [](const Texture* left, const Texture* right)
+            {
+                return left->_last_used != right->_last_used ? left->_last_used > right->_last_used
+                    : left->_target_level < right->_target_level;
+            });
+    std::size_t uploaded = 0;
+    for (Texture* texture : _order)
+    {
+        if (texture->_target_level >= texture->_resident_level)
+        {
+            continue;
+        }
+        // One level at a time, the coarser ones are uploaded again with it
+        unsigned int level = texture->_resident_level - 1;
+        std::size_t upload = texture->chainBytes(level);
+        if (uploaded > 0 && uploaded + upload > _upload_budget)
+        {
+            break;
+        }
+        uploaded += upload;
+        texture->makeResident(level);
+        _resident_bytes += texture->levelBytes(level);
+        _streamed_bytes += texture->levelBytes(level);
+        statistics.texture_streamed_bytes += texture->levelBytes(level);
+    }
+
+    for (Texture* texture : _order)
+    {
+        texture->_wanted_level = texture->levelCount();
+    }
+    statistics.texture_budget_bytes = _budget;
+    statistics.texture_resident_bytes = _resident_bytes;
+    ++_frame;
+}
+
+void TextureManager::setBudget(std::size_t bytes)
+{
+    _budget = bytes;
+}
+
+std::size_t TextureManager::getBudget() const
+{
+    return _budget;
+}
+
+void TextureManager::setUploadBudget(std::size_t bytes)
+{
+    _upload_budget = bytes;
+}
+
+std::size_t TextureManager::getUploadBudget() const
+{
+    return _upload_budget;
+}
+
+std::size_t TextureManager::residentBytes() const
+{
+    return _resident_bytes;
+}
+
+unsigned long long TextureManager::evictedBytes() const
+{
+    return _evicted_bytes;
+}
+
+unsigned long long TextureManager::streamedBytes() const
+{
+    return _streamed_bytes;
+}
+
+std::size_t TextureManager::size() const
+{
+    return _textures.size();
+}
+
+bool TextureManager::decode(const Request_t& request, Loaded_t& loaded)
+{
+    SDL_RWops* input = request.packed.data() != nullptr
+        ? SDL_RWFromConstMem(request.packed.data(), request.packed.size())
+        : SDL_RWFromFile(request.filename.c_str(), "rb");
+    SDL_Surface* surface = input != nullptr ? SDL_LoadBMP_RW(input, 1) : nullptr;
+    if (surface == nullptr)
+    {
+        return false;
+    }
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (rgba == nullptr)
+    {
+        return false;
+    }
+    loaded.width = rgba->w;
+    loaded.height = rgba->h;
+    loaded.levels.emplace_back(loaded.width * loaded.height * 4);
+    std::vector<unsigned char>& pixels = loaded.levels.back();
+    SDL_LockSurface(rgba);
+    // SDL stores the top row first, OpenGL the bottom one
+    for (unsigned int y = 0; y < loaded.height; ++y)
+    {
+        const unsigned char* row = static_cast<const unsigned char*>(rgba->pixels) + (loaded.height - 1 - y) * rgba->pitch;
+        std::memcpy(pixels.data() + y * loaded.width * 4, row, loaded.width * 4);
+    }
+    SDL_UnlockSurface(rgba);
+    SDL_FreeSurface(rgba);
+    buildLevels(loaded);
+    return true;
+}
+
+void TextureManager::buildLevels(Loaded_t& loaded)
+{
+    unsigned int width = loaded.width, height = loaded.height;
+    while (width > 1 || height > 1)
+    {
+        unsigned int next_width = std::max(width / 2, 1u), next_height = std::max(height / 2, 1u);
+        std::vector<unsigned char> next(next_width * next_height * 4);
+        const std::vector<unsigned char>& source = loaded.levels.back();
+        // Box filter of the 2x2 texels below, clamped on the sides of size 1
+        for (unsigned int y = 0; y < next_height; ++y)
+        {
+            unsigned int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+            for (unsigned int x = 0; x < next_width; ++x)
+            {
+                unsigned int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+                for (unsigned int c = 0; c < 4; ++c)
+                {
+                    unsigned int sum = source[(y0 * width + x0) * 4 + c] + source[(y0 * width + x1) * 4 + c]
+                        + source[(y1 * width + x0) * 4 + c] + source[(y1 * width + x1) * 4 + c];
+                    next[(y * next_width + x) * 4 + c] = (sum + 2) / 4;
+                }
+            }
+        }
+        loaded.levels.push_back(std::move(next));
+        width = next_width;
+        height = next_height;
+    }
+}
+
+void TextureManager::loaderLoop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _wake.wait(lock, [this] { return _stop || !_requests.empty(); });
+        if (_stop)
+        {
+            return;
+        }
+        Request_t request = std::move(_requests.front());
+        _requests.pop_front();
+        lock.unlock();
+        Loaded_t loaded{request.id, request.filename, 0, 0, {}};
+        if (!decode(request, loaded))
+        {
+            loaded.levels.clear();
+        }
+        lock.lock();
+        _loaded.push_back(std::move(loaded));
+    }
+}
+
+void TextureManager::receive(Loaded_t& loaded)
+{
+    auto it = _textures.find(loaded.id);
+    if (it == _textures.end())
+    {
+        // Released while loading
+        return;
+    }
+    Texture* texture = it->second.get();
+    if (loaded.levels.empty())
+    {
+        hum::log_e("Unable to load texture ", loaded.filename, ": not found or not a BMP image");
+        return;
+    }
+    texture->_width = loaded.width;
+    texture->_height = loaded.height;
+    texture->_levels.swap(loaded.levels);
+    texture->_resident_level = texture->levelCount();
+    texture->_wanted_level = texture->levelCount();
+    // Nothing drawn with it can be blank: the tail is resident right away
+    texture->makeResident(tailLevel(*texture));
+    _resident_bytes += texture->residentBytes();
+    _order.push_back(texture);
+}
+
+unsigned int TextureManager::neededLevel(const Texture& texture) const
+{
+    return std::min(texture._wanted_level, tailLevel(texture));
+}
+
+unsigned int TextureManager::tailLevel(const Texture& texture) const
+{
+    unsigned int level = 0;
+    while (level + 1 < texture.levelCount()
+            && std::max(texture.levelWidth(level), texture.levelHeight(level)) > TAIL_SIZE)
+    {
+        ++level;
+    }
+    return level;
+}
+}
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include "rendering/Tilemap.hpp"
+#include "rendering/Plugin.hpp"
+#include "rendering/RenderStatistics.hpp"
+
+namespace rendering
+{
+namespace
+{
+// Chunks not visible for this many draws release their vertex buffer
+const unsigned long long EVICT_FRAMES = 600;
+
+bool outsideClipSpace(const glm::vec4* corners)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        // Behind the camera: keep it, the test below is only valid for w > 0
+        if (corners[i].w <= 0.f)
+        {
+            return false;
+        }
+    }
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        bool all_below = true, all_above = true;
+        for (int i = 0; i < 4; ++i)
+        {
+            all_below = all_below && corners[i][axis] < -corners[i].w;
+            all_above = all_above && corners[i][axis] > corners[i].w;
+        }
+        if (all_below || all_above)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+ShaderProgram* Tilemap::_shader_program = nullptr;
+GLuint Tilemap::_VAO = 0;
+
+Tilemap::Tilemap(unsigned int width, unsigned int height):
+_tile_loc(0),
+_palette_texture(0),
+_palette(256 * 4, 255),
+_palette_dirty(true),
+_width(width),
+_height(height),
+_chunks_x((width + CHUNK_SIZE - 1) / CHUNK_SIZE),
+_chunks_y((height + CHUNK_SIZE - 1) / CHUNK_SIZE),
+_chunks(_chunks_x * _chunks_y, Chunk_t{std::vector<Tile>(), 0, 0, 0, true, 0}),
+_frame(0),
+_chunks_drawn(0),
+_chunks_resident(0),
+_plugin(nullptr)
+{}
+
+Tilemap::~Tilemap()
+{
+    for (Chunk_t& chunk : _chunks)
+    {
+        release(chunk);
+    }
+    if (_palette_texture != 0)
+    {
+        glDeleteTextures(1, &_palette_texture);
+    }
+}
+
+void Tilemap::init()
+{
+    _plugin = actor().game().getPlugin<Plugin>();
+    if (isHeadless())
+    {
+        Drawable::init();
+        return;
+    }
+    if (_shader_program == nullptr)
+    {
+        Shader v_shader;
+        v_shader.loadFromFile(Shader::Type::VERTEX_SHADER, "shaders/tilemap.vert");
+        hum::assert_msg(v_shader.isCompiled(), "Error compiling tilemap.vert\n", v_shader.log());
+        Shader f_shader;
+        f_shader.loadFromFile(Shader::Type::FRAGMENT_SHADER, "shaders/tilemap.frag");
+        hum::assert_msg(f_shader.isCompiled(), "Error compiling tilemap.frag\n", f_shader.log());
+        _shader_program = new ShaderProgram();
+        _shader_program
+            ->addShader(v_shader)
+            ->addShader(f_shader)
+            ->link()
+            ->bindFragmentOutput("out_color");
+        if (!_shader_program->isLinked())
+        {
+            hum::log_d(_shader_program->log());
+            delete _shader_program;
+            _shader_program = nullptr;
+        }
+    }
+
+    if (_VAO == 0)
+    {
+        glGenVertexArrays(1, &_VAO);
+    }
+
+    glGenTextures(1, &_palette_texture);
+    glBindTexture(GL_TEXTURE_2D, _palette_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 256, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, _palette.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    _palette_dirty = false;
+
+    setShaderProgram(_shader_program);
+    Drawable::init();
+}
+
+void Tilemap::onDestroy()
+{
+    Drawable::onDestroy();
+}
+
+void Tilemap::setShaderProgram(ShaderProgram* shader_program)
+{
+    Drawable::setShaderProgram(shader_program);
+    if (_VAO == 0)
+    {
+        // Not initialized yet, or headless: init() binds the attributes
+        return;
+    }
+    glBindVertexArray(_VAO);
+    _tile_loc = shaderProgram()->bindVertexAttribute("tile", 3, GL_UNSIGNED_BYTE, GL_FALSE, 4, 0);
+    glVertexAttribDivisor(_tile_loc, 1);
+    glBindVertexArray(0);
+}
+
+void Tilemap::setTile(unsigned int x, unsigned int y, Tile tile)
+{
+    hum::assert_msg(x < _width && y < _height, "Tile out of the Tilemap");
+    Chunk_t& chunk = chunkAt(x, y);
+    unsigned int index = (y % CHUNK_SIZE) * CHUNK_SIZE + (x % CHUNK_SIZE);
+    if (chunk.tiles.empty())
+    {
+        if (chunk.fill == tile)
+        {
+            return;
+        }
+        chunk.tiles.assign(CHUNK_SIZE * CHUNK_SIZE, chunk.fill);
+    }
+    if (chunk.tiles[index] != tile)
+    {
+        chunk.tiles[index] = tile;
+        chunk.dirty = true;
+    }
+}
+
+Tilemap::Tile Tilemap::getTile(unsigned int x, unsigned int y) const
+{
+    hum::assert_msg(x < _width && y < _height, "Tile out of the Tilemap");
+    const Chunk_t& chunk = chunkAt(x, y);
+    if (chunk.tiles.empty())
+    {
+        return chunk.fill;
+    }
+    return chunk.tiles[(y % CHUNK_SIZE) * CHUNK_SIZE + (x % CHUNK_SIZE)];
+}
+
+void Tilemap::fill(Tile tile)
+{
+    for (Chunk_t& chunk : _chunks)
+    {
+        std::vector<Tile>().swap(chunk.tiles);
+        chunk.fill = tile;
+        chunk.dirty = true;
+    }
+}
+
+void Tilemap::setTileColor(Tile tile, const Color& color)
+{
+    _palette[tile * 4 + 0] = color.r;
+    _palette[tile * 4 + 1] = color.g;
+    _palette[tile * 4 + 2] = color.b;
+    _palette[tile * 4 + 3] = color.a;
+    _palette_dirty = true;
+}
+
+unsigned int Tilemap::width() const
+{
+    return _width;
+}
+
+unsigned int Tilemap::height() const
+{
+    return _height;
+}
+
+unsigned int Tilemap::chunksDrawn() const
+{
+    return _chunks_drawn;
+}
+
+unsigned int Tilemap::chunksResident() const
+{
+    return _chunks_resident;
+}
+
+std::size_t Tilemap::memoryUsage() const
+{
+    std::size_t bytes = _chunks.capacity() * sizeof(Chunk_t);
+    for (const Chunk_t& chunk : _chunks)
+    {
+        bytes += chunk.tiles.capacity() * sizeof(Tile);
+    }
+    return bytes;
+}
+
+void Tilemap::draw()
+{
+    ++_frame;
+    if (_palette_dirty)
+    {
+        glBindTexture(GL_TEXTURE_2D, _palette_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 1, GL_RGBA, GL_UNSIGNED_BYTE, _palette.data());
+        _palette_dirty = false;
+    }
+
+    Camera& camera = _plugin->currentView().camera();
+    glm::mat4 mvp = camera.getProjection() * camera.getView() * _plugin->currentModelMatrix();
+
+    glBindVertexArray(_VAO);
+    RenderStatistics::countVertexArray(_VAO);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _palette_texture);
+    shaderProgram()->setUniform1i("palette", 0);
+    glEnableVertexAttribArray(_tile_loc);
+
+    _chunks_drawn = 0;
+    for (unsigned int chunk_y = 0; chunk_y < _chunks_y; ++chunk_y)
+    {
+        for (unsigned int chunk_x = 0; chunk_x < _chunks_x; ++chunk_x)
+        {
+            Chunk_t& chunk = _chunks[chunk_y * _chunks_x + chunk_x];
+            if (chunk.tiles.empty() && chunk.fill == 0)
+            {
+                if (chunk.VBO != 0)
+                {
+                    release(chunk);
+                }
+                continue;
+            }
+
+            float x0 = chunk_x * CHUNK_SIZE;
+            float y0 = chunk_y * CHUNK_SIZE;
+            float x1 = std::min(x0 + CHUNK_SIZE, static_cast<float>(_width));
+            float y1 = std::min(y0 + CHUNK_SIZE, static_cast<float>(_height));
+            glm::vec4 corners[4] = {
+                mvp * glm::vec4(x0, y0, 0.f, 1.f),
+                mvp * glm::vec4(x1, y0, 0.f, 1.f),
+                mvp * glm::vec4(x0, y1, 0.f, 1.f),
+                mvp * glm::vec4(x1, y1, 0.f, 1.f)
+            };
+            if (outsideClipSpace(corners))
+            {
+                continue;
+            }
+
+            if (chunk.dirty)
+            {
+                bake(chunk, chunk_x, chunk_y);
+            }
+            chunk.last_drawn = _frame;
+            if (chunk.tile_count == 0)
+            {
+                continue;
+            }
+
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+            glVertexAttribPointer(_tile_loc, 3, GL_UNSIGNED_BYTE, GL_FALSE, 4, 0);
+            shaderProgram()->setUniform2f("chunk_offset", x0, y0);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, chunk.tile_count);
+            RenderStatistics::countInstancedBatch();
+            ++_chunks_drawn;
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Amortized sweep of the buffers of chunks that went out of sight
+    if (_frame % 64 == 0)
+    {
+        for (Chunk_t& chunk : _chunks)
+        {
+            if (chunk.VBO != 0 && _frame - chunk.last_drawn > EVICT_FRAMES)
+            {
+                release(chunk);
+            }
+        }
+    }
+}
+
+const char* Tilemap::behaviorName()
+{
+    return "rendering::Tilemap";
+}
+
+Tilemap::Chunk_t& Tilemap::chunkAt(unsigned int x, unsigned int y)
+{
+    return _chunks[(y / CHUNK_SIZE) * _chunks_x + (x / CHUNK_SIZE)];
+}
+
+const Tilemap::Chunk_t& Tilemap::chunkAt(unsigned int x, unsigned int y) const
+{
+    return _chunks[(y / CHUNK_SIZE) * _chunks_x + (x / CHUNK_SIZE)];
+}
+
+void Tilemap::bake(Chunk_t& chunk, unsigned int chunk_x, unsigned int chunk_y)
+{
+    unsigned int columns = std::min(CHUNK_SIZE, _width - chunk_x * CHUNK_SIZE);
+    unsigned int rows = std::min(CHUNK_SIZE, _height - chunk_y * CHUNK_SIZE);
+
+    // One instance per non empty tile: x, y, tile, padding
+    std::vector<unsigned char> instances;
+    instances.reserve(columns * rows * 4);
+    for (unsigned int y = 0; y < rows; ++y)
+    {
+        for (unsigned int x = 0; x < columns; ++x)
+        {
+            Tile tile = chunk.tiles.empty() ? chunk.fill : chunk.tiles[y * CHUNK_SIZE + x];
+            if (tile != 0)
+            {
+                instances.push_back(x);
+                instances.push_back(y);
+                instances.push_back(tile);
+                instances.push_back(0);
+            }
+        }
+    }
+
+    // Chunks that became uniform go back to storing a single tile
+    if (!chunk.tiles.empty() && std::all_of(chunk.tiles.begin(), chunk.tiles.end(),
+                [&chunk](Tile tile) { return tile == chunk.tiles.front(); }))
+    {
+        chunk.fill = chunk.tiles.front();
+        std::vector<Tile>().swap(chunk.tiles);
+    }
+
+    chunk.tile_count = instances.size() / 4;
+    chunk.dirty = false;
+    if (chunk.tile_count == 0)
+    {
+        release(chunk);
+        chunk.dirty = false;
+        return;
+    }
+    if (chunk.VBO == 0)
+    {
+        glGenBuffers(1, &chunk.VBO);
+        ++_chunks_resident;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size(), instances.data(), GL_STATIC_DRAW);
+    RenderStatistics::countBufferUpload(instances.size());
+}
+
+void Tilemap::release(Chunk_t& chunk)
+{
+    if (chunk.VBO != 0)
+    {
+        glDeleteBuffers(1, &chunk.VBO);
+        chunk.VBO = 0;
+        --_chunks_resident;
+    }
+    chunk.tile_count = 0;
+    chunk.dirty = true;
+}
+}
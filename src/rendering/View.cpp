@@ -0,0 +1,55 @@
+#include "rendering/View.hpp"
+
+namespace rendering
+{
+View::View():
+_viewport(0.f, 0.f, 1.f, 1.f),
+_target(nullptr),
+_is_enabled(true)
+{}
+
+Camera& View::camera()
+{
+    return _camera;
+}
+
+const Camera& View::camera() const
+{
+    return _camera;
+}
+
+void View::setViewport(float x, float y, float width, float height)
+{
+    _viewport = glm::vec4(x, y, width, height);
+}
+
+const glm::vec4& View::getViewport() const
+{
+    return _viewport;
+}
+
+void View::setTarget(RenderTarget* target)
+{
+    _target = target;
+}
+
+RenderTarget* View::getTarget() const
+{
+    return _target;
+}
+
+void View::enable()
+{
+    _is_enabled = true;
+}
+
+void View::disable()
+{
+    _is_enabled = false;
+}
+
+bool View::isEnabled() const
+{
+    return _is_enabled;
+}
+}
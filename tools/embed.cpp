@@ -0,0 +1,128 @@
+// Generates the table of the sources compiled into the engine, see
+// rendering/EmbeddedShaders.hpp.
+//
+// Usage: embed output.inc file_or_directory...
+//
+// Directories are embedded recursively. Entries are named by their path as
+// given (e.g. "shaders/plain.vert"), which is what Shader::loadFromFile()
+// looks up.
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace
+{
+void collect(const std::string& path, std::vector<std::string>& files)
+{
+    struct stat path_stat;
+    if (stat(path.c_str(), &path_stat) != 0)
+    {
+        std::fprintf(stderr, "Skipping %s: not found\n", path.c_str());
+        return;
+    }
+    if (!S_ISDIR(path_stat.st_mode))
+    {
+        files.push_back(path.compare(0, 2, "./") == 0 ? path.substr(2) : path);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr)
+    {
+        return;
+    }
+    std::vector<std::string> children;
+    while (dirent* child = readdir(dir))
+    {
+        if (child->d_name[0] != '.')
+        {
+            children.push_back(child->d_name);
+        }
+    }
+    closedir(dir);
+    // Sorted, so the same inputs always produce the same header
+    std::sort(children.begin(), children.end());
+    for (const std::string& child : children)
+    {
+        collect(path.back() == '/' ? path + child : path + "/" + child, files);
+    }
+}
+
+// <contents> as C++ string literals, one per line of the file
+std::string quote(const std::string& contents)
+{
+    std::string literal = "        \"";
+    for (std::size_t i = 0; i < contents.size(); ++i)
+    {
+        unsigned char c = contents[i];
+        if (c == '\n')
+        {
+            literal += i + 1 < contents.size() ? "\\n\"\n        \"" : "\\n";
+        }
+        else if (c == '"' || c == '\\')
+        {
+            literal += '\\';
+            literal += c;
+        }
+        else if (c == '?')
+        {
+            // Keeps ?? from forming a trigraph
+            literal += "\\?";
+        }
+        else if (c < 0x20 || c >= 0x7f)
+        {
+            char escaped[8];
+            // Octal, unlike hex, stops after 3 digits
+            std::snprintf(escaped, sizeof(escaped), "\\%03o", c);
+            literal += escaped;
+        }
+        else
+        {
+            literal += c;
+        }
+    }
+    return literal + "\"";
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "Usage: %s output.inc file_or_directory...\n", argv[0]);
+        return 1;
+    }
+    const char* output = argv[1];
+    std::vector<std::string> files;
+    for (int arg = 2; arg < argc; ++arg)
+    {
+        collect(argv[arg], files);
+    }
+
+    // Included in the initializer of the table in rendering/EmbeddedShaders.hpp
+    std::string table = "// Generated by tools/embed, do not edit. See rendering/EmbeddedShaders.hpp.\n";
+    std::size_t total = 0;
+    for (const std::string& file : files)
+    {
+        std::ifstream stream(file, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        total += contents.size();
+        // The size is explicit: a view of the literal would stop at an embedded null
+        table += "{ \"" + file + "\", std::string_view(\n" + quote(contents) + ", "
+            + std::to_string(contents.size()) + ") },\n";
+    }
+
+    std::FILE* out = std::fopen(output, "wb");
+    if (out == nullptr || std::fwrite(table.data(), 1, table.size(), out) != table.size())
+    {
+        std::fprintf(stderr, "Unable to write %s\n", output);
+        return 1;
+    }
+    std::fclose(out);
+    std::printf("%s: %zu files, %zu bytes embedded\n", output, files.size(), total);
+    return 0;
+}
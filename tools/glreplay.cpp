@@ -0,0 +1,1002 @@
+// Replays an OpenGL trace written by rendering::GLCapture and times it.
+//
+// Usage: glreplay [--repeat N] [--quiet] trace.gltrace
+//
+// The set up frames run untimed, then the captured frames are replayed N
+// times (1 by default) on a hidden window. Every frame ends with glFinish(),
+// so its time includes the GPU work. Reports, per frame, the time spent in
+// the calls, the time until the GPU finished and the GPU time of a timer
+// query, then the time per call of every OpenGL function. --quiet leaves
+// out the frames and keeps the summaries. The first pass also pays for the
+// work drivers do lazily (compiling shaders on the first draw...): compare
+// the later ones between runs.
+//
+// No GPU is needed: with Mesa, LIBGL_ALWAYS_SOFTWARE=1 uses llvmpipe, which
+// gives stable numbers to compare runs of the same trace.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+#include <SDL2/SDL.h>
+#include "rendering/GLTraceFormat.hpp"
+
+namespace
+{
+using namespace rendering;
+using gl_trace_format::Op;
+
+typedef std::chrono::steady_clock Clock;
+
+double milliseconds(Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Arguments of a record, read in order. Reads past the record's end give
+// zeros and null pointers, and mark it overrun.
+class Reader
+{
+public:
+    Reader(const char* data, std::uint32_t size):
+    _data(data),
+    _end(data + size),
+    _overrun(false)
+    {}
+
+    std::uint32_t u()
+    {
+        std::uint32_t value = 0;
+        if (const char* data = take(sizeof(value)))
+        {
+            std::memcpy(&value, data, sizeof(value));
+        }
+        return value;
+    }
+
+    std::int32_t i()
+    {
+        return static_cast<std::int32_t>(u());
+    }
+
+    float f()
+    {
+        float value = 0.f;
+        if (const char* data = take(sizeof(value)))
+        {
+            std::memcpy(&value, data, sizeof(value));
+        }
+        return value;
+    }
+
+    std::uint64_t u64()
+    {
+        std::uint64_t low = u();
+        return low | static_cast<std::uint64_t>(u()) << 32;
+    }
+
+    // Null for an empty blob
+    const char* blob(std::uint32_t* size = nullptr)
+    {
+        std::uint32_t bytes = u();
+        const char* data = take((static_cast<std::size_t>(bytes) + 3) / 4 * 4);
+        if (data == nullptr)
+        {
+            bytes = 0;
+        }
+        if (size != nullptr)
+        {
+            *size = bytes;
+        }
+        return bytes == 0 ? nullptr : data;
+    }
+
+    // Blob holding a null terminated string, null if it doesn't
+    const char* text()
+    {
+        std::uint32_t size;
+        const char* data = blob(&size);
+        return data != nullptr && data[size - 1] == '\0' ? data : nullptr;
+    }
+
+    // Pointer to <count> names or enums
+    const GLuint* words(std::uint32_t count)
+    {
+        return reinterpret_cast<const GLuint*>(take(static_cast<std::size_t>(count) * sizeof(GLuint)));
+    }
+
+    // Whether a read went past the end of the record
+    bool overrun() const
+    {
+        return _overrun;
+    }
+
+private:
+    // The next <bytes> bytes, null if the record is shorter
+    const char* take(std::size_t bytes)
+    {
+        if (_overrun || bytes > static_cast<std::size_t>(_end - _data))
+        {
+            _overrun = true;
+            return nullptr;
+        }
+        const char* data = _data;
+        _data += bytes;
+        return data;
+    }
+
+    const char* _data;
+    const char* _end;
+    bool _overrun;
+};
+
+// Captured object names and locations to the ones of the replay
+class Names
+{
+public:
+    GLuint get(GLuint captured) const
+    {
+        auto it = _names.find(captured);
+        return it == _names.end() ? captured : it->second;
+    }
+
+    void set(GLuint captured, GLuint name)
+    {
+        _names[captured] = name;
+    }
+
+    void erase(GLuint captured)
+    {
+        _names.erase(captured);
+    }
+
+private:
+    std::unordered_map<GLuint, GLuint> _names;
+};
+
+std::uint64_t programKey(GLuint program, GLint location)
+{
+    return static_cast<std::uint64_t>(program) << 32 | static_cast<std::uint32_t>(location);
+}
+
+class Replayer
+{
+public:
+    Replayer():
+    _program(0),
+    _unpack_alignment(4),
+    _reported(static_cast<std::size_t>(Op::COUNT), false)
+    {}
+
+    void execute(Op op, Reader in);
+
+private:
+    typedef void (GLAPIENTRY* GenFunction)(GLsizei, GLuint*);
+    typedef void (GLAPIENTRY* DeleteFunction)(GLsizei, const GLuint*);
+
+    void generate(Names& names, GenFunction gen, Reader& in)
+    {
+        std::uint32_t n = in.u();
+        const GLuint* captured = in.words(n);
+        if (captured == nullptr)
+        {
+            return;
+        }
+        _scratch.resize(n);
+        gen(n, _scratch.data());
+        for (std::uint32_t i = 0; i < n; ++i)
+        {
+            names.set(captured[i], _scratch[i]);
+        }
+    }
+
+    void destroy(Names& names, DeleteFunction destroy, Reader& in)
+    {
+        std::uint32_t n = in.u();
+        const GLuint* captured = in.words(n);
+        if (captured == nullptr)
+        {
+            return;
+        }
+        _scratch.resize(n);
+        for (std::uint32_t i = 0; i < n; ++i)
+        {
+            _scratch[i] = names.get(captured[i]);
+            names.erase(captured[i]);
+        }
+        destroy(n, _scratch.data());
+    }
+
+    GLint uniform(GLint location) const
+    {
+        if (location < 0)
+        {
+            return location;
+        }
+        auto it = _uniforms.find(programKey(_program, location));
+        return it == _uniforms.end() ? location : it->second;
+    }
+
+    // Returns <valid>. The calls that aren't are skipped, the first one of
+    // every op is reported.
+    bool check(Op op, bool valid)
+    {
+        if (!valid && !_reported[static_cast<std::size_t>(op)])
+        {
+            _reported[static_cast<std::size_t>(op)] = true;
+            std::fprintf(stderr, "Skipping %s: its recorded data doesn't match its arguments\n",
+                    gl_trace_format::opName(op));
+        }
+        return valid;
+    }
+
+    // Whether the arguments of <op> are complete and its blob holds at least
+    // <needed> bytes, or is null when not <required>
+    bool check(Op op, const Reader& in, std::uint64_t blob_size, std::uint64_t needed, bool required)
+    {
+        return check(op, !in.overrun() && (blob_size >= needed || (blob_size == 0 && !required)));
+    }
+
+    GLuint attribute(GLuint index) const
+    {
+        auto it = _attributes.find(index);
+        return it == _attributes.end() ? index : it->second;
+    }
+
+    Names _buffers, _arrays, _textures, _framebuffers, _renderbuffers, _shaders, _programs;
+    // Uniform locations and block indices by captured (program, location)
+    std::unordered_map<std::uint64_t, GLint> _uniforms;
+    std::unordered_map<std::uint64_t, GLuint> _blocks;
+    // Attribute locations index the vertex arrays, not the programs: assumed the same in every program
+    std::unordered_map<GLuint, GLuint> _attributes;
+    // Captured program in use
+    GLuint _program;
+    GLint _unpack_alignment;
+    // Ops already reported by check()
+    std::vector<bool> _reported;
+    std::vector<GLuint> _scratch;
+};
+
+void Replayer::execute(Op op, Reader in)
+{
+    switch (op)
+    {
+        case Op::FRAME_END:
+            break;
+
+        case Op::GEN_BUFFERS:
+            generate(_buffers, glGenBuffers, in);
+            break;
+        case Op::DELETE_BUFFERS:
+            destroy(_buffers, glDeleteBuffers, in);
+            break;
+        case Op::BIND_BUFFER:
+        {
+            GLenum target = in.u();
+            glBindBuffer(target, _buffers.get(in.u()));
+            break;
+        }
+        case Op::BIND_BUFFER_BASE:
+        {
+            GLenum target = in.u();
+            GLuint index = in.u();
+            glBindBufferBase(target, index, _buffers.get(in.u()));
+            break;
+        }
+        case Op::BUFFER_DATA:
+        {
+            GLenum target = in.u();
+            GLsizeiptr size = in.u64();
+            GLenum usage = in.u();
+            std::uint32_t blob_size;
+            const char* data = in.blob(&blob_size);
+            // A null blob allocates without filling
+            if (check(op, in, blob_size, size, false) && size >= 0)
+            {
+                glBufferData(target, size, data, usage);
+            }
+            break;
+        }
+        case Op::BUFFER_SUB_DATA:
+        {
+            GLenum target = in.u();
+            GLintptr offset = in.u64();
+            GLsizeiptr size = in.u64();
+            std::uint32_t blob_size;
+            const char* data = in.blob(&blob_size);
+            if (check(op, in, blob_size, size, size > 0) && size >= 0)
+            {
+                glBufferSubData(target, offset, size, data);
+            }
+            break;
+        }
+        case Op::MAP_WRITE:
+        {
+            GLenum target = in.u();
+            GLintptr offset = in.u64();
+            GLsizeiptr length = in.u64();
+            GLbitfield access = in.u();
+            std::uint32_t blob_size;
+            const char* data = in.blob(&blob_size);
+            if (!check(op, in, blob_size, length, false) || length < 0)
+            {
+                break;
+            }
+            void* pointer = glMapBufferRange(target, offset, length, access);
+            if (pointer != nullptr && data != nullptr)
+            {
+                std::memcpy(pointer, data, length);
+            }
+            glUnmapBuffer(target);
+            break;
+        }
+
+        case Op::GEN_VERTEX_ARRAYS:
+            generate(_arrays, glGenVertexArrays, in);
+            break;
+        case Op::DELETE_VERTEX_ARRAYS:
+            destroy(_arrays, glDeleteVertexArrays, in);
+            break;
+        case Op::BIND_VERTEX_ARRAY:
+            glBindVertexArray(_arrays.get(in.u()));
+            break;
+        case Op::ENABLE_VERTEX_ATTRIB_ARRAY:
+            glEnableVertexAttribArray(attribute(in.u()));
+            break;
+        case Op::VERTEX_ATTRIB_POINTER:
+        {
+            GLuint index = attribute(in.u());
+            GLint size = in.i();
+            GLenum type = in.u();
+            GLboolean normalized = in.u();
+            GLsizei stride = in.i();
+            std::uintptr_t offset = in.u64();
+            glVertexAttribPointer(index, size, type, normalized, stride, reinterpret_cast<const void*>(offset));
+            break;
+        }
+        case Op::VERTEX_ATTRIB_I_POINTER:
+        {
+            GLuint index = attribute(in.u());
+            GLint size = in.i();
+            GLenum type = in.u();
+            GLsizei stride = in.i();
+            std::uintptr_t offset = in.u64();
+            glVertexAttribIPointer(index, size, type, stride, reinterpret_cast<const void*>(offset));
+            break;
+        }
+        case Op::VERTEX_ATTRIB_DIVISOR:
+        {
+            GLuint index = attribute(in.u());
+            glVertexAttribDivisor(index, in.u());
+            break;
+        }
+
+        case Op::GEN_TEXTURES:
+            generate(_textures, glGenTextures, in);
+            break;
+        case Op::DELETE_TEXTURES:
+            destroy(_textures, glDeleteTextures, in);
+            break;
+        case Op::BIND_TEXTURE:
+        {
+            GLenum target = in.u();
+            glBindTexture(target, _textures.get(in.u()));
+            break;
+        }
+        case Op::ACTIVE_TEXTURE:
+            glActiveTexture(in.u());
+            break;
+        case Op::TEX_PARAMETER_I:
+        {
+            GLenum target = in.u();
+            GLenum name = in.u();
+            glTexParameteri(target, name, in.i());
+            break;
+        }
+        case Op::TEX_IMAGE_2D:
+        {
+            GLenum target = in.u();
+            GLint level = in.i();
+            GLint internal_format = in.i();
+            GLsizei width = in.i();
+            GLsizei height = in.i();
+            GLint border = in.i();
+            GLenum format = in.u();
+            GLenum type = in.u();
+            std::uint32_t blob_size;
+            const char* pixels = in.blob(&blob_size);
+            // Null pixels allocate the level without filling it
+            if (check(op, in, blob_size, gl_trace_format::imageSize(width, height, format, type, _unpack_alignment), false))
+            {
+                glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+            }
+            break;
+        }
+        case Op::TEX_SUB_IMAGE_2D:
+        {
+            GLenum target = in.u();
+            GLint level = in.i();
+            GLint x = in.i();
+            GLint y = in.i();
+            GLsizei width = in.i();
+            GLsizei height = in.i();
+            GLenum format = in.u();
+            GLenum type = in.u();
+            std::uint32_t blob_size;
+            const char* pixels = in.blob(&blob_size);
+            std::size_t needed = gl_trace_format::imageSize(width, height, format, type, _unpack_alignment);
+            if (check(op, in, blob_size, needed, needed > 0))
+            {
+                glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+            }
+            break;
+        }
+        case Op::PIXEL_STORE_I:
+        {
+            GLenum name = in.u();
+            GLint param = in.i();
+            if (name == GL_UNPACK_ALIGNMENT)
+            {
+                _unpack_alignment = param;
+            }
+            glPixelStorei(name, param);
+            break;
+        }
+
+        case Op::GEN_FRAMEBUFFERS:
+            generate(_framebuffers, glGenFramebuffers, in);
+            break;
+        case Op::DELETE_FRAMEBUFFERS:
+            destroy(_framebuffers, glDeleteFramebuffers, in);
+            break;
+        case Op::BIND_FRAMEBUFFER:
+        {
+            GLenum target = in.u();
+            glBindFramebuffer(target, _framebuffers.get(in.u()));
+            break;
+        }
+        case Op::FRAMEBUFFER_TEXTURE_2D:
+        {
+            GLenum target = in.u();
+            GLenum attachment = in.u();
+            GLenum texture_target = in.u();
+            GLuint texture = _textures.get(in.u());
+            glFramebufferTexture2D(target, attachment, texture_target, texture, in.i());
+            break;
+        }
+        case Op::FRAMEBUFFER_RENDERBUFFER:
+        {
+            GLenum target = in.u();
+            GLenum attachment = in.u();
+            GLenum renderbuffer_target = in.u();
+            glFramebufferRenderbuffer(target, attachment, renderbuffer_target, _renderbuffers.get(in.u()));
+            break;
+        }
+        case Op::DRAW_BUFFER:
+            glDrawBuffer(in.u());
+            break;
+        case Op::DRAW_BUFFERS:
+        {
+            std::uint32_t n = in.u();
+            const GLuint* buffers = in.words(n);
+            if (check(op, buffers != nullptr))
+            {
+                glDrawBuffers(n, buffers);
+            }
+            break;
+        }
+        case Op::BLIT_FRAMEBUFFER:
+        {
+            GLint v[8];
+            for (GLint& value : v)
+            {
+                value = in.i();
+            }
+            GLbitfield mask = in.u();
+            glBlitFramebuffer(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], mask, in.u());
+            break;
+        }
+
+        case Op::GEN_RENDERBUFFERS:
+            generate(_renderbuffers, glGenRenderbuffers, in);
+            break;
+        case Op::DELETE_RENDERBUFFERS:
+            destroy(_renderbuffers, glDeleteRenderbuffers, in);
+            break;
+        case Op::BIND_RENDERBUFFER:
+        {
+            GLenum target = in.u();
+            glBindRenderbuffer(target, _renderbuffers.get(in.u()));
+            break;
+        }
+        case Op::RENDERBUFFER_STORAGE:
+        {
+            GLenum target = in.u();
+            GLenum internal_format = in.u();
+            GLsizei width = in.i();
+            glRenderbufferStorage(target, internal_format, width, in.i());
+            break;
+        }
+
+        case Op::CREATE_SHADER:
+        {
+            GLenum type = in.u();
+            _shaders.set(in.u(), glCreateShader(type));
+            break;
+        }
+        case Op::DELETE_SHADER:
+        {
+            GLuint captured = in.u();
+            glDeleteShader(_shaders.get(captured));
+            _shaders.erase(captured);
+            break;
+        }
+        case Op::SHADER_SOURCE:
+        {
+            GLuint shader = _shaders.get(in.u());
+            std::uint32_t size;
+            const GLchar* source = in.blob(&size);
+            GLint length = size;
+            if (check(op, !in.overrun()))
+            {
+                source = source != nullptr ? source : "";
+                glShaderSource(shader, 1, &source, &length);
+            }
+            break;
+        }
+        case Op::COMPILE_SHADER:
+            glCompileShader(_shaders.get(in.u()));
+            break;
+        case Op::CREATE_PROGRAM:
+            _programs.set(in.u(), glCreateProgram());
+            break;
+        case Op::DELETE_PROGRAM:
+        {
+            GLuint captured = in.u();
+            glDeleteProgram(_programs.get(captured));
+            _programs.erase(captured);
+            break;
+        }
+        case Op::ATTACH_SHADER:
+        {
+            GLuint program = _programs.get(in.u());
+            glAttachShader(program, _shaders.get(in.u()));
+            break;
+        }
+        case Op::BIND_ATTRIB_LOCATION:
+        {
+            GLuint program = _programs.get(in.u());
+            GLuint index = in.u();
+            const char* name = in.text();
+            if (check(op, name != nullptr))
+            {
+                glBindAttribLocation(program, index, name);
+            }
+            break;
+        }
+        case Op::LINK_PROGRAM:
+            glLinkProgram(_programs.get(in.u()));
+            break;
+        case Op::USE_PROGRAM:
+            _program = in.u();
+            glUseProgram(_programs.get(_program));
+            break;
+        case Op::GET_UNIFORM_LOCATION:
+        {
+            GLuint program = in.u();
+            GLint location = in.i();
+            const char* name = in.text();
+            if (check(op, name != nullptr))
+            {
+                _uniforms[programKey(program, location)] = glGetUniformLocation(_programs.get(program), name);
+            }
+            break;
+        }
+        case Op::GET_ATTRIB_LOCATION:
+        {
+            GLuint program = in.u();
+            GLint location = in.i();
+            const char* name = in.text();
+            if (!check(op, name != nullptr))
+            {
+                break;
+            }
+            GLint replayed = glGetAttribLocation(_programs.get(program), name);
+            if (location >= 0 && replayed >= 0)
+            {
+                _attributes[location] = replayed;
+            }
+            break;
+        }
+        case Op::GET_UNIFORM_BLOCK_INDEX:
+        {
+            GLuint program = in.u();
+            GLint index = in.i();
+            const char* name = in.text();
+            if (check(op, name != nullptr))
+            {
+                _blocks[programKey(program, index)] = glGetUniformBlockIndex(_programs.get(program), name);
+            }
+            break;
+        }
+        case Op::UNIFORM_BLOCK_BINDING:
+        {
+            GLuint program = in.u();
+            GLuint index = in.u();
+            auto it = _blocks.find(programKey(program, index));
+            glUniformBlockBinding(_programs.get(program), it == _blocks.end() ? index : it->second, in.u());
+            break;
+        }
+
+        case Op::UNIFORM_1I:
+        {
+            GLint location = uniform(in.i());
+            glUniform1i(location, in.i());
+            break;
+        }
+        case Op::UNIFORM_1F:
+        {
+            GLint location = uniform(in.i());
+            glUniform1f(location, in.f());
+            break;
+        }
+        case Op::UNIFORM_2F:
+        {
+            GLint location = uniform(in.i());
+            float x = in.f();
+            glUniform2f(location, x, in.f());
+            break;
+        }
+        case Op::UNIFORM_3F:
+        {
+            GLint location = uniform(in.i());
+            float x = in.f();
+            float y = in.f();
+            glUniform3f(location, x, y, in.f());
+            break;
+        }
+        case Op::UNIFORM_4F:
+        {
+            GLint location = uniform(in.i());
+            float x = in.f();
+            float y = in.f();
+            float z = in.f();
+            glUniform4f(location, x, y, z, in.f());
+            break;
+        }
+        case Op::UNIFORM_MATRIX_4FV:
+        {
+            GLint location = uniform(in.i());
+            GLsizei count = in.i();
+            GLboolean transpose = in.u();
+            std::uint32_t blob_size;
+            const char* values = in.blob(&blob_size);
+            if (check(op, in, blob_size, std::max(count, 0) * 16 * sizeof(GLfloat), true))
+            {
+                glUniformMatrix4fv(location, count, transpose, reinterpret_cast<const GLfloat*>(values));
+            }
+            break;
+        }
+
+        case Op::ENABLE:
+            glEnable(in.u());
+            break;
+        case Op::DISABLE:
+            glDisable(in.u());
+            break;
+        case Op::BLEND_FUNC:
+        {
+            GLenum source = in.u();
+            glBlendFunc(source, in.u());
+            break;
+        }
+        case Op::DEPTH_MASK:
+            glDepthMask(in.u());
+            break;
+        case Op::VIEWPORT:
+        case Op::SCISSOR:
+        {
+            GLint x = in.i();
+            GLint y = in.i();
+            GLsizei width = in.i();
+            GLsizei height = in.i();
+            if (op == Op::VIEWPORT)
+            {
+                glViewport(x, y, width, height);
+            }
+            else
+            {
+                glScissor(x, y, width, height);
+            }
+            break;
+        }
+        case Op::CLEAR_COLOR:
+        {
+            float r = in.f();
+            float g = in.f();
+            float b = in.f();
+            glClearColor(r, g, b, in.f());
+            break;
+        }
+        case Op::CLEAR:
+            glClear(in.u());
+            break;
+
+        case Op::DRAW_ARRAYS:
+        {
+            GLenum mode = in.u();
+            GLint first = in.i();
+            glDrawArrays(mode, first, in.i());
+            break;
+        }
+        case Op::DRAW_ARRAYS_INSTANCED:
+        {
+            GLenum mode = in.u();
+            GLint first = in.i();
+            GLsizei count = in.i();
+            glDrawArraysInstanced(mode, first, count, in.i());
+            break;
+        }
+        case Op::DRAW_ELEMENTS:
+        {
+            GLenum mode = in.u();
+            GLsizei count = in.i();
+            GLenum type = in.u();
+            std::uintptr_t offset = in.u64();
+            glDrawElements(mode, count, type, reinterpret_cast<const void*>(offset));
+            break;
+        }
+
+        case Op::COUNT:
+            break;
+    }
+}
+
+struct Call_t {
+    const gl_trace_format::Record* record;
+    const char* arguments;
+};
+
+struct FrameTime_t {
+    unsigned int calls, draws;
+    // Time spent in the calls, until glFinish() returned, and of the GPU
+    double cpu_ms, finish_ms, gpu_ms;
+};
+
+struct CallTime_t {
+    unsigned long long count = 0;
+    double total_ms = 0, max_ms = 0;
+};
+
+double median(std::vector<double> values)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int repeat = 1;
+    bool quiet = false;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg)
+    {
+        if (std::strcmp(argv[arg], "--repeat") == 0 && arg + 1 < argc)
+        {
+            repeat = std::max(1, std::atoi(argv[++arg]));
+        }
+        else if (std::strcmp(argv[arg], "--quiet") == 0)
+        {
+            quiet = true;
+        }
+    }
+    if (argc - arg != 1)
+    {
+        std::fprintf(stderr, "Usage: %s [--repeat N] [--quiet] trace.gltrace\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream stream(argv[arg], std::ios::binary);
+    std::vector<char> trace((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    gl_trace_format::Header header;
+    if (trace.size() < sizeof(header))
+    {
+        std::fprintf(stderr, "Unable to read %s\n", argv[arg]);
+        return 1;
+    }
+    std::memcpy(&header, trace.data(), sizeof(header));
+    if (header.magic != gl_trace_format::MAGIC || header.version != gl_trace_format::VERSION)
+    {
+        std::fprintf(stderr, "%s is not a trace of this version\n", argv[arg]);
+        return 1;
+    }
+
+    // Calls split in set up and timed frames; the window is as big as the biggest frame
+    std::vector<Call_t> setup_calls, timed_calls;
+    int width = 1, height = 1;
+    unsigned int frame = 0;
+    std::size_t offset = sizeof(header);
+    while (offset + sizeof(gl_trace_format::Record) <= trace.size())
+    {
+        const gl_trace_format::Record* record = reinterpret_cast<const gl_trace_format::Record*>(&trace[offset]);
+        const char* arguments = &trace[offset + sizeof(gl_trace_format::Record)];
+        offset += sizeof(gl_trace_format::Record) + record->size;
+        if (offset > trace.size() || record->op >= static_cast<std::uint16_t>(Op::COUNT))
+        {
+            std::fprintf(stderr, "%s is truncated or corrupted, replaying the complete frames\n", argv[arg]);
+            break;
+        }
+        (frame < header.first_frame ? setup_calls : timed_calls).push_back({record, arguments});
+        if (static_cast<Op>(record->op) == Op::FRAME_END)
+        {
+            Reader in(arguments, record->size);
+            width = std::max<int>(width, in.i());
+            height = std::max<int>(height, in.i());
+            ++frame;
+        }
+    }
+    // Calls after the last frame end belong to no frame
+    while (!timed_calls.empty() && static_cast<Op>(timed_calls.back().record->op) != Op::FRAME_END)
+    {
+        timed_calls.pop_back();
+    }
+    if (timed_calls.empty())
+    {
+        std::fprintf(stderr, "%s has no frame to time\n", argv[arg]);
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        std::fprintf(stderr, "Unable to initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+    SDL_Window* window = SDL_CreateWindow("glreplay", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+            width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext context = window != nullptr ? SDL_GL_CreateContext(window) : nullptr;
+    if (context == nullptr)
+    {
+        std::fprintf(stderr, "Unable to create an OpenGL 3.2 context: %s\n", SDL_GetError());
+        return 1;
+    }
+    glewExperimental = GL_TRUE;
+    glewInit();
+    std::printf("%s: %s, %ux%u, %u frames\n", argv[arg], glGetString(GL_RENDERER), width, height, frame);
+
+    Replayer replayer;
+    for (const Call_t& call : setup_calls)
+    {
+        replayer.execute(static_cast<Op>(call.record->op), Reader(call.arguments, call.record->size));
+    }
+    GLuint query = 0;
+    bool gpu_timer = GLEW_ARB_timer_query;
+    if (gpu_timer)
+    {
+        glGenQueries(1, &query);
+    }
+    glFinish();
+    if (GLenum error = glGetError())
+    {
+        std::fprintf(stderr, "The set up frames raised OpenGL error 0x%x\n", error);
+    }
+    std::vector<FrameTime_t> frames;
+    std::vector<CallTime_t> calls(static_cast<std::size_t>(Op::COUNT));
+    for (unsigned int pass = 0; pass < repeat; ++pass)
+    {
+        FrameTime_t current = {0, 0, 0, 0, -1};
+        Clock::time_point frame_start = Clock::now();
+        if (gpu_timer)
+        {
+            glBeginQuery(GL_TIME_ELAPSED, query);
+        }
+        for (const Call_t& call : timed_calls)
+        {
+            Op op = static_cast<Op>(call.record->op);
+            Clock::time_point start = Clock::now();
+            replayer.execute(op, Reader(call.arguments, call.record->size));
+            double elapsed = milliseconds(Clock::now() - start);
+            CallTime_t& time = calls[call.record->op];
+            ++time.count;
+            time.total_ms += elapsed;
+            time.max_ms = std::max(time.max_ms, elapsed);
+            current.cpu_ms += elapsed;
+            ++current.calls;
+            if (op == Op::DRAW_ARRAYS || op == Op::DRAW_ARRAYS_INSTANCED || op == Op::DRAW_ELEMENTS)
+            {
+                ++current.draws;
+            }
+            if (op != Op::FRAME_END)
+            {
+                continue;
+            }
+            if (gpu_timer)
+            {
+                glEndQuery(GL_TIME_ELAPSED);
+            }
+            glFinish();
+            current.finish_ms = milliseconds(Clock::now() - frame_start);
+            if (gpu_timer)
+            {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+                current.gpu_ms = nanoseconds / 1e6;
+            }
+            frames.push_back(current);
+            current = {0, 0, 0, 0, -1};
+            frame_start = Clock::now();
+            if (gpu_timer && &call != &timed_calls.back())
+            {
+                glBeginQuery(GL_TIME_ELAPSED, query);
+            }
+        }
+    }
+
+    if (GLenum error = glGetError())
+    {
+        std::fprintf(stderr, "The timed frames raised OpenGL error 0x%x\n", error);
+    }
+
+    if (!quiet)
+    {
+        std::printf("\n%8s %8s %8s %10s %10s %10s\n", "frame", "calls", "draws", "calls ms", "finish ms", "gpu ms");
+        for (std::size_t i = 0; i < frames.size(); ++i)
+        {
+            const FrameTime_t& time = frames[i];
+            std::printf("%8zu %8u %8u %10.3f %10.3f %10.3f\n", header.first_frame + i % (frames.size() / repeat),
+                    time.calls, time.draws, time.cpu_ms, time.finish_ms, time.gpu_ms);
+        }
+    }
+
+    std::vector<double> cpu, finish, gpu;
+    for (const FrameTime_t& time : frames)
+    {
+        cpu.push_back(time.cpu_ms);
+        finish.push_back(time.finish_ms);
+        gpu.push_back(time.gpu_ms);
+    }
+    std::printf("\n%zu frames, median ms: calls %.3f, finish %.3f, gpu %.3f; max finish %.3f\n", frames.size(),
+            median(cpu), median(finish), median(gpu), *std::max_element(finish.begin(), finish.end()));
+
+    std::vector<std::size_t> order;
+    for (std::size_t op = 0; op < calls.size(); ++op)
+    {
+        if (calls[op].count > 0 && static_cast<Op>(op) != Op::FRAME_END)
+        {
+            order.push_back(op);
+        }
+    }
+    std::sort(order.begin(), order.end(),
+            [&calls](std::size_t a, std::size_t b) { return calls[a].total_ms > calls[b].total_ms; });
+    std::printf("\n%-28s %10s %10s %10s %10s\n", "call", "count", "total ms", "mean us", "max us");
+    for (std::size_t op : order)
+    {
+        const CallTime_t& time = calls[op];
+        std::printf("%-28s %10llu %10.3f %10.3f %10.3f\n", gl_trace_format::opName(static_cast<Op>(op)),
+                time.count, time.total_ms, time.total_ms * 1000 / time.count, time.max_ms * 1000);
+    }
+
+    if (gpu_timer)
+    {
+        glDeleteQueries(1, &query);
+    }
+    SDL_GL_DeleteContext(context);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
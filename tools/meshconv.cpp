@@ -0,0 +1,394 @@
+// Converts Wavefront OBJ files to the binary mesh format of rendering::MeshData.
+//
+// Usage: meshconv input.obj output.mesh
+//
+// Faces are triangulated, identical vertices merged, the triangles reordered
+// for the post-transform vertex cache and the vertices reordered by first use,
+// so the GPU fetches them mostly sequentially.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "rendering/MeshFormat.hpp"
+
+namespace
+{
+using namespace rendering;
+
+const int CACHE_SIZE = 32;
+
+struct Obj
+{
+    std::vector<float> positions, normals, uvs;
+    // Triangles, three (position, uv, normal) triplets each. -1 when missing.
+    std::vector<std::tuple<int, int, int>> corners;
+};
+
+// Resolve the 1-based, or negative relative, OBJ index <token> into [0, count).
+// Empty tokens give -1. False for 0 and indices out of range.
+bool objIndex(const std::string& token, std::size_t count, int& index)
+{
+    if (token.empty())
+    {
+        index = -1;
+        return true;
+    }
+    long value = std::strtol(token.c_str(), nullptr, 10);
+    if (value == 0 || value > static_cast<long>(count) || value < -static_cast<long>(count))
+    {
+        return false;
+    }
+    index = value < 0 ? static_cast<int>(count + value) : static_cast<int>(value - 1);
+    return true;
+}
+
+bool parseObj(const char* filename, Obj& obj)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        return false;
+    }
+    std::string line;
+    unsigned int line_number = 0;
+    while (std::getline(file, line))
+    {
+        ++line_number;
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+        if (keyword == "v" || keyword == "vn" || keyword == "vt")
+        {
+            std::vector<float>& values = keyword == "v" ? obj.positions : keyword == "vn" ? obj.normals : obj.uvs;
+            int components = keyword == "vt" ? 2 : 3;
+            for (int i = 0; i < components; ++i)
+            {
+                float value = 0.f;
+                stream >> value;
+                values.push_back(value);
+            }
+        }
+        else if (keyword == "f")
+        {
+            std::vector<std::tuple<int, int, int>> polygon;
+            std::string vertex;
+            while (stream >> vertex)
+            {
+                std::string parts[3];
+                std::size_t part = 0;
+                for (char c : vertex)
+                {
+                    if (c == '/')
+                    {
+                        ++part;
+                    }
+                    else if (part < 3)
+                    {
+                        parts[part] += c;
+                    }
+                }
+                int position, uv, normal;
+                if (parts[0].empty() || !objIndex(parts[0], obj.positions.size() / 3, position)
+                        || !objIndex(parts[1], obj.uvs.size() / 2, uv)
+                        || !objIndex(parts[2], obj.normals.size() / 3, normal))
+                {
+                    std::fprintf(stderr, "%s:%u: invalid index in face vertex %s\n", filename, line_number, vertex.c_str());
+                    return false;
+                }
+                polygon.emplace_back(position, uv, normal);
+            }
+            // Fan triangulation
+            for (std::size_t i = 2; i < polygon.size(); ++i)
+            {
+                obj.corners.push_back(polygon[0]);
+                obj.corners.push_back(polygon[i - 1]);
+                obj.corners.push_back(polygon[i]);
+            }
+        }
+    }
+    return true;
+}
+
+// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" scoring
+float vertexScore(int cache_position, int remaining_triangles)
+{
+    if (remaining_triangles == 0)
+    {
+        return -1.f;
+    }
+    float score = 0.f;
+    if (cache_position >= 0)
+    {
+        if (cache_position < 3)
+        {
+            // The last triangle's vertices, wherever they are used it costs the same
+            score = 0.75f;
+        }
+        else
+        {
+            score = std::pow(1.f - static_cast<float>(cache_position - 3) / (CACHE_SIZE - 3), 1.5f);
+        }
+    }
+    // Favour vertices with few triangles left, to finish them off
+    return score + 2.f * std::pow(static_cast<float>(remaining_triangles), -0.5f);
+}
+
+std::vector<std::uint32_t> optimizeVertexCache(const std::vector<std::uint32_t>& indices, std::size_t vertex_count)
+{
+    std::size_t triangle_count = indices.size() / 3;
+    std::vector<int> remaining(vertex_count, 0);
+    for (std::uint32_t index : indices)
+    {
+        ++remaining[index];
+    }
+    std::vector<std::size_t> first(vertex_count + 1, 0);
+    for (std::size_t i = 0; i < vertex_count; ++i)
+    {
+        first[i + 1] = first[i] + remaining[i];
+    }
+    std::vector<std::size_t> fill(first.begin(), first.end() - 1);
+    std::vector<std::size_t> vertex_triangles(indices.size());
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        vertex_triangles[fill[indices[i]]++] = i / 3;
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (std::size_t i = 0; i < vertex_count; ++i)
+    {
+        vertex_score[i] = vertexScore(-1, remaining[i]);
+    }
+    std::vector<float> triangle_score(triangle_count, 0.f);
+    std::vector<bool> emitted(triangle_count, false);
+    for (std::size_t t = 0; t < triangle_count; ++t)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            triangle_score[t] += vertex_score[indices[3 * t + c]];
+        }
+    }
+
+    std::vector<std::uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<std::uint32_t> cache;
+    std::size_t next_unemitted = 0;
+    long best = -1;
+    while (result.size() < indices.size())
+    {
+        if (best < 0)
+        {
+            // Nothing in the cache is useful, take the next unemitted triangle
+            while (emitted[next_unemitted])
+            {
+                ++next_unemitted;
+            }
+            best = next_unemitted;
+        }
+        emitted[best] = true;
+        std::vector<std::uint32_t> new_cache;
+        for (int c = 0; c < 3; ++c)
+        {
+            std::uint32_t vertex = indices[3 * best + c];
+            result.push_back(vertex);
+            new_cache.push_back(vertex);
+            --remaining[vertex];
+            // Remove the triangle from the vertex's list of live triangles
+            std::size_t* begin = &vertex_triangles[first[vertex]];
+            std::size_t* end = begin + remaining[vertex] + 1;
+            std::iter_swap(std::find(begin, end, static_cast<std::size_t>(best)), end - 1);
+        }
+        for (std::uint32_t vertex : cache)
+        {
+            if (std::find(new_cache.begin(), new_cache.end(), vertex) == new_cache.end())
+            {
+                new_cache.push_back(vertex);
+            }
+        }
+        // Vertices pushed out of the cache still need their score updated
+        for (std::size_t i = 0; i < new_cache.size(); ++i)
+        {
+            std::uint32_t vertex = new_cache[i];
+            cache_position[vertex] = i < static_cast<std::size_t>(CACHE_SIZE) ? i : -1;
+        }
+
+        best = -1;
+        float best_score = -1.f;
+        for (std::uint32_t vertex : new_cache)
+        {
+            float score = vertexScore(cache_position[vertex], remaining[vertex]);
+            float delta = score - vertex_score[vertex];
+            vertex_score[vertex] = score;
+            for (int i = 0; i < remaining[vertex]; ++i)
+            {
+                std::size_t triangle = vertex_triangles[first[vertex] + i];
+                triangle_score[triangle] += delta;
+                if (triangle_score[triangle] > best_score)
+                {
+                    best_score = triangle_score[triangle];
+                    best = triangle;
+                }
+            }
+        }
+        if (new_cache.size() > static_cast<std::size_t>(CACHE_SIZE))
+        {
+            new_cache.resize(CACHE_SIZE);
+        }
+        cache.swap(new_cache);
+    }
+    return result;
+}
+
+std::size_t align(std::size_t offset)
+{
+    return (offset + mesh_format::DATA_ALIGNMENT - 1) / mesh_format::DATA_ALIGNMENT * mesh_format::DATA_ALIGNMENT;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::fprintf(stderr, "Usage: %s input.obj output.mesh\n", argv[0]);
+        return 1;
+    }
+    Obj obj;
+    if (!parseObj(argv[1], obj) || obj.corners.empty())
+    {
+        std::fprintf(stderr, "Unable to read triangles from %s\n", argv[1]);
+        return 1;
+    }
+
+    bool has_uv = std::all_of(obj.corners.begin(), obj.corners.end(),
+            [](const std::tuple<int, int, int>& corner) { return std::get<1>(corner) >= 0; });
+    bool has_normal = std::all_of(obj.corners.begin(), obj.corners.end(),
+            [](const std::tuple<int, int, int>& corner) { return std::get<2>(corner) >= 0; });
+
+    // Merge identical corners into vertices
+    std::map<std::tuple<int, int, int>, std::uint32_t> unique;
+    std::vector<std::tuple<int, int, int>> vertices;
+    std::vector<std::uint32_t> indices;
+    for (std::tuple<int, int, int> corner : obj.corners)
+    {
+        if (!has_uv) std::get<1>(corner) = -1;
+        if (!has_normal) std::get<2>(corner) = -1;
+        auto it = unique.find(corner);
+        if (it == unique.end())
+        {
+            it = unique.emplace(corner, vertices.size()).first;
+            vertices.push_back(corner);
+        }
+        indices.push_back(it->second);
+    }
+
+    indices = optimizeVertexCache(indices, vertices.size());
+
+    // Vertex fetch: number the vertices in order of first use
+    std::vector<std::uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<std::tuple<int, int, int>> ordered;
+    ordered.reserve(vertices.size());
+    for (std::uint32_t& index : indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = ordered.size();
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    std::vector<mesh_format::Attribute> attributes;
+    std::uint32_t stride = 0;
+    auto add_attribute = [&](const char* name, std::uint32_t size)
+    {
+        mesh_format::Attribute attribute;
+        std::memset(&attribute, 0, sizeof(attribute));
+        std::strncpy(attribute.name, name, mesh_format::MAX_ATTRIBUTE_NAME - 1);
+        attribute.size = size;
+        attribute.type = mesh_format::TYPE_FLOAT;
+        attribute.normalized = 0;
+        attribute.offset = stride;
+        stride += size * sizeof(float);
+        attributes.push_back(attribute);
+    };
+    add_attribute("position", 3);
+    if (has_normal) add_attribute("normal", 3);
+    if (has_uv) add_attribute("uv", 2);
+
+    mesh_format::Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = mesh_format::MAGIC;
+    header.version = mesh_format::VERSION;
+    header.attribute_count = attributes.size();
+    header.vertex_stride = stride;
+    header.vertex_count = ordered.size();
+    header.index_count = indices.size();
+    header.index_type = ordered.size() <= 65536 ? mesh_format::TYPE_UNSIGNED_SHORT : mesh_format::TYPE_UNSIGNED_INT;
+    std::size_t index_size = header.index_type == mesh_format::TYPE_UNSIGNED_SHORT ? 2 : 4;
+    header.vertex_offset = align(sizeof(header) + attributes.size() * sizeof(mesh_format::Attribute));
+    header.index_offset = align(header.vertex_offset + ordered.size() * stride);
+
+    // rendering::MeshData doesn't read the indices when loading, they are checked here
+    for (std::uint32_t index : indices)
+    {
+        if (index >= ordered.size())
+        {
+            std::fprintf(stderr, "Index %u out of the %zu vertices\n", index, ordered.size());
+            return 1;
+        }
+    }
+
+    std::vector<unsigned char> data(header.index_offset + indices.size() * index_size, 0);
+    float* vertex_out = reinterpret_cast<float*>(&data[header.vertex_offset]);
+    for (std::size_t i = 0; i < ordered.size(); ++i)
+    {
+        const float* position = &obj.positions[3 * std::get<0>(ordered[i])];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            header.bounds_min[axis] = i == 0 ? position[axis] : std::min(header.bounds_min[axis], position[axis]);
+            header.bounds_max[axis] = i == 0 ? position[axis] : std::max(header.bounds_max[axis], position[axis]);
+            *vertex_out++ = position[axis];
+        }
+        if (has_normal)
+        {
+            const float* normal = &obj.normals[3 * std::get<2>(ordered[i])];
+            vertex_out = std::copy(normal, normal + 3, vertex_out);
+        }
+        if (has_uv)
+        {
+            const float* uv = &obj.uvs[2 * std::get<1>(ordered[i])];
+            vertex_out = std::copy(uv, uv + 2, vertex_out);
+        }
+    }
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        if (index_size == 2)
+        {
+            std::uint16_t index = indices[i];
+            std::memcpy(&data[header.index_offset + 2 * i], &index, 2);
+        }
+        else
+        {
+            std::memcpy(&data[header.index_offset + 4 * i], &indices[i], 4);
+        }
+    }
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(&data[sizeof(header)], attributes.data(), attributes.size() * sizeof(mesh_format::Attribute));
+
+    std::FILE* out = std::fopen(argv[2], "wb");
+    if (out == nullptr || std::fwrite(data.data(), 1, data.size(), out) != data.size())
+    {
+        std::fprintf(stderr, "Unable to write %s\n", argv[2]);
+        return 1;
+    }
+    std::fclose(out);
+    std::printf("%s: %zu vertices, %zu triangles\n", argv[2], ordered.size(), indices.size() / 3);
+    return 0;
+}
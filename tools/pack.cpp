@@ -0,0 +1,186 @@
+// Packs files into an asset archive for rendering::Archive.
+//
+// Usage: pack [--lz4] [--align N] output.pak file_or_directory...
+//
+// Directories are packed recursively. Entries are named by their path as
+// given (e.g. "shaders/plain.vert"), which is what the loaders look up.
+// With --lz4 an entry is compressed when that makes it smaller; the runtime
+// then needs to be built with LZ4=1.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#ifdef RENDERING_LZ4
+#include <lz4.h>
+#endif
+#include "rendering/ArchiveFormat.hpp"
+
+namespace
+{
+using namespace rendering;
+
+void collect(const std::string& path, std::vector<std::string>& files)
+{
+    struct stat path_stat;
+    if (stat(path.c_str(), &path_stat) != 0)
+    {
+        std::fprintf(stderr, "Skipping %s: not found\n", path.c_str());
+        return;
+    }
+    if (!S_ISDIR(path_stat.st_mode))
+    {
+        files.push_back(path.compare(0, 2, "./") == 0 ? path.substr(2) : path);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr)
+    {
+        return;
+    }
+    std::vector<std::string> children;
+    while (dirent* child = readdir(dir))
+    {
+        if (child->d_name[0] != '.')
+        {
+            children.push_back(child->d_name);
+        }
+    }
+    closedir(dir);
+    // Sorted, so the same inputs always produce the same archive
+    std::sort(children.begin(), children.end());
+    for (const std::string& child : children)
+    {
+        collect(path.back() == '/' ? path + child : path + "/" + child, files);
+    }
+}
+
+std::uint64_t align(std::uint64_t offset, std::uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+}
+
+int main(int argc, char** argv)
+{
+    bool lz4 = false;
+    std::uint64_t alignment = archive_format::DEFAULT_ALIGNMENT;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg)
+    {
+        if (std::strcmp(argv[arg], "--lz4") == 0)
+        {
+            lz4 = true;
+        }
+        else if (std::strcmp(argv[arg], "--align") == 0 && arg + 1 < argc)
+        {
+            alignment = std::strtoull(argv[++arg], nullptr, 10);
+        }
+    }
+    if (argc - arg < 2 || alignment == 0)
+    {
+        std::fprintf(stderr, "Usage: %s [--lz4] [--align N] output.pak file_or_directory...\n", argv[0]);
+        return 1;
+    }
+#ifndef RENDERING_LZ4
+    if (lz4)
+    {
+        std::fprintf(stderr, "--lz4 needs pack built with LZ4=1\n");
+        return 1;
+    }
+#endif
+    const char* output = argv[arg++];
+    std::vector<std::string> files;
+    for (; arg < argc; ++arg)
+    {
+        collect(argv[arg], files);
+    }
+
+    std::uint32_t table_size = 1;
+    // At most half full, so lookups rarely probe more than one slot
+    while (table_size < 2 * files.size())
+    {
+        table_size *= 2;
+    }
+    std::vector<archive_format::Entry> table(table_size);
+    std::memset(table.data(), 0, table.size() * sizeof(archive_format::Entry));
+    std::string names;
+    std::vector<char> data(sizeof(archive_format::Header), 0);
+    std::uint64_t original_total = 0;
+
+    for (const std::string& file : files)
+    {
+        std::ifstream stream(file, std::ios::binary);
+        std::vector<char> contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        archive_format::Entry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.hash = archive_format::hash(file.data(), file.size());
+        entry.original_size = contents.size();
+        entry.name_offset = names.size();
+        entry.name_size = file.size();
+        entry.flags = archive_format::FLAG_USED;
+        names += file;
+        original_total += contents.size();
+
+#ifdef RENDERING_LZ4
+        if (lz4 && !contents.empty())
+        {
+            std::vector<char> compressed(LZ4_compressBound(contents.size()));
+            int size = LZ4_compress_default(contents.data(), compressed.data(), contents.size(), compressed.size());
+            if (size > 0 && static_cast<std::size_t>(size) < contents.size())
+            {
+                compressed.resize(size);
+                contents.swap(compressed);
+                entry.flags |= archive_format::FLAG_LZ4;
+            }
+        }
+#endif
+        entry.offset = align(data.size(), alignment);
+        entry.size = contents.size();
+        data.resize(entry.offset, 0);
+        data.insert(data.end(), contents.begin(), contents.end());
+
+        std::uint32_t slot = entry.hash & (table_size - 1);
+        while (table[slot].flags & archive_format::FLAG_USED)
+        {
+            if (table[slot].hash == entry.hash && table[slot].name_size == entry.name_size
+                    && names.compare(table[slot].name_offset, entry.name_size, file) == 0)
+            {
+                std::fprintf(stderr, "Duplicated entry %s\n", file.c_str());
+                return 1;
+            }
+            slot = (slot + 1) & (table_size - 1);
+        }
+        table[slot] = entry;
+    }
+
+    archive_format::Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = archive_format::MAGIC;
+    header.version = archive_format::VERSION;
+    header.entry_count = files.size();
+    header.table_size = table_size;
+    header.table_offset = align(data.size(), 8);
+    header.names_offset = header.table_offset + table.size() * sizeof(archive_format::Entry);
+    data.resize(header.table_offset, 0);
+    const char* table_bytes = reinterpret_cast<const char*>(table.data());
+    data.insert(data.end(), table_bytes, table_bytes + table.size() * sizeof(archive_format::Entry));
+    data.insert(data.end(), names.begin(), names.end());
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    std::FILE* out = std::fopen(output, "wb");
+    if (out == nullptr || std::fwrite(data.data(), 1, data.size(), out) != data.size())
+    {
+        std::fprintf(stderr, "Unable to write %s\n", output);
+        return 1;
+    }
+    std::fclose(out);
+    std::printf("%s: %zu entries, %llu bytes packed into %zu\n", output, files.size(),
+            static_cast<unsigned long long>(original_total), data.size());
+    return 0;
+}